@@ -1,4 +1,5 @@
 #include "stm32f4xx_conf.h"
+#include "delay.h"
 #include "adc.h"
 
 //ADC1 initianilize
@@ -98,6 +99,7 @@ u16 GetADCValue(ADC_TypeDef* ADCx, int channel)
     ADC_RegularChannelConfig(ADCx, channel, 1, ADC_SampleTime_56Cycles);
     
     ADC_Cmd(ADCx, ENABLE);
+    DelayUs(ADC_STABILIZATION_TIME_US);
     ADC_SoftwareStartConv(ADCx);
     
     while (ADC_GetFlagStatus(ADCx, ADC_FLAG_EOC) != SET);
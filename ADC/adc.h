@@ -1,6 +1,8 @@
 #ifndef __ADC_H
 #define __ADC_H
 
+#define ADC_STABILIZATION_TIME_US       3       // tSTAB, power-up time of the ADC after ADON is set
+
 void Init_ADC1(void);
 void Init_ADC2(void);
 void Init_ADC3(void);
@@ -0,0 +1,339 @@
+#include "stm32f4xx.h"
+#include <stdio.h>
+#include <string.h>
+#include "definitions.h"
+#include "VTimer.h"
+#include "debounce.h"
+#include "LCD.h"
+#include "mbslave.h"
+#include "rs232.h"
+#include "tankController.h"
+#include "controllerDisplay.h"
+
+//LCD Data buffer
+ControllerSignals LCDBuffer;
+//Row arrays for more friendly writting on LCD
+char Row1[ROW_LENGHT], Row2[ROW_LENGHT], Row3[ROW_LENGHT], Row4[ROW_LENGHT];
+
+static tDisplayPage CurrentPage;
+static tVTimer *RefreshTimer;
+static BOOL IsRefreshPending;
+
+// Screen being drawn, FramePosition is the next character to write or DISPLAY_FRAME_SIZE when all is on the LCD
+static char Frame[DISPLAY_ROWS_NUMBER][ROW_LENGHT - 1];
+static int FramePosition;
+
+static void RefreshDisplay(void *pContext);
+
+// Fluid level history for the trend page, cm. LevelHistoryIndex points to the oldest sample.
+static float LevelHistory[TREND_SAMPLES_NUMBER];
+static int LevelHistoryIndex;
+
+// Bar glyphs for the trend page - glyph N has N + 1 lit rows from the bottom
+static uint8_t BarGlyphs[BAR_GLYPHS_NUMBER][8] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F},
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x1F},
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x1F, 0x1F},
+    {0x00, 0x00, 0x00, 0x00, 0x1F, 0x1F, 0x1F, 0x1F},
+    {0x00, 0x00, 0x00, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F},
+    {0x00, 0x00, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F},
+    {0x00, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F},
+    {0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F}
+};
+
+void InitControllerDisplay(void)
+{
+    int i;
+    
+    CurrentPage = eProcessPage;
+    
+    for(i = 0; i < TREND_SAMPLES_NUMBER; i++)
+    {
+        LevelHistory[i] = 0.0;
+    }
+    LevelHistoryIndex = 0;
+    
+    FramePosition = DISPLAY_FRAME_SIZE;
+    IsRefreshPending = FALSE;
+    RefreshTimer = CreateVTimer(RefreshDisplay, 0);
+    StartVTimer(RefreshTimer, LCD_REFRESH_PERIOD, LCD_REFRESH_PERIOD);
+}
+
+// Pad row with spaces (or cut it) to exactly one LCD row
+static void FitRow(char *row)
+{
+    int i;
+    
+    for(i = strlen(row); i < ROW_LENGHT - 1; i++)
+    {
+        row[i] = ' ';
+    }
+    row[ROW_LENGHT - 1] = '\0';
+}
+
+/*
+    Take all rows into the frame, the display task draws it in parts. Writing the whole screen at once
+    takes about 12 ms of LCD bus time and would hold ModBus requests for all of it.
+*/
+static void ShowRows(void)
+{
+    char *rows[DISPLAY_ROWS_NUMBER] = {Row1, Row2, Row3, Row4};
+    int row, column;
+    
+    for(row = 0; row < DISPLAY_ROWS_NUMBER; row++)
+    {
+        // shorter rows are padded with spaces
+        for(column = 0; column < ROW_LENGHT - 1 && rows[row][column] != '\0'; column++)
+        {
+            Frame[row][column] = rows[row][column];
+        }
+        for(; column < ROW_LENGHT - 1; column++)
+        {
+            Frame[row][column] = ' ';
+        }
+    }
+    
+    FramePosition = 0;
+}
+
+// Write next DISPLAY_CHARS_PER_RUN characters of the frame
+static void DrawFramePart(void)
+{
+    int row, column;
+    
+    if(FramePosition >= DISPLAY_FRAME_SIZE)
+    {
+        return;
+    }
+    
+    row = FramePosition / (ROW_LENGHT - 1);
+    column = FramePosition % (ROW_LENGHT - 1);
+    
+    LCDsetCursor(column, row);
+    LCDStrWrite((const uint8_t *)&Frame[row][column], DISPLAY_CHARS_PER_RUN);
+    
+    FramePosition += DISPLAY_CHARS_PER_RUN;
+}
+
+static void AddLevelSample(float fluidLevel)
+{
+    LevelHistory[LevelHistoryIndex] = fluidLevel;
+    LevelHistoryIndex = (LevelHistoryIndex + 1) % TREND_SAMPLES_NUMBER;
+}
+
+static void ShowProcessPage(ControllerState *pState)
+{
+    LCDBuffer.currentFluidLevel = pState->signals.currentFluidLevel * 100.0;       // cm
+    LCDBuffer.manualControlVoltage = pState->signals.manualControlVoltage;       // V
+    LCDBuffer.currentSetpoint = pState->signals.currentSetpoint * 100.0;           // cm
+    LCDBuffer.outputFlowRate = pState->signals.outputFlowRate;                   // cm3/s
+    
+    if(pState->pid.workMode == eAutoMode)
+    {
+        sprintf(Row1, "Mode:           %4s", "Auto");
+        if(LCDBuffer.currentSetpoint < H_MAX*100.0)
+        {
+            sprintf(Row4, "Setpoint:   %2.2f, cm", LCDBuffer.currentSetpoint);
+        }
+        else
+        {
+            sprintf(Row4, "Setpoint:  %2.2f, cm", LCDBuffer.currentSetpoint);
+        }
+    }
+    else
+    {
+        sprintf(Row1, "Mode:         %6s", "Manual");
+        if(LCDBuffer.manualControlVoltage == U_MAX)
+        {
+            sprintf(Row4, "Pump volt.: %2.2f, V", LCDBuffer.manualControlVoltage);
+        }
+        else
+        {
+            sprintf(Row4, "Pump volt.:  %1.2f, V", LCDBuffer.manualControlVoltage);
+        }
+    }
+    
+    if(LCDBuffer.currentFluidLevel < H_MAX*100.0)
+    {
+        sprintf(Row2, "Fluid level: %2.2f,cm", LCDBuffer.currentFluidLevel);    
+    }
+    else
+    {
+        sprintf(Row2, "Fluid level:%2.2f,cm", LCDBuffer.currentFluidLevel);
+    }
+    
+    if(LCDBuffer.outputFlowRate < 10.0)
+    {
+        sprintf(Row3, "Fout:    %1.2f, cm3/s", LCDBuffer.outputFlowRate);
+    }
+    else
+    {
+        sprintf(Row3, "Fout:   %2.2f, cm3/s", LCDBuffer.outputFlowRate);
+    }
+}
+
+/*
+    Fluid level history - one column per sample, the oldest sample is on the left.
+    Every column is a bar with TREND_PIXELS_NUMBER pixels height drawn with the bar glyphs.
+*/
+static void ShowTrendPage(ControllerState *pState)
+{
+    char *graphRows[TREND_ROWS_NUMBER] = {Row2, Row3, Row4};
+    int column, row, pixels, fill;
+    float level;
+    
+    // glyphs are sent to the display only first time
+    for(row = 0; row < BAR_GLYPHS_NUMBER; row++)
+    {
+        LCDupdateChar(row, BarGlyphs[row]);
+    }
+    
+    snprintf(Row1, ROW_LENGHT, "Level trend: %5.2fcm", pState->signals.currentFluidLevel * 100.0);
+    FitRow(Row1);
+    
+    for(column = 0; column < TREND_SAMPLES_NUMBER; column++)
+    {
+        level = LevelHistory[(LevelHistoryIndex + column) % TREND_SAMPLES_NUMBER];
+    
+        // H_MAX ----> all pixels
+        pixels = (int)((level / (H_MAX * 100.0)) * TREND_PIXELS_NUMBER + 0.5);
+        if(pixels > TREND_PIXELS_NUMBER)
+        {
+            pixels = TREND_PIXELS_NUMBER;
+        }
+    
+        for(row = 0; row < TREND_ROWS_NUMBER; row++)
+        {
+            // pixels of the bar which are in this row; the last row is the bottom of the graph
+            fill = pixels - (TREND_ROWS_NUMBER - 1 - row) * 8;
+    
+            if(fill <= 0)
+            {
+                graphRows[row][column] = ' ';
+            }
+            else if(fill >= 8)
+            {
+                graphRows[row][column] = BAR_GLYPH_CODE + 7;
+            }
+            else
+            {
+                graphRows[row][column] = BAR_GLYPH_CODE + fill - 1;
+            }
+        }
+    }
+    
+    for(row = 0; row < TREND_ROWS_NUMBER; row++)
+    {
+        graphRows[row][TREND_SAMPLES_NUMBER] = '\0';
+    }
+}
+
+static void ShowPIDPage(ControllerState *pState)
+{
+    snprintf(Row1, ROW_LENGHT, "Up:  %+9.4f, V", pState->pid.Up);
+    snprintf(Row2, ROW_LENGHT, "Ui:  %+9.4f, V", pState->pid.Ui);
+    snprintf(Row3, ROW_LENGHT, "Ud:  %+9.4f, V", pState->pid.Ud);
+    
+    if(pState->pid.SaturationFlag == TRUE)
+    {
+        snprintf(Row4, ROW_LENGHT, "Upid: %+7.2f,V SAT", pState->signals.pidControlVoltage);
+    }
+    else
+    {
+        snprintf(Row4, ROW_LENGHT, "Upid: %+7.2f,V", pState->signals.pidControlVoltage);
+    }
+    
+    FitRow(Row1);
+    FitRow(Row2);
+    FitRow(Row3);
+    FitRow(Row4);
+}
+
+static void ShowCommunicationPage(void)
+{
+    const tMBSlaveStatistics *mbStatistics = GetMBSlaveStatistics();
+    const tMBSlaveStatistics *rs232Statistics = GetRS232SlaveStatistics();
+    
+    snprintf(Row1, ROW_LENGHT, "      ModBus   RS232");
+    snprintf(Row2, ROW_LENGHT, "Rx:  %7lu %7lu", mbStatistics->framesReceived, rs232Statistics->framesReceived);
+    snprintf(Row3, ROW_LENGHT, "CRC: %7lu %7lu", mbStatistics->crcErrors, rs232Statistics->crcErrors);
+    snprintf(Row4, ROW_LENGHT, "Tx:  %7lu %7lu", mbStatistics->responsesSent, rs232Statistics->responsesSent);
+    
+    FitRow(Row1);
+    FitRow(Row2);
+    FitRow(Row3);
+    FitRow(Row4);
+}
+
+static void ShowPage(ControllerState *pState)
+{
+    switch(CurrentPage)
+    {
+    case eTrendPage:
+        ShowTrendPage(pState);
+        break;
+    case ePIDPage:
+        ShowPIDPage(pState);
+        break;
+    case eCommunicationPage:
+        ShowCommunicationPage();
+        break;
+    default:
+        ShowProcessPage(pState);
+        break;
+    }
+    
+    ShowRows();
+}
+
+// Returns TRUE when LCD_PAGE_BUTTON is pressed and selects next page for every press
+static BOOL CheckPageButton(void)
+{
+    tInputEvent event;
+    BOOL isPageChanged = FALSE;
+    
+    while(GetInputEvent(&event) == TRUE)
+    {
+        if(event.pinID == LCD_PAGE_BUTTON && event.type == eInputPressed)
+        {
+            CurrentPage = (tDisplayPage)((CurrentPage + 1) % eDisplayPagesNumber);
+            isPageChanged = TRUE;
+        }
+    }
+    
+    return isPageChanged;
+}
+
+// Called by the display refresh timer from VTimerTask(), the drawing is left to the display task
+static void RefreshDisplay(void *pContext)
+{
+    IsRefreshPending = TRUE;
+}
+
+void ControllerDisplayDataTask(void)
+{
+    ControllerState state;
+    BOOL isPageChanged;
+    
+    isPageChanged = CheckPageButton();
+    
+    if(IsRefreshPending == TRUE)
+    {
+        IsRefreshPending = FALSE;
+    
+        // take the last process data
+        GetControllerState(&state);
+    
+        AddLevelSample(state.signals.currentFluidLevel * 100.0);
+        ShowPage(&state);
+    }
+    else if(isPageChanged == TRUE)
+    {
+        // show new page immediately, history is sampled only by the refresh timer
+        GetControllerState(&state);
+    
+        ShowPage(&state);
+    }
+    
+    DrawFramePart();
+}
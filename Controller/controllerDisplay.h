@@ -0,0 +1,26 @@
+#ifndef __CONTROLLERDISPLAY_H
+#define __CONTROLLERDISPLAY_H
+
+#define LCD_REFRESH_PERIOD                                      T_500_MS                                                // 5 times slower than controller task
+#define DISPLAY_TASK_PERIOD                                     T_10_MS                                                 // page button polling
+#define DISPLAY_ROWS_NUMBER                                     4
+#define DISPLAY_FRAME_SIZE                                      (DISPLAY_ROWS_NUMBER * (ROW_LENGHT - 1))                // characters of the whole screen
+#define DISPLAY_CHARS_PER_RUN                                   10                                                      // characters drawn by one run of the display task, must divide a row
+#define TREND_SAMPLES_NUMBER                                    20                                                      // one sample per LCD column
+#define TREND_ROWS_NUMBER                                       3                                                       // LCD rows used for the graph
+#define TREND_PIXELS_NUMBER                                     (TREND_ROWS_NUMBER * 8)                                 // vertical resolution of the graph
+#define BAR_GLYPHS_NUMBER                                       8                                                       // all CGRAM locations
+#define BAR_GLYPH_CODE                                          0x08                                                    // CGRAM 0 - 7 are mirrored at 0x08 - 0x0F; 0x00 can't be used in strings
+
+typedef enum{
+    eProcessPage = 0,                   // mode, fluid level, Fout, setpoint/pump voltage
+    eTrendPage,                         // fluid level history
+    ePIDPage,                           // Up, Ui, Ud, Upid and saturation
+    eCommunicationPage,                 // ModBus and RS232 statistics
+    eDisplayPagesNumber
+}tDisplayPage;
+
+void InitControllerDisplay(void);
+void ControllerDisplayDataTask(void);
+
+#endif
@@ -0,0 +1,127 @@
+#include "stm32f4xx.h"
+#include "definitions.h"
+#include "processImage.h"
+#include "mbbinding.h"
+#include "mbdiagnostics.h"
+#include "tankController.h"
+#include "controllerModBus.h"
+
+// Scale value to signed 16-bit register, out of range values are limited
+static unsigned short ToRegister(float value, float scale)
+{
+    float scaled = value * scale;
+    
+    if(scaled >= 32767.0)
+    {
+        return 32767;
+    }
+    if(scaled <= -32768.0)
+    {
+        return (unsigned short)-32768;
+    }
+    
+    // round half away from zero
+    if(scaled < 0.0)
+    {
+        return (unsigned short)(short)(scaled - 0.5);
+    }
+    return (unsigned short)(short)(scaled + 0.5);
+}
+
+static float FromRegister(unsigned short value, float scale)
+{
+    return (float)(short)value / scale;
+}
+
+// Process data from one controller snapshot - all registers of a request belong to the same sample
+static void ReadProcessRegisters(unsigned short offset, unsigned short count, unsigned short *pValues)
+{
+    unsigned short registers[MB_PROCESS_REGISTERS_NUMBER];
+    ControllerState state;
+    int i;
+    
+    GetControllerState(&state);
+    
+    registers[MB_REG_WORK_MODE - MB_PROCESS_REGISTERS_START] = (state.pid.workMode == eAutoMode) ? 1 : 0;
+    registers[MB_REG_FLUID_LEVEL - MB_PROCESS_REGISTERS_START] = ToRegister(state.signals.currentFluidLevel, 10000.0);      // m ----> 0.01 cm
+    registers[MB_REG_SETPOINT - MB_PROCESS_REGISTERS_START] = ToRegister(state.signals.currentSetpoint, 10000.0);
+    registers[MB_REG_OUTPUT_FLOW - MB_PROCESS_REGISTERS_START] = ToRegister(state.signals.outputFlowRate, 100.0);          // cm3/s ----> 0.01 cm3/s
+    registers[MB_REG_PID_VOLTAGE - MB_PROCESS_REGISTERS_START] = ToRegister(state.signals.pidControlVoltage, 1000.0);      // V ----> mV
+    registers[MB_REG_MANUAL_VOLTAGE - MB_PROCESS_REGISTERS_START] = ToRegister(state.signals.manualControlVoltage, 1000.0);
+    registers[MB_REG_SATURATION - MB_PROCESS_REGISTERS_START] = (state.pid.SaturationFlag == TRUE) ? 1 : 0;
+    
+    for(i = 0; i < count; i++)
+    {
+        pValues[i] = registers[offset + i];
+    }
+}
+
+static void TuningToRegisters(const tPIDTuning *pTuning, unsigned short *pRegisters)
+{
+    pRegisters[MB_REG_KP - MB_TUNING_REGISTERS_START] = ToRegister(pTuning->Kp, 100.0);
+    pRegisters[MB_REG_TI - MB_TUNING_REGISTERS_START] = ToRegister(pTuning->Ti, 1000.0);                // s ----> ms
+    pRegisters[MB_REG_TD - MB_TUNING_REGISTERS_START] = ToRegister(pTuning->Td, 1000.0);
+    pRegisters[MB_REG_N - MB_TUNING_REGISTERS_START] = ToRegister(pTuning->N, 100.0);
+    pRegisters[MB_REG_TF - MB_TUNING_REGISTERS_START] = ToRegister(pTuning->Tf, 100.0);
+    pRegisters[MB_REG_B - MB_TUNING_REGISTERS_START] = ToRegister(pTuning->b, 100.0);
+    pRegisters[MB_REG_C - MB_TUNING_REGISTERS_START] = ToRegister(pTuning->c, 100.0);
+}
+
+static void ReadTuningRegisters(unsigned short offset, unsigned short count, unsigned short *pValues)
+{
+    unsigned short registers[MB_TUNING_REGISTERS_NUMBER];
+    tPIDTuning tuning;
+    int i;
+    
+    GetPIDTuning(&tuning);
+    TuningToRegisters(&tuning, registers);
+    
+    for(i = 0; i < count; i++)
+    {
+        pValues[i] = registers[offset + i];
+    }
+}
+
+// Write-through to the controller, the registers which are not written keep the current tuning
+static BOOL WriteTuningRegisters(unsigned short offset, unsigned short count, const unsigned short *pValues)
+{
+    unsigned short registers[MB_TUNING_REGISTERS_NUMBER];
+    tPIDTuning tuning;
+    int i;
+    
+    GetPIDTuning(&tuning);
+    TuningToRegisters(&tuning, registers);
+    
+    for(i = 0; i < count; i++)
+    {
+        registers[offset + i] = pValues[i];
+    }
+    
+    tuning.Kp = FromRegister(registers[MB_REG_KP - MB_TUNING_REGISTERS_START], 100.0);
+    tuning.Ti = FromRegister(registers[MB_REG_TI - MB_TUNING_REGISTERS_START], 1000.0);
+    tuning.Td = FromRegister(registers[MB_REG_TD - MB_TUNING_REGISTERS_START], 1000.0);
+    tuning.N = FromRegister(registers[MB_REG_N - MB_TUNING_REGISTERS_START], 100.0);
+    tuning.Tf = FromRegister(registers[MB_REG_TF - MB_TUNING_REGISTERS_START], 100.0);
+    tuning.b = FromRegister(registers[MB_REG_B - MB_TUNING_REGISTERS_START], 100.0);
+    tuning.c = FromRegister(registers[MB_REG_C - MB_TUNING_REGISTERS_START], 100.0);
+    
+    return SetPIDTuning(&tuning);
+}
+
+/*
+    Bind controller's slave: coils are OUTPUT_1 ... OUTPUT_16, discrete inputs are INPUT_1 ... INPUT_16,
+    input registers are the controller's process data, holding registers are the process data and PID tuning.
+    Input registers from MB_STATISTICS_REGISTERS_START are the communication statistics of the ports.
+    Coils and inputs are the process image of the I/O scan, so a request sees the inputs of the current
+    scheduler pass and written coils reach the pins together on the next scan. Registers are taken when
+    a request is served.
+*/
+void InitControllerModBus(void)
+{
+    MBBindCoils(CONTROLLER_SLAVE_INDEX, GetOutputImage, SetOutputImage);
+    MBBindInputs(CONTROLLER_SLAVE_INDEX, GetInputImage);
+    MBBindInputRegisters(CONTROLLER_SLAVE_INDEX, MB_PROCESS_REGISTERS_START, MB_PROCESS_REGISTERS_NUMBER, ReadProcessRegisters);
+    MBBindHoldingRegisters(CONTROLLER_SLAVE_INDEX, MB_PROCESS_REGISTERS_START, MB_PROCESS_REGISTERS_NUMBER, ReadProcessRegisters, 0);
+    MBBindHoldingRegisters(CONTROLLER_SLAVE_INDEX, MB_TUNING_REGISTERS_START, MB_TUNING_REGISTERS_NUMBER, ReadTuningRegisters, WriteTuningRegisters);
+    MBBindStatisticsRegisters(CONTROLLER_SLAVE_INDEX, MB_STATISTICS_REGISTERS_START);
+}
@@ -0,0 +1,36 @@
+#ifndef __CONTROLLERMODBUS_H
+#define __CONTROLLERMODBUS_H
+
+#define CONTROLLER_SLAVE_INDEX                                  0                                                       // slave with address 1
+
+/*
+    Registers of the controller's slave. All values are signed 16-bit.
+*/
+// process data, read only - input registers and the same holding registers
+#define MB_REG_WORK_MODE                                        0                                                       // 0 - manual, 1 - auto
+#define MB_REG_FLUID_LEVEL                                      1                                                       // 0.01 cm
+#define MB_REG_SETPOINT                                         2                                                       // 0.01 cm
+#define MB_REG_OUTPUT_FLOW                                      3                                                       // 0.01 cm3/s
+#define MB_REG_PID_VOLTAGE                                      4                                                       // mV
+#define MB_REG_MANUAL_VOLTAGE                                   5                                                       // mV
+#define MB_REG_SATURATION                                       6                                                       // 0, 1
+#define MB_PROCESS_REGISTERS_START                              MB_REG_WORK_MODE
+#define MB_PROCESS_REGISTERS_NUMBER                             7
+
+// PID tuning, read and write
+#define MB_REG_KP                                               10                                                      // 0.01
+#define MB_REG_TI                                               11                                                      // ms
+#define MB_REG_TD                                               12                                                      // ms
+#define MB_REG_N                                                13                                                      // 0.01
+#define MB_REG_TF                                               14                                                      // 0.01
+#define MB_REG_B                                                15                                                      // 0.01
+#define MB_REG_C                                                16                                                      // 0.01
+#define MB_TUNING_REGISTERS_START                               MB_REG_KP
+#define MB_TUNING_REGISTERS_NUMBER                              7
+
+// communication statistics of all ports, read only input registers, see mbdiagnostics.h
+#define MB_STATISTICS_REGISTERS_START                           1000
+
+void InitControllerModBus(void);
+
+#endif
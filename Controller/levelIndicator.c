@@ -0,0 +1,137 @@
+#include "stm32f4xx.h"
+#include "definitions.h"
+#include "initPeripheral.h"
+#include "pinMap.h"
+#include "tankController.h"
+#include "levelIndicator.h"
+
+// bit 0 ... 4 - bar graph from LED_2_CM, bit 5 - manual mode, bit 6 - auto mode
+#define LEVEL_LEDS_MASK                                         ((1 << LEVEL_LEDS_NUMBER) - 1)
+#define MANUAL_MODE_LED_BIT                                     (1 << LEVEL_LEDS_NUMBER)
+#define AUTO_MODE_LED_BIT                                       (1 << (LEVEL_LEDS_NUMBER + 1))
+
+static const unsigned char IndicatorLEDs[INDICATOR_LEDS_NUMBER] = {
+    LED_2_CM, LED_4_CM, LED_6_CM, LED_8_CM, LED_10_CM, LED_MANUAL_MODE, LED_AUTO_MODE
+};
+
+static tIndicatorPort IndicatorPorts[MAX_INDICATOR_PORTS];
+static int IndicatorPortsNumber;
+
+// LEDs which are ON now, written only from UpdateLevelIndicator()
+static unsigned char LitLEDs;
+
+// Group the indicator LEDs by port, turn all of them OFF
+void InitLevelIndicator(void)
+{
+    int i, j, k;
+    
+    IndicatorPortsNumber = 0;
+    
+    for(i = 0; i < INDICATOR_LEDS_NUMBER; i++)
+    {
+        InitLED(IndicatorLEDs[i]);
+        
+        for(j = 0; j < IndicatorPortsNumber; j++)
+        {
+            if(IndicatorPorts[j].port == PinMap[IndicatorLEDs[i]].port)
+            {
+                break;
+            }
+        }
+        
+        if(j == IndicatorPortsNumber)
+        {
+            IndicatorPorts[j].port = PinMap[IndicatorLEDs[i]].port;
+            for(k = 0; k < INDICATOR_LEDS_NUMBER; k++)
+            {
+                IndicatorPorts[j].pinMask[k] = 0;
+            }
+            IndicatorPortsNumber++;
+        }
+        
+        IndicatorPorts[j].pinMask[i] = PinMap[IndicatorLEDs[i]].pin;
+        IndicatorPorts[j].port->BSRRH = PinMap[IndicatorLEDs[i]].pin;
+    }
+    
+    LitLEDs = 0;
+}
+
+/*
+    Bar graph with hysteresis: LED N is turned ON when the level reaches (N + 1) * LEVEL_LED_STEP 
+    and turned OFF only when the level falls LEVEL_LED_HYSTERESIS below that threshold.
+*/
+static unsigned char CalcLevelLEDs(float fluidLevel, unsigned char litLEDs)
+{
+    float threshold = LEVEL_LED_STEP;
+    unsigned char bit;
+    int i;
+    
+    for(i = 0; i < LEVEL_LEDS_NUMBER; i++)
+    {
+        bit = 1 << i;
+        
+        if(fluidLevel >= threshold)
+        {
+            litLEDs |= bit;
+        }
+        else if(fluidLevel < threshold - LEVEL_LED_HYSTERESIS)
+        {
+            litLEDs &= ~bit;
+        }
+        
+        threshold += LEVEL_LED_STEP;
+    }
+    
+    return litLEDs;
+}
+
+/*
+    Show the level and the mode, called from TIM5 ISR after every sample.
+    Only the LEDs which change are written, with one BSRR write per port; when nothing changes 
+    there is no GPIO access at all.
+  float fluidLevel - h(k), m
+  tControllerWorkMode workMode - eAutoMode, eManualMode
+*/
+void UpdateLevelIndicator(float fluidLevel, tControllerWorkMode workMode)
+{
+    unsigned char newLEDs, changedLEDs;
+    uint32_t setPins, resetPins;
+    int i, j;
+    
+    newLEDs = CalcLevelLEDs(fluidLevel, LitLEDs & LEVEL_LEDS_MASK);
+    newLEDs |= (workMode == eAutoMode) ? AUTO_MODE_LED_BIT : MANUAL_MODE_LED_BIT;
+    
+    changedLEDs = newLEDs ^ LitLEDs;
+    if(changedLEDs == 0)
+    {
+        return;
+    }
+    
+    for(i = 0; i < IndicatorPortsNumber; i++)
+    {
+        setPins = 0;
+        resetPins = 0;
+        
+        for(j = 0; j < INDICATOR_LEDS_NUMBER; j++)
+        {
+            if(changedLEDs & (1 << j))
+            {
+                if(newLEDs & (1 << j))
+                {
+                    setPins |= IndicatorPorts[i].pinMask[j];
+                }
+                else
+                {
+                    resetPins |= IndicatorPorts[i].pinMask[j];
+                }
+            }
+        }
+        
+        if((setPins | resetPins) != 0)
+        {
+            *(__IO uint32_t *)&IndicatorPorts[i].port->BSRRL = (resetPins << 16) | setPins;
+        }
+    }
+    
+    LitLEDs = newLEDs;
+}
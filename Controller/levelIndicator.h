@@ -0,0 +1,23 @@
+#ifndef __LEVELINDICATOR_H
+#define __LEVELINDICATOR_H
+
+#include "tankController.h"
+
+#define LEVEL_LEDS_NUMBER                                       5                                                       // LED_2_CM ... LED_10_CM
+#define INDICATOR_LEDS_NUMBER                                   (LEVEL_LEDS_NUMBER + 2)                                 // and the mode LEDs
+#define LEVEL_LED_STEP                                          0.02                                                    // m, 2 cm per LED
+#define LEVEL_LED_HYSTERESIS                                    0.002                                                   // m, LED is turned off 2 mm below its threshold
+#define MAX_INDICATOR_PORTS                                     INDICATOR_LEDS_NUMBER
+
+/*
+    LEDs of the indicator on one GPIO port, written with one BSRR access
+*/
+typedef struct indicatorPortStructure{
+    GPIO_TypeDef *port;
+    uint16_t pinMask[INDICATOR_LEDS_NUMBER];    // pin of every indicator LED on this port, 0 for LEDs on other ports
+}tIndicatorPort;
+
+void InitLevelIndicator(void);
+void UpdateLevelIndicator(float fluidLevel, tControllerWorkMode workMode);
+
+#endif
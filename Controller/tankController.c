@@ -7,21 +7,26 @@
 #include "VTimer.h"
 #include "userLibrary.h"
 #include "LCD.h"
+#include "snapshot.h"
+#include "debounce.h"
+#include "levelIndicator.h"
 #include "tankController.h"
 
 ControllerSignals Signals;
 UniversalDPID PID;
 
-//LCD Data buffer
-ControllerSignals LCDBuffer;
-//Row arrays for more friendly writting on LCD
-char Row1[ROW_LENGHT], Row2[ROW_LENGHT], Row3[ROW_LENGHT], Row4[ROW_LENGHT];
+// Controller's state published from TIM5 ISR for LCD and all other consumers
+tSnapshot ControllerSnapshot;
+static ControllerState ControllerSnapshotBuffers[2];
 
-// Flags for handshaking between tank controller and LCD
-BOOL ControllerAcknowledge;
-BOOL ControllerReady;
-BOOL LCDAcknowledge;
-BOOL LCDRequest;
+// PID tuning published from main loop for TIM5 ISR, applied at the start of the next sample
+static tSnapshot TuningSnapshot;
+static tPIDTuning TuningSnapshotBuffers[2];
+static tPIDTuning RequestedTuning;
+static u32 AppliedTuningVersion;
+
+
+void PublishControllerState(void);
 
 void InitControllerPeripheral(void)
 {
@@ -32,17 +37,10 @@ void InitControllerPeripheral(void)
     InitTrimmer(MANUAL_CONTROL_VOLTAGE_INPUT);
     InitDAC(PUMP_CONTROL_VOLTAGE_OUTPUT, 0);
     
-    // Init DIs
-    InitSwitch(AUTO_MANUAL_SWITCH);
+    // DIs (AUTO_MANUAL_SWITCH, LCD_PAGE_BUTTON) are configured by InitDebounce()
     
     // Init LEDs
-    InitLED(LED_2_CM);
-    InitLED(LED_4_CM);
-    InitLED(LED_6_CM);
-    InitLED(LED_8_CM);
-    InitLED(LED_10_CM);
-    InitLED(LED_MANUAL_MODE);
-    InitLED(LED_AUTO_MODE);
+    InitLevelIndicator();
     
     InitTIM5(SAMPLE_TIME);
 }
@@ -75,10 +73,20 @@ void SetInitialConditions(void)
     Signals.oldSetpoint = 0.0;
     Signals.outputFlowRate = 0.0;
     
-    ControllerAcknowledge = FALSE;
-    ControllerReady = FALSE;
-    LCDAcknowledge = FALSE;
-    LCDRequest = FALSE;
+    InitSnapshot(&ControllerSnapshot, ControllerSnapshotBuffers, sizeof(ControllerState));
+    PublishControllerState();
+    
+    RequestedTuning.Kp = PID.Kp;
+    RequestedTuning.Ti = PID.Ti;
+    RequestedTuning.Td = PID.Td;
+    RequestedTuning.N = PID.N;
+    RequestedTuning.Tf = PID.Tf;
+    RequestedTuning.b = PID.b;
+    RequestedTuning.c = PID.c;
+    
+    InitSnapshot(&TuningSnapshot, TuningSnapshotBuffers, sizeof(tPIDTuning));
+    PublishSnapshot(&TuningSnapshot, &RequestedTuning);
+    AppliedTuningVersion = GetSnapshotVersion(&TuningSnapshot);
     
     // Start Tank controller
     TIM_Cmd(TIM5, ENABLE);
@@ -154,10 +162,10 @@ void ReadOutputFlowRateValue(void)
 
 void ReadControllerModeCommand(void)
 {
-    // read switch state for define controller's work mode
+    // read debounced switch state for define controller's work mode
     int workMode;
     
-    workMode = GetSwitchState(AUTO_MANUAL_SWITCH);
+    workMode = IsDebouncedInputOn(AUTO_MANUAL_SWITCH);
     
     if(workMode == OFF)
     {
@@ -358,113 +366,88 @@ void ControllerTask(void)
     }
 }
 
-// This fuction realize discrete execution for Tank controller
-void TIM5_IRQHandler(void)
+// Copy Signals and PID in controller's snapshot
+void PublishControllerState(void)
 {
-    ControllerTask();
+    ControllerState state;
     
-    if(LCDRequest == TRUE)
-    {
-        ControllerAcknowledge = TRUE;
-    }
-    else if(ControllerAcknowledge == TRUE)
-    {
-        // send process data to LCD
-        LCDBuffer.currentFluidLevel = Signals.currentFluidLevel * 100.0;       // cm
-        LCDBuffer.manualControlVoltage = Signals.manualControlVoltage;       // V
-        LCDBuffer.currentSetpoint = Signals.currentSetpoint * 100.0;           // cm
-        LCDBuffer.outputFlowRate = Signals.outputFlowRate;                   // cm3/s
-        
-        ControllerAcknowledge = FALSE;
-        ControllerReady = TRUE;
-    }
-    else if(LCDAcknowledge == TRUE)
-    {
-        ControllerReady = FALSE;
-    }
-    else
+    state.signals = Signals;
+    state.pid = PID;
+    
+    PublishSnapshot(&ControllerSnapshot, &state);
+}
+
+/*
+    Get consistent copy of the last published controller's state.
+    It can be called from main loop or from ISRs with lower priority than TIM5 - it never waits for the controller.
+*/
+void GetControllerState(ControllerState *pState)
+{
+    ReadSnapshot(&ControllerSnapshot, pState);
+}
+
+/*
+    Request new PID tuning from main loop. The controller takes it at the start of the next sample.
+    The function returns FALSE and nothing is changed when the tuning is not valid.
+*/
+BOOL SetPIDTuning(const tPIDTuning *pTuning)
+{
+    if(pTuning->Ti <= 0.0 || pTuning->Td < 0.0 || pTuning->N <= 0.0 || pTuning->Tf <= 0.0)
     {
-        // do nothing - idle
+        return FALSE;
     }
     
-    TIM_ClearFlag(TIM5, TIM_FLAG_Update);
-    TIM_ClearITPendingBit(TIM5, TIM_IT_Update);
+    RequestedTuning = *pTuning;
+    PublishSnapshot(&TuningSnapshot, &RequestedTuning);
+    
+    return TRUE;
 }
 
-void ControllerDisplayDataTask(void)
+// Get the last requested PID tuning, it may not be applied by the controller yet
+void GetPIDTuning(tPIDTuning *pTuning)
 {
-    char Buffer[81]; // (4 * row lenght) + 1 (for '\0')
+    *pTuning = RequestedTuning;
+}
+
+// Take the PID tuning published by SetPIDTuning(), called from TIM5 ISR
+static void ApplyPIDTuning(void)
+{
+    tPIDTuning tuning;
+    u32 version;
     
-    if(IsVTimerElapsed(LCD_REFRESH_TIMER) == ELAPSED)
+    version = GetSnapshotVersion(&TuningSnapshot);
+    if(version == AppliedTuningVersion)
     {
-        if(ControllerAcknowledge == TRUE)
-        {
-            LCDRequest = FALSE;
-        }
-        else if(ControllerReady == TRUE)
-        {
-            if(PID.workMode == eAutoMode)
-            {
-                sprintf(Row1, "Mode:           %4s", "Auto");
-                if(LCDBuffer.currentSetpoint < H_MAX*100.0)
-                {
-                    sprintf(Row4, "Setpoint:   %2.2f, cm", LCDBuffer.currentSetpoint);
-                }
-                else
-                {
-                    sprintf(Row4, "Setpoint:  %2.2f, cm", LCDBuffer.currentSetpoint);
-                }
-            }
-            else
-            {
-                sprintf(Row1, "Mode:         %6s", "Manual");
-                if(LCDBuffer.manualControlVoltage == U_MAX)
-                {
-                    sprintf(Row4, "Pump volt.: %2.2f, V", LCDBuffer.manualControlVoltage);
-                }
-                else
-                {
-                    sprintf(Row4, "Pump volt.:  %1.2f, V", LCDBuffer.manualControlVoltage);
-                }
-            }
-            
-            if(LCDBuffer.currentFluidLevel < H_MAX*100.0)
-            {
-                sprintf(Row2, "Fluid level: %2.2f,cm", LCDBuffer.currentFluidLevel);    
-            }
-            else
-            {
-                sprintf(Row2, "Fluid level:%2.2f,cm", LCDBuffer.currentFluidLevel);
-            }
-            
-            if(LCDBuffer.outputFlowRate < 10.0)
-            {
-                sprintf(Row3, "Fout:    %1.2f, cm3/s", LCDBuffer.outputFlowRate);
-            }
-            else
-            {
-                sprintf(Row3, "Fout:   %2.2f, cm3/s", LCDBuffer.outputFlowRate);
-            }
-            
-            LCDhome();
-            
-            strcpy(Buffer, Row1);
-            strcat(Buffer, Row3);
-            strcat(Buffer, Row2);
-            strcat(Buffer, Row4);
-            Buffer[80] = '\0';
-            
-            LCDprint(Buffer);
-            
-            SetVTimerValue(LCD_REFRESH_TIMER, T_500_MS); // 10 times slower than controller task
-            
-            LCDAcknowledge = TRUE;
-        }
-        else
-        {
-            LCDAcknowledge = FALSE;
-            LCDRequest = TRUE;
-        }    
+        return;
     }
+    
+    ReadSnapshot(&TuningSnapshot, &tuning);
+    AppliedTuningVersion = version;
+    
+    PID.Kp = tuning.Kp;
+    PID.Ti = tuning.Ti;
+    PID.Td = tuning.Td;
+    PID.N = tuning.N;
+    PID.Tf = tuning.Tf;
+    PID.b = tuning.b;
+    PID.c = tuning.c;
+    
+    PID.Ci = PID.T0 / PID.Ti;
+    PID.Cd = PID.N / (PID.Td + PID.N * PID.T0);
 }
 
+// This fuction realize discrete execution for Tank controller
+void TIM5_IRQHandler(void)
+{
+    ApplyPIDTuning();
+    
+    ControllerTask();
+    
+    UpdateLevelIndicator(Signals.currentFluidLevel, PID.workMode);
+    
+    // make new process data available for LCD, ModBus, etc.
+    PublishControllerState();
+    
+    TIM_ClearFlag(TIM5, TIM_FLAG_Update);
+    TIM_ClearITPendingBit(TIM5, TIM_IT_Update);
+}
@@ -11,6 +11,7 @@
 #define PUMP_CONTROL_VOLTAGE_OUTPUT                             DAC_2
 #define LCD_REFRESH_TIMER                                       TIMER_1
 #define AUTO_MANUAL_SWITCH                                      SWITCH_1
+#define LCD_PAGE_BUTTON                                         BUTTON_1
 #define LED_2_CM                                                LED_1
 #define LED_4_CM                                                LED_2
 #define LED_6_CM                                                LED_3
@@ -83,6 +84,23 @@ typedef struct signalStructure{
     float outputFlowRate;               // Fout(k)
 }ControllerSignals;
 
+// PID tuning which can be changed while the controller runs
+typedef struct pidTuningStructure{
+    float Kp;
+    float Ti;                           // s
+    float Td;                           // s
+    float N;
+    float Tf;
+    float b;
+    float c;
+}tPIDTuning;
+
+// consistent copy of controller's data, published on every sample
+typedef struct controllerStateStructure{
+    ControllerSignals signals;
+    UniversalDPID pid;
+}ControllerState;
+
 void InitControllerPeripheral(void);
 void SetInitialConditions(void);
 //void ReadFluidLevelValue(void);
@@ -94,6 +112,8 @@ void SetInitialConditions(void);
 //void SetControlVoltageOutput(float controlSignal);
 void ControllerTask(void);
 void TIM5_IRQHandler(void);
-void ControllerDisplayDataTask(void);
+void GetControllerState(ControllerState *pState);
+BOOL SetPIDTuning(const tPIDTuning *pTuning);
+void GetPIDTuning(tPIDTuning *pTuning);
 
 #endif
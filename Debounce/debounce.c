@@ -0,0 +1,178 @@
+#include "stm32f4xx.h"
+#include "definitions.h"
+#include "initPeripheral.h"
+#include "pinMap.h"
+#include "VTimer.h"
+#include "debounce.h"
+
+static tDebouncedInput Inputs[DEBOUNCED_INPUTS_NUMBER];
+
+// Debounced states as DEBOUNCED_BIT() mask, written only by the scan. Interrupts read it with one load.
+static volatile u32 DebouncedInputs;
+
+// Events from the scan to one consumer in main loop
+static tInputEvent EventsQueue[INPUT_EVENTS_QUEUE_SIZE];
+static volatile unsigned int EventsHead;         // next free place, written by the scan
+static volatile unsigned int EventsTail;         // next event, written by the consumer
+static unsigned long LostEvents;
+
+static tVTimer *ScanTimer;
+
+static void ScanInputs(void *pContext);
+
+static BOOL IsPinHigh(int pinID)
+{
+    return (PinMap[pinID].port->IDR & PinMap[pinID].pin) != 0;
+}
+
+static void PutInputEvent(int pinID, tInputEventType type)
+{
+    unsigned int head = EventsHead;
+    
+    if(head - EventsTail >= INPUT_EVENTS_QUEUE_SIZE)
+    {
+        LostEvents++;
+        return;
+    }
+    
+    EventsQueue[head % INPUT_EVENTS_QUEUE_SIZE].pinID = pinID;
+    EventsQueue[head % INPUT_EVENTS_QUEUE_SIZE].type = type;
+    EventsHead = head + 1;
+}
+
+/*
+    Configure all buttons and switches and start the periodic scan.
+    Initial states are taken without debounce, so there are no events for the inputs which are ON at start.
+*/
+void InitDebounce(void)
+{
+    u32 states = 0;
+    int i;
+    
+    for(i = 0; i < DEBOUNCED_BUTTONS_NUMBER; i++)
+    {
+        Inputs[i].pinID = BUTTON_1 + i;
+        InitButton(BUTTON_1 + i);
+    }
+    Inputs[DEBOUNCED_BUTTONS_NUMBER].pinID = SWITCH_1;
+    InitSwitch(SWITCH_1);
+    Inputs[DEBOUNCED_BUTTONS_NUMBER + 1].pinID = SWITCH_2;
+    InitSwitch(SWITCH_2);
+    
+    for(i = 0; i < DEBOUNCED_INPUTS_NUMBER; i++)
+    {
+        Inputs[i].holdScans = 0;
+        
+        if(IsPinHigh(Inputs[i].pinID) == TRUE)
+        {
+            Inputs[i].integrator = DEBOUNCE_INTEGRATOR_MAX;
+            states |= 1UL << i;
+        }
+        else
+        {
+            Inputs[i].integrator = 0;
+        }
+    }
+    
+    DebouncedInputs = states;
+    EventsHead = 0;
+    EventsTail = 0;
+    LostEvents = 0;
+    
+    ScanTimer = CreateVTimer(ScanInputs, 0);
+    StartVTimer(ScanTimer, DEBOUNCE_SCAN_PERIOD, DEBOUNCE_SCAN_PERIOD);
+}
+
+// One sample of all inputs, called by the scan timer from VTimerTask()
+static void ScanInputs(void *pContext)
+{
+    tDebouncedInput *pInput;
+    u32 states = DebouncedInputs;
+    u32 bit;
+    int i;
+    
+    for(i = 0; i < DEBOUNCED_INPUTS_NUMBER; i++)
+    {
+        pInput = &Inputs[i];
+        bit = 1UL << i;
+        
+        if(IsPinHigh(pInput->pinID) == TRUE)
+        {
+            if(pInput->integrator < DEBOUNCE_INTEGRATOR_MAX)
+            {
+                pInput->integrator++;
+            }
+        }
+        else if(pInput->integrator > 0)
+        {
+            pInput->integrator--;
+        }
+        
+        if(pInput->integrator == DEBOUNCE_INTEGRATOR_MAX && (states & bit) == 0)
+        {
+            states |= bit;
+            pInput->holdScans = 0;
+            PutInputEvent(pInput->pinID, eInputPressed);
+        }
+        else if(pInput->integrator == 0 && (states & bit) != 0)
+        {
+            states &= ~bit;
+            PutInputEvent(pInput->pinID, eInputReleased);
+        }
+        else if((states & bit) != 0 && pInput->holdScans < LONG_PRESS_SCANS)
+        {
+            pInput->holdScans++;
+            if(pInput->holdScans == LONG_PRESS_SCANS)
+            {
+                PutInputEvent(pInput->pinID, eInputLongPressed);
+            }
+        }
+    }
+    
+    DebouncedInputs = states;
+}
+
+// Debounced states of all buttons and switches as DEBOUNCED_BIT() mask, safe in interrupts
+u32 GetDebouncedInputs(void)
+{
+    return DebouncedInputs;
+}
+
+/* Debounced state of one input
+  int pinID - BUTTON_1 ... BUTTON_8, SWITCH_1, SWITCH_2
+  Returns ON or OFF
+*/
+int IsDebouncedInputOn(int pinID)
+{
+    if(DebouncedInputs & DEBOUNCED_BIT(pinID))
+    {
+        return ON;
+    }
+    
+    return OFF;
+}
+
+/*
+    Take the oldest input event. Returns FALSE when there are no events.
+    The queue has one consumer - events are removed by the first task which takes them.
+*/
+BOOL GetInputEvent(tInputEvent *pEvent)
+{
+    unsigned int tail = EventsTail;
+    
+    if(tail == EventsHead)
+    {
+        return FALSE;
+    }
+    
+    *pEvent = EventsQueue[tail % INPUT_EVENTS_QUEUE_SIZE];
+    EventsTail = tail + 1;
+    
+    return TRUE;
+}
+
+// Events dropped because the queue was full
+unsigned long GetLostInputEvents(void)
+{
+    return LostEvents;
+}
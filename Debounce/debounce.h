@@ -0,0 +1,45 @@
+#ifndef __DEBOUNCE_H
+#define __DEBOUNCE_H
+
+#include "definitions.h"
+
+#define DEBOUNCE_SCAN_PERIOD                    5                       // ms between two samples of all inputs
+#define DEBOUNCE_INTEGRATOR_MAX                 4                       // samples, the input is stable for 20 ms
+#define LONG_PRESS_TIME                         T_1_S
+#define LONG_PRESS_SCANS                        (LONG_PRESS_TIME / DEBOUNCE_SCAN_PERIOD)
+#define DEBOUNCED_BUTTONS_NUMBER                8                       // BUTTON_1 ... BUTTON_8
+#define DEBOUNCED_INPUTS_NUMBER                 (DEBOUNCED_BUTTONS_NUMBER + 2)  // and SWITCH_1, SWITCH_2
+#define INPUT_EVENTS_QUEUE_SIZE                 16                      // power of 2
+
+// Bit of button or switch in the debounced inputs mask
+#define DEBOUNCED_BIT(PIN_ID)                   (((PIN_ID) >= SWITCH_1) ? (1UL << ((PIN_ID) - SWITCH_1 + DEBOUNCED_BUTTONS_NUMBER)) : \
+                                                                          (1UL << ((PIN_ID) - BUTTON_1)))
+
+typedef enum{
+    eInputPressed = 0,                  // button pressed or switch turned ON
+    eInputReleased,                     // button released or switch turned OFF
+    eInputLongPressed                   // input is ON for LONG_PRESS_TIME, sent once per press
+}tInputEventType;
+
+typedef struct inputEventStructure{
+    unsigned char pinID;                // BUTTON_x or SWITCH_x
+    unsigned char type;                 // tInputEventType
+}tInputEvent;
+
+/*
+    Debounce state of one input. The integrator counts up while the pin is high and down while 
+    it is low; the debounced state changes only when the integrator reaches its limit.
+*/
+typedef struct debouncedInputStructure{
+    unsigned char pinID;
+    unsigned char integrator;           // 0 ... DEBOUNCE_INTEGRATOR_MAX
+    unsigned short holdScans;           // scans since the press, for the long press
+}tDebouncedInput;
+
+void InitDebounce(void);
+u32 GetDebouncedInputs(void);
+int IsDebouncedInputOn(int pinID);
+BOOL GetInputEvent(tInputEvent *pEvent);
+unsigned long GetLostInputEvents(void);
+
+#endif
@@ -0,0 +1,81 @@
+#include "stm32f4xx_conf.h"
+#include "definitions.h"
+#include "pinMap.h"
+
+/*
+    Port, pin, clock, mode, pull, ADC, channel of every logical ID
+*/
+const tPinDescriptor PinMap[PIN_MAP_SIZE] = {
+    // Buttons
+    [BUTTON_1]   = {GPIOC, GPIO_Pin_6, RCC_AHB1Periph_GPIOC, GPIO_Mode_IN, GPIO_PuPd_NOPULL, 0, 0},
+    [BUTTON_2]   = {GPIOC, GPIO_Pin_8, RCC_AHB1Periph_GPIOC, GPIO_Mode_IN, GPIO_PuPd_NOPULL, 0, 0},
+    [BUTTON_3]   = {GPIOC, GPIO_Pin_9, RCC_AHB1Periph_GPIOC, GPIO_Mode_IN, GPIO_PuPd_NOPULL, 0, 0},
+    [BUTTON_4]   = {GPIOD, GPIO_Pin_11, RCC_AHB1Periph_GPIOD, GPIO_Mode_IN, GPIO_PuPd_NOPULL, 0, 0},
+    [BUTTON_5]   = {GPIOA, GPIO_Pin_8, RCC_AHB1Periph_GPIOA, GPIO_Mode_IN, GPIO_PuPd_NOPULL, 0, 0},
+    [BUTTON_6]   = {GPIOD, GPIO_Pin_0, RCC_AHB1Periph_GPIOD, GPIO_Mode_IN, GPIO_PuPd_NOPULL, 0, 0},
+    [BUTTON_7]   = {GPIOE, GPIO_Pin_1, RCC_AHB1Periph_GPIOE, GPIO_Mode_IN, GPIO_PuPd_NOPULL, 0, 0},
+    [BUTTON_8]   = {GPIOE, GPIO_Pin_0, RCC_AHB1Periph_GPIOE, GPIO_Mode_IN, GPIO_PuPd_NOPULL, 0, 0},
+
+    // LEDs
+    [LED_1]      = {GPIOD, GPIO_Pin_15, RCC_AHB1Periph_GPIOD, GPIO_Mode_OUT, GPIO_PuPd_UP, 0, 0},
+    [LED_2]      = {GPIOD, GPIO_Pin_13, RCC_AHB1Periph_GPIOD, GPIO_Mode_OUT, GPIO_PuPd_UP, 0, 0},
+    [LED_3]      = {GPIOD, GPIO_Pin_14, RCC_AHB1Periph_GPIOD, GPIO_Mode_OUT, GPIO_PuPd_UP, 0, 0},
+    [LED_4]      = {GPIOD, GPIO_Pin_12, RCC_AHB1Periph_GPIOD, GPIO_Mode_OUT, GPIO_PuPd_UP, 0, 0},
+    [LED_5]      = {GPIOC, GPIO_Pin_11, RCC_AHB1Periph_GPIOC, GPIO_Mode_OUT, GPIO_PuPd_UP, 0, 0},
+    [LED_6]      = {GPIOD, GPIO_Pin_2, RCC_AHB1Periph_GPIOD, GPIO_Mode_OUT, GPIO_PuPd_UP, 0, 0},
+    [LED_7]      = {GPIOB, GPIO_Pin_3, RCC_AHB1Periph_GPIOB, GPIO_Mode_OUT, GPIO_PuPd_UP, 0, 0},
+    [LED_8]      = {GPIOB, GPIO_Pin_7, RCC_AHB1Periph_GPIOB, GPIO_Mode_OUT, GPIO_PuPd_UP, 0, 0},
+
+    // Trimmers
+    [TRIMMER_1]  = {GPIOC, GPIO_Pin_1, RCC_AHB1Periph_GPIOC, GPIO_Mode_AN, GPIO_PuPd_NOPULL, ADC3, 11},
+    [TRIMMER_2]  = {GPIOA, GPIO_Pin_1, RCC_AHB1Periph_GPIOA, GPIO_Mode_AN, GPIO_PuPd_NOPULL, ADC3, 1},
+    [TRIMMER_3]  = {GPIOC, GPIO_Pin_2, RCC_AHB1Periph_GPIOC, GPIO_Mode_AN, GPIO_PuPd_NOPULL, ADC3, 12},
+
+    // Switches
+    [SWITCH_1]   = {GPIOC, GPIO_Pin_14, RCC_AHB1Periph_GPIOC, GPIO_Mode_IN, GPIO_PuPd_NOPULL, 0, 0},
+    [SWITCH_2]   = {GPIOC, GPIO_Pin_15, RCC_AHB1Periph_GPIOC, GPIO_Mode_IN, GPIO_PuPd_NOPULL, 0, 0},
+
+    // Digital inputs
+    [INPUT_1]    = {GPIOC, GPIO_Pin_13, RCC_AHB1Periph_GPIOC, GPIO_Mode_IN, GPIO_PuPd_NOPULL, 0, 0},
+    [INPUT_2]    = {GPIOE, GPIO_Pin_5, RCC_AHB1Periph_GPIOE, GPIO_Mode_IN, GPIO_PuPd_NOPULL, 0, 0},
+    [INPUT_3]    = {GPIOB, GPIO_Pin_8, RCC_AHB1Periph_GPIOB, GPIO_Mode_IN, GPIO_PuPd_NOPULL, 0, 0},
+    [INPUT_4]    = {GPIOB, GPIO_Pin_4, RCC_AHB1Periph_GPIOB, GPIO_Mode_IN, GPIO_PuPd_NOPULL, 0, 0},
+    [INPUT_5]    = {GPIOD, GPIO_Pin_7, RCC_AHB1Periph_GPIOD, GPIO_Mode_IN, GPIO_PuPd_NOPULL, 0, 0},
+    [INPUT_6]    = {GPIOD, GPIO_Pin_3, RCC_AHB1Periph_GPIOD, GPIO_Mode_IN, GPIO_PuPd_NOPULL, 0, 0},
+    [INPUT_7]    = {GPIOD, GPIO_Pin_1, RCC_AHB1Periph_GPIOD, GPIO_Mode_IN, GPIO_PuPd_NOPULL, 0, 0},
+    [INPUT_8]    = {GPIOA, GPIO_Pin_10, RCC_AHB1Periph_GPIOA, GPIO_Mode_IN, GPIO_PuPd_NOPULL, 0, 0},
+    [INPUT_9]    = {GPIOE, GPIO_Pin_6, RCC_AHB1Periph_GPIOE, GPIO_Mode_IN, GPIO_PuPd_NOPULL, 0, 0},
+    [INPUT_10]   = {GPIOE, GPIO_Pin_4, RCC_AHB1Periph_GPIOE, GPIO_Mode_IN, GPIO_PuPd_NOPULL, 0, 0},
+    [INPUT_11]   = {GPIOE, GPIO_Pin_2, RCC_AHB1Periph_GPIOE, GPIO_Mode_IN, GPIO_PuPd_NOPULL, 0, 0},
+    [INPUT_12]   = {GPIOB, GPIO_Pin_6, RCC_AHB1Periph_GPIOB, GPIO_Mode_IN, GPIO_PuPd_NOPULL, 0, 0},
+    [INPUT_13]   = {GPIOB, GPIO_Pin_5, RCC_AHB1Periph_GPIOB, GPIO_Mode_IN, GPIO_PuPd_NOPULL, 0, 0},
+    [INPUT_14]   = {GPIOD, GPIO_Pin_6, RCC_AHB1Periph_GPIOD, GPIO_Mode_IN, GPIO_PuPd_NOPULL, 0, 0},
+    [INPUT_15]   = {GPIOD, GPIO_Pin_4, RCC_AHB1Periph_GPIOD, GPIO_Mode_IN, GPIO_PuPd_NOPULL, 0, 0},
+    [INPUT_16]   = {GPIOC, GPIO_Pin_12, RCC_AHB1Periph_GPIOC, GPIO_Mode_IN, GPIO_PuPd_NOPULL, 0, 0},
+
+    // Digital outputs
+    [OUTPUT_1]   = {GPIOB, GPIO_Pin_1, RCC_AHB1Periph_GPIOB, GPIO_Mode_OUT, GPIO_PuPd_UP, 0, 0},
+    [OUTPUT_2]   = {GPIOE, GPIO_Pin_7, RCC_AHB1Periph_GPIOE, GPIO_Mode_OUT, GPIO_PuPd_UP, 0, 0},
+    [OUTPUT_3]   = {GPIOE, GPIO_Pin_9, RCC_AHB1Periph_GPIOE, GPIO_Mode_OUT, GPIO_PuPd_UP, 0, 0},
+    [OUTPUT_4]   = {GPIOB, GPIO_Pin_11, RCC_AHB1Periph_GPIOB, GPIO_Mode_OUT, GPIO_PuPd_UP, 0, 0},
+    [OUTPUT_5]   = {GPIOE, GPIO_Pin_15, RCC_AHB1Periph_GPIOE, GPIO_Mode_OUT, GPIO_PuPd_UP, 0, 0},
+    [OUTPUT_6]   = {GPIOE, GPIO_Pin_13, RCC_AHB1Periph_GPIOE, GPIO_Mode_OUT, GPIO_PuPd_UP, 0, 0},
+    [OUTPUT_7]   = {GPIOE, GPIO_Pin_11, RCC_AHB1Periph_GPIOE, GPIO_Mode_OUT, GPIO_PuPd_UP, 0, 0},
+    [OUTPUT_8]   = {GPIOC, GPIO_Pin_3, RCC_AHB1Periph_GPIOC, GPIO_Mode_OUT, GPIO_PuPd_UP, 0, 0},
+    [OUTPUT_9]   = {GPIOB, GPIO_Pin_0, RCC_AHB1Periph_GPIOB, GPIO_Mode_OUT, GPIO_PuPd_UP, 0, 0},
+    [OUTPUT_10]  = {GPIOD, GPIO_Pin_10, RCC_AHB1Periph_GPIOD, GPIO_Mode_OUT, GPIO_PuPd_UP, 0, 0},
+    [OUTPUT_11]  = {GPIOE, GPIO_Pin_8, RCC_AHB1Periph_GPIOE, GPIO_Mode_OUT, GPIO_PuPd_UP, 0, 0},
+    [OUTPUT_12]  = {GPIOE, GPIO_Pin_10, RCC_AHB1Periph_GPIOE, GPIO_Mode_OUT, GPIO_PuPd_UP, 0, 0},
+    [OUTPUT_13]  = {GPIOB, GPIO_Pin_10, RCC_AHB1Periph_GPIOB, GPIO_Mode_OUT, GPIO_PuPd_UP, 0, 0},
+    [OUTPUT_14]  = {GPIOE, GPIO_Pin_14, RCC_AHB1Periph_GPIOE, GPIO_Mode_OUT, GPIO_PuPd_UP, 0, 0},
+    [OUTPUT_15]  = {GPIOE, GPIO_Pin_12, RCC_AHB1Periph_GPIOE, GPIO_Mode_OUT, GPIO_PuPd_UP, 0, 0},
+    [OUTPUT_16]  = {GPIOA, GPIO_Pin_9, RCC_AHB1Periph_GPIOA, GPIO_Mode_OUT, GPIO_PuPd_UP, 0, 0},
+
+    // Analog inputs
+    [ADC_1]      = {GPIOC, GPIO_Pin_4, RCC_AHB1Periph_GPIOC, GPIO_Mode_AN, GPIO_PuPd_NOPULL, ADC1, 14},
+    [ADC_2]      = {GPIOC, GPIO_Pin_5, RCC_AHB1Periph_GPIOC, GPIO_Mode_AN, GPIO_PuPd_NOPULL, ADC2, 15},
+
+    // Analog outputs
+    [DAC_1]      = {GPIOA, GPIO_Pin_4, RCC_AHB1Periph_GPIOA, GPIO_Mode_AN, GPIO_PuPd_NOPULL, 0, DAC_Channel_1},
+    [DAC_2]      = {GPIOA, GPIO_Pin_5, RCC_AHB1Periph_GPIOA, GPIO_Mode_AN, GPIO_PuPd_NOPULL, 0, DAC_Channel_2},
+};
@@ -0,0 +1,23 @@
+#ifndef __PINMAP_H
+#define __PINMAP_H
+
+#include "definitions.h"
+
+#define PIN_MAP_SIZE                            (DAC_2 + 1)             // indexed by BUTTON_1 ... DAC_2, index 0 is not used
+
+/*
+    Board pin assignment. One descriptor per logical ID, a board variant is a change of PinMap only.
+*/
+typedef struct pinDescriptor{
+    GPIO_TypeDef *port;
+    uint16_t pin;                       // GPIO_Pin_x mask
+    uint32_t clock;                     // RCC_AHB1Periph_GPIOx
+    GPIOMode_TypeDef mode;              // GPIO_Mode_IN, GPIO_Mode_OUT or GPIO_Mode_AN
+    GPIOPuPd_TypeDef pull;
+    ADC_TypeDef *adc;                   // converter of analog inputs, 0 for the others
+    uint32_t channel;                   // ADC channel number or DAC_Channel_x
+}tPinDescriptor;
+
+extern const tPinDescriptor PinMap[PIN_MAP_SIZE];
+
+#endif
@@ -0,0 +1,92 @@
+#include "stm32f4xx.h"
+#include "stm32f4xx_conf.h"
+#include "definitions.h"
+#include "delay.h"
+
+#define MAX_DELAY_CHUNK_US              1000000         // keeps cycles of one chunk far from the counter wrap
+
+static u32 cyclesPerMicrosecond = 0;
+
+/*
+    Start the cycle counter and calibrate it with HCLK from RCC_GetClocksFreq().
+    SystemCoreClock is not used, because InitRCC() changes the PLL without SystemCoreClockUpdate().
+    Call it after InitRCC() and again after any clock change.
+*/
+void InitDelay(void)
+{
+    RCC_ClocksTypeDef clocks;
+    
+    RCC_GetClocksFreq(&clocks);
+    
+    cyclesPerMicrosecond = clocks.HCLK_Frequency / 1000000;
+    if(cyclesPerMicrosecond == 0)
+    {
+        cyclesPerMicrosecond = 1;
+    }
+    
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+u32 GetCycleCounter(void)
+{
+    return DWT->CYCCNT;
+}
+
+u32 GetCyclesPerMicrosecond(void)
+{
+    if(cyclesPerMicrosecond == 0)
+    {
+        InitDelay();
+    }
+    
+    return cyclesPerMicrosecond;
+}
+
+u32 CyclesToMicroseconds(u32 cycles)
+{
+    return cycles / GetCyclesPerMicrosecond();
+}
+
+//Wait at least cycles HCLK periods, the call overhead is included
+void DelayCycles(u32 cycles)
+{
+    u32 start = DWT->CYCCNT;
+    
+    while((u32)(DWT->CYCCNT - start) < cycles)
+    {
+        //do nothing;
+    }
+}
+
+void DelayUs(u32 microseconds)
+{
+    u32 cycles = GetCyclesPerMicrosecond();
+    
+    while(microseconds > MAX_DELAY_CHUNK_US)
+    {
+        DelayCycles(MAX_DELAY_CHUNK_US * cycles);
+        microseconds -= MAX_DELAY_CHUNK_US;
+    }
+    
+    DelayCycles(microseconds * cycles);
+}
+
+//tDeadline *pDeadline - deadline to be set at now + microseconds, microseconds must be less than 21 s
+void StartDeadline(tDeadline *pDeadline, u32 microseconds)
+{
+    *pDeadline = DWT->CYCCNT + microseconds * GetCyclesPerMicrosecond();
+}
+
+int IsDeadlineElapsed(const tDeadline *pDeadline)
+{
+    if((s32)(DWT->CYCCNT - *pDeadline) >= 0)
+    {
+        return ELAPSED;
+    }
+    else
+    {
+        return NOT_ELAPSED;
+    }
+}
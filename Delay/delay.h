@@ -0,0 +1,21 @@
+#ifndef __DELAY_H
+#define __DELAY_H
+
+#include "stm32f4xx.h"
+
+/*
+    Busy-wait delays and timestamps on the DWT cycle counter (CYCCNT). The counter runs at HCLK,
+    it is 10 ns at 100 MHz and wraps every 42.9 s, so deadlines up to 21 s are compared safely.
+*/
+typedef u32 tDeadline;
+
+void InitDelay(void);
+u32 GetCycleCounter(void);
+u32 GetCyclesPerMicrosecond(void);
+u32 CyclesToMicroseconds(u32 cycles);
+void DelayCycles(u32 cycles);
+void DelayUs(u32 microseconds);
+void StartDeadline(tDeadline *pDeadline, u32 microseconds);
+int IsDeadlineElapsed(const tDeadline *pDeadline);
+
+#endif
@@ -13,8 +13,6 @@ LiquidCristal.cpp
 #include "LCD.h"
 
 
-extern RCC_ClocksTypeDef MYCLOCKS;
-
 size_t LCDwrite(uint8_t);
 void LCDcommand(uint8_t);
 
@@ -25,14 +23,7 @@ STM32F4_DISCOVERY_LOW_LEVEL Exported_Types
 extern uint32_t SystemCoreClock;
 uint32_t OneMkSecCNT;
 
-GPIO_TypeDef*  LCD_GPIO_PORT[LCDPins] = 
-{LCDB0_GPIO_PORT, LCDB1_GPIO_PORT, LCDB2_GPIO_PORT, LCDB3_GPIO_PORT, LCDE_GPIO_PORT, LCDRS_GPIO_PORT};
-
-const uint16_t LCD_GPIO_PIN[LCDPins] = 
-{LCD_PIN_B0, LCD_PIN_B1, LCD_PIN_B2, LCD_PIN_B3, LCD_PIN_E, LCD_PIN_RS};
-
-const uint32_t LCD_GPIO_CLK[LCDPins] = 
-{LCDB0_GPIO_CLK, LCDB1_GPIO_CLK, LCDB2_GPIO_CLK, LCDB3_GPIO_CLK, LCDE_GPIO_CLK, LCDRS_GPIO_CLK};
+// Pin level functions pinMode(), digitalWrite() and delayMicroseconds() are in LCDport.c
 
 // When the display powers up, it is configured as follows:
 //
@@ -69,6 +60,9 @@ static uint8_t _initialized=0;
 static uint8_t _numlines;
 static uint8_t _row_offsets[4];
 
+static uint8_t _cgram[8][8];    // copy of the glyphs loaded in CGRAM
+static uint8_t _cgram_valid;    // bit N is set when _cgram[N] matches CGRAM
+
 
 
 /* SET functions depending on HW configuration */
@@ -104,7 +98,6 @@ void InitLCD(void)
     LCDSet(RS,Enb,B0,B1,B2,B3);
     LCDnoDisplay();
     LCDdisplay();
-    delayMicroseconds(50000);
     
     //Write text
     sprintf(Row1, "       Hello!       ");
@@ -166,6 +159,7 @@ void LCDbegin(uint8_t cols, uint8_t lines, uint8_t dotsize)
         _displayfunction |= LCD_1LINE;
     }
     _numlines = lines;
+    _cgram_valid = 0;
     
     LCDsetRowOffsets(0x00, 0x40, 0x00 + cols, 0x40 + cols);  
     
@@ -193,9 +187,9 @@ void LCDbegin(uint8_t cols, uint8_t lines, uint8_t dotsize)
     
     // SEE PAGE 45/46 FOR INITIALIZATION SPECIFICATION!
     // according to datasheet, we need at least 40ms after power rises above 2.7V before 
-    // sending   commands. Arduino can turn on way before 4.5V so we'll wait 50   
+    // sending   commands.
     
-    delayMicroseconds(50000); 
+    delayMicroseconds(LCD_POWER_ON_TIME_US); 
     // Now we pull both RS and R/W low to begin commands
     digitalWrite(_rs_pin, LOW);
     digitalWrite(_enable_pin, LOW);
@@ -210,30 +204,28 @@ void LCDbegin(uint8_t cols, uint8_t lines, uint8_t dotsize)
         
         // we start in 8bit mode, try to set 4 bit mode
         LCDwrite4bits(0x03);
-        delayMicroseconds(4500); // wait min 4.1ms
+        delayMicroseconds(LCD_FIRST_FUNCTION_SET_TIME_US - LCD_EXECUTION_TIME_US); // wait min 4.1ms
         
         // second try
         LCDwrite4bits(0x03);
-        delayMicroseconds(4500); // wait min 4.5 ms
+        delayMicroseconds(LCD_FUNCTION_SET_TIME_US - LCD_EXECUTION_TIME_US); // wait min 100us
         
         // third go!
         LCDwrite4bits(0x03); 
-        delayMicroseconds(150);
         
         // finally, set to 4-bit interface
         LCDwrite4bits(0x02); 
-        delayMicroseconds(150);
     } else {
         // this is according to the hitachi HD44780 datasheet
         // page 45 figure 23
         
         // Send function set command sequence
         LCDcommand(LCD_FUNCTIONSET | _displayfunction);
-        delayMicroseconds(4500);  // wait more than 4.1ms
+        delayMicroseconds(LCD_FIRST_FUNCTION_SET_TIME_US - LCD_EXECUTION_TIME_US);  // wait more than 4.1ms
         
         // second try
         LCDcommand(LCD_FUNCTIONSET | _displayfunction);
-        delayMicroseconds(150);
+        delayMicroseconds(LCD_FUNCTION_SET_TIME_US - LCD_EXECUTION_TIME_US);
         
         // third go
         LCDcommand(LCD_FUNCTIONSET | _displayfunction);
@@ -268,13 +260,13 @@ void LCDsetRowOffsets(int row0, int row1, int row2, int row3)
 void LCDclear()
 {
     LCDcommand(LCD_CLEARDISPLAY);  // clear display, set cursor position to zero
-    delayMicroseconds(2000);  // this command takes a long time!
+    delayMicroseconds(LCD_CLEAR_HOME_TIME_US - LCD_EXECUTION_TIME_US);  // this command takes a long time!
 }
 
 void LCDhome()
 {
     LCDcommand(LCD_RETURNHOME);  // set cursor position to zero
-    delayMicroseconds(2000);  // this command takes a long time!
+    delayMicroseconds(LCD_CLEAR_HOME_TIME_US - LCD_EXECUTION_TIME_US);  // this command takes a long time!
 }
 
 void LCDsetCursor(uint8_t col, uint8_t row)
@@ -364,6 +356,20 @@ void LCDcreateChar(uint8_t location, uint8_t charmap[])
     }
 }
 
+// Same as LCDcreateChar, but the glyph is sent to the display
+// only when it differs from the one already loaded in this location
+void LCDupdateChar(uint8_t location, uint8_t charmap[])
+{
+    location &= 0x7;
+    if ((_cgram_valid & (1 << location)) && memcmp(_cgram[location], charmap, 8) == 0) {
+        return;
+    }
+    
+    LCDcreateChar(location, charmap);
+    memcpy(_cgram[location], charmap, 8);
+    _cgram_valid |= (1 << location);
+}
+
 /*********** mid level commands, for sending data/cmds */
 
 inline void LCDcommand(uint8_t value) {
@@ -394,13 +400,13 @@ void LCDsend(uint8_t value, uint8_t mode) {
     }
 }
 
+// RS and data lines are written before, the pin writes take more than tAS = 60 ns
+// Execution time is waited after each pulse, so LCDclear(), LCDhome() and the init sequence wait only the rest of their time
 void LCDpulseEnable(void) {
-    digitalWrite(_enable_pin, LOW);
-    delayMicroseconds(1);    
     digitalWrite(_enable_pin, HIGH);
-    delayMicroseconds(1);    // enable pulse must be >450ns
+    delayMicroseconds(LCD_ENABLE_PULSE_TIME_US);    // enable pulse must be >450ns
     digitalWrite(_enable_pin, LOW);
-    delayMicroseconds(100);   // commands need > 37us to settle
+    delayMicroseconds(LCD_EXECUTION_TIME_US);   // commands need > 37us to settle
 }
 
 void LCDwrite4bits(uint8_t value) {
@@ -421,92 +427,6 @@ void LCDwrite8bits(uint8_t value) {
     LCDpulseEnable();
 }
 
-/**
-* @brief  Configures GPIO input or output pins according to LCD pins connected.
-* @param  pin: Specifies the PINx to be configured. 
-*   This parameter can be one of following parameters:
-*     @arg B1, B0, B2, B3, RS, E
-*     
-* @retval None
-*/
-
-void    pinMode(LCD_TypeDef pin, uint8_t mode)
-{
-    GPIO_InitTypeDef  GPIO_InitStructure;
-    
-    if ( mode == OUTPUT ){
-        /* Enable the GPIO_PINx Clock */
-        RCC_AHB1PeriphClockCmd(LCD_GPIO_CLK[pin], ENABLE);
-        
-        /* Configure the GPIO_PINx pin */
-        GPIO_InitStructure.GPIO_Pin = LCD_GPIO_PIN[pin];
-        GPIO_InitStructure.GPIO_Mode = GPIO_Mode_OUT;
-        GPIO_InitStructure.GPIO_OType = GPIO_OType_PP;
-        if ( pin == Enb ) 
-            GPIO_InitStructure.GPIO_PuPd = GPIO_PuPd_UP; // GPIO_PuPd_NOPULL; 
-        else 
-            GPIO_InitStructure.GPIO_PuPd =  GPIO_PuPd_NOPULL; 
-        GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
-        GPIO_Init(LCD_GPIO_PORT[pin], &GPIO_InitStructure);
-        
-    } else if (mode == INPUT && pin == B0) {
-        RCC_AHB1PeriphClockCmd(LCD_GPIO_CLK[pin], ENABLE);
-        RCC_APB2PeriphClockCmd(RCC_APB2Periph_SYSCFG, ENABLE);
-        
-        /* Configure Button pin as input */
-        GPIO_InitStructure.GPIO_Mode = GPIO_Mode_IN;
-        GPIO_InitStructure.GPIO_PuPd = GPIO_PuPd_NOPULL;
-        GPIO_InitStructure.GPIO_Pin = LCD_GPIO_CLK[pin];
-        GPIO_Init(LCD_GPIO_PORT[pin], &GPIO_InitStructure);
-        
-    } else 
-        ;
-    
-}
-
-
-uint8_t  digitalRead(LCD_TypeDef pin)
-{
-    return 0; // not used
-}
-
-
-void  digitalWrite(LCD_TypeDef pin, uint8_t mode)
-{
-    if (mode == LOW ){
-        LCD_GPIO_PORT[pin]->BSRRH = LCD_GPIO_PIN[pin];
-    } else if (mode == HIGH ){
-        LCD_GPIO_PORT[pin]->BSRRL = LCD_GPIO_PIN[pin];
-    } else 
-        ;
-    
-}
-
-void delayMicroseconds(unsigned long mksec)
-{
-    
-    //    unsigned rpt;
-    //    char m=0;
-    //    unsigned cntr=9;
-    //    /* normal */
-    //    while( mksec--){ // 5+4 clk init
-    //      for ( rpt = cntr; rpt; rpt--);  // 6 clk cyclle
-    //    }
-    unsigned long i, cycles;
-    
-    //      1, sec                           ----> 100 000 000, cycles
-    //      1, micro sec (0.000001, sec)     ----> X, cycles
-    //      X, cycles = (100 000 000, cycles * 0.000001, s) / 1, s
-    unsigned int cyclesPer1microSecond = (unsigned int)(0.000001 * MYCLOCKS.SYSCLK_Frequency);
-    
-    cycles = cyclesPer1microSecond * mksec;
-    
-    for(i = 0; i < cycles; i++)
-    {
-        //do nothing;
-    }
-}
-
 uint16_t LCDStrWrite(const uint8_t *buffer, uint16_t size)
 {
     uint16_t n = 0;
@@ -46,6 +46,20 @@
 #define OUTPUT 33
 #define INPUT 44
 
+// HD44780 timing, the datasheet typical values at fosc = 270 kHz, us
+#define LCD_POWER_ON_TIME_US            40000   // after VCC rises to 2.7 V
+#define LCD_ENABLE_PULSE_TIME_US        1       // PWEH 450 ns, tcycE 1000 ns
+
+// Execution times scale with the controller oscillator, it may run down to 190 kHz on slow parts
+#define LCD_NOMINAL_OSC_KHZ             270
+#define LCD_SLOWEST_OSC_KHZ             190
+#define LCD_OSC_SCALED(us)              (((us) * LCD_NOMINAL_OSC_KHZ + LCD_SLOWEST_OSC_KHZ - 1) / LCD_SLOWEST_OSC_KHZ)
+
+#define LCD_FIRST_FUNCTION_SET_TIME_US  LCD_OSC_SCALED(4100)
+#define LCD_FUNCTION_SET_TIME_US        LCD_OSC_SCALED(100)
+#define LCD_CLEAR_HOME_TIME_US          LCD_OSC_SCALED(1520)
+#define LCD_EXECUTION_TIME_US           LCD_OSC_SCALED(41)      // 37 us of the instruction + tADD 4 us
+
 //constants
 #define ROW_LENGHT              21
 
@@ -91,6 +105,7 @@ void LCDnoAutoscroll();
 
 void LCDsetRowOffsets(int row1, int row2, int row3, int row4);
 void LCDcreateChar(uint8_t, uint8_t[]);
+void LCDupdateChar(uint8_t, uint8_t[]);
 void LCDsetCursor(uint8_t, uint8_t); 
 
 void LCDsend(uint8_t, uint8_t);
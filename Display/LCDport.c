@@ -0,0 +1,85 @@
+/*
+LCD pin level functions for STM32F4. 
+They are separated from LCD.c, so the display protocol can be run over other pins' implementation.
+*/
+#include <stdint.h>
+#include "stm32f4xx.h"
+#include "stm32f4xx_conf.h"
+#include "delay.h"
+#include "LCD.h"
+
+
+GPIO_TypeDef*  LCD_GPIO_PORT[LCDPins] = 
+{LCDB0_GPIO_PORT, LCDB1_GPIO_PORT, LCDB2_GPIO_PORT, LCDB3_GPIO_PORT, LCDE_GPIO_PORT, LCDRS_GPIO_PORT};
+
+const uint16_t LCD_GPIO_PIN[LCDPins] = 
+{LCD_PIN_B0, LCD_PIN_B1, LCD_PIN_B2, LCD_PIN_B3, LCD_PIN_E, LCD_PIN_RS};
+
+const uint32_t LCD_GPIO_CLK[LCDPins] = 
+{LCDB0_GPIO_CLK, LCDB1_GPIO_CLK, LCDB2_GPIO_CLK, LCDB3_GPIO_CLK, LCDE_GPIO_CLK, LCDRS_GPIO_CLK};
+
+/**
+* @brief  Configures GPIO input or output pins according to LCD pins connected.
+* @param  pin: Specifies the PINx to be configured. 
+*   This parameter can be one of following parameters:
+*     @arg B1, B0, B2, B3, RS, E
+*     
+* @retval None
+*/
+
+void    pinMode(LCD_TypeDef pin, uint8_t mode)
+{
+    GPIO_InitTypeDef  GPIO_InitStructure;
+    
+    if ( mode == OUTPUT ){
+        /* Enable the GPIO_PINx Clock */
+        RCC_AHB1PeriphClockCmd(LCD_GPIO_CLK[pin], ENABLE);
+        
+        /* Configure the GPIO_PINx pin */
+        GPIO_InitStructure.GPIO_Pin = LCD_GPIO_PIN[pin];
+        GPIO_InitStructure.GPIO_Mode = GPIO_Mode_OUT;
+        GPIO_InitStructure.GPIO_OType = GPIO_OType_PP;
+        if ( pin == Enb ) 
+            GPIO_InitStructure.GPIO_PuPd = GPIO_PuPd_UP; // GPIO_PuPd_NOPULL; 
+        else 
+            GPIO_InitStructure.GPIO_PuPd =  GPIO_PuPd_NOPULL; 
+        GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+        GPIO_Init(LCD_GPIO_PORT[pin], &GPIO_InitStructure);
+        
+    } else if (mode == INPUT && pin == B0) {
+        RCC_AHB1PeriphClockCmd(LCD_GPIO_CLK[pin], ENABLE);
+        RCC_APB2PeriphClockCmd(RCC_APB2Periph_SYSCFG, ENABLE);
+        
+        /* Configure Button pin as input */
+        GPIO_InitStructure.GPIO_Mode = GPIO_Mode_IN;
+        GPIO_InitStructure.GPIO_PuPd = GPIO_PuPd_NOPULL;
+        GPIO_InitStructure.GPIO_Pin = LCD_GPIO_CLK[pin];
+        GPIO_Init(LCD_GPIO_PORT[pin], &GPIO_InitStructure);
+        
+    } else 
+        ;
+    
+}
+
+
+uint8_t  digitalRead(LCD_TypeDef pin)
+{
+    return 0; // not used
+}
+
+
+void  digitalWrite(LCD_TypeDef pin, uint8_t mode)
+{
+    if (mode == LOW ){
+        LCD_GPIO_PORT[pin]->BSRRH = LCD_GPIO_PIN[pin];
+    } else if (mode == HIGH ){
+        LCD_GPIO_PORT[pin]->BSRRL = LCD_GPIO_PIN[pin];
+    } else 
+        ;
+    
+}
+
+void delayMicroseconds(unsigned long mksec)
+{
+    DelayUs(mksec);
+}
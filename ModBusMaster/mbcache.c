@@ -0,0 +1,165 @@
+#include "stm32f4xx.h"
+#include "definitions.h"
+#include "VTimer.h"
+#include "mbmaster.h"
+#include "mbcache.h"
+
+
+/* Values read from the slaves, keyed by slave, table and address */
+typedef struct mbCacheSlave{
+    tMBCacheEntry coils[MB_CACHE_BITS_NUMBER];
+    tMBCacheEntry inputs[MB_CACHE_BITS_NUMBER];
+    tMBCacheEntry holdingRegisters[MB_CACHE_REGISTERS_NUMBER];
+}tMBCacheSlave;
+
+static tMBCacheSlave CacheSlaves[MB_CACHE_SLAVES_NUMBER];
+
+/*
+    Entries of the range in one table of one slave
+    return 0 if the slave or any address of the range is not cached
+*/
+static tMBCacheEntry *GetCacheEntries(unsigned char slaveID, eMBCacheTable table, unsigned short start, unsigned short count)
+{
+    tMBCacheSlave *pSlave;
+    
+    if(slaveID < 1 || slaveID > MB_CACHE_SLAVES_NUMBER)
+    {
+        return 0;
+    }
+    pSlave = &CacheSlaves[slaveID - 1];
+    
+    switch(table)
+    {
+    case MB_TABLE_COILS:
+        return ((unsigned long)start + count <= MB_CACHE_BITS_NUMBER) ? &pSlave->coils[start] : 0;
+    case MB_TABLE_INPUTS:
+        return ((unsigned long)start + count <= MB_CACHE_BITS_NUMBER) ? &pSlave->inputs[start] : 0;
+    case MB_TABLE_HOLDING_REGISTERS:
+        return ((unsigned long)start + count <= MB_CACHE_REGISTERS_NUMBER) ? &pSlave->holdingRegisters[start] : 0;
+    default:
+        return 0;
+    }
+}
+
+// Check that the range can be kept in the cache
+BOOL MBIsCachedRange(unsigned char slaveID, eMBCacheTable table, unsigned short start, unsigned short count)
+{
+    return (GetCacheEntries(slaveID, table, start, count) != 0) ? TRUE : FALSE;
+}
+
+void InitMBCache(void)
+{
+    int i, j;
+    
+    for(i = 0; i < MB_CACHE_SLAVES_NUMBER; i++)
+    {
+        for(j = 0; j < MB_CACHE_TABLES_NUMBER; j++)
+        {
+            MBCacheInvalidate(i + 1, (eMBCacheTable)j, 0, (j == MB_TABLE_HOLDING_REGISTERS) ? MB_CACHE_REGISTERS_NUMBER : MB_CACHE_BITS_NUMBER);
+        }
+    }
+}
+
+/*
+    Keep values of a successful read, all of them get the same time stamp
+    const unsigned short *pValues - registers or bits (0, 1) from start
+*/
+void MBCacheStore(unsigned char slaveID, eMBCacheTable table, unsigned short start, unsigned short count, const unsigned short *pValues)
+{
+    tMBCacheEntry *pEntries = GetCacheEntries(slaveID, table, start, count);
+    u32 now = GetTimerCounter();
+    unsigned short i;
+    
+    if(pEntries == 0)
+    {
+        return;
+    }
+    
+    for(i = 0; i < count; i++)
+    {
+        pEntries[i].value = pValues[i];
+        pEntries[i].stamp = now;
+        pEntries[i].isValid = TRUE;
+    }
+}
+
+/*
+    Forget values which were written, the slave may keep other values than the written ones
+    unsigned char slaveID - BROADCAST_SLAVE_ID for all slaves
+*/
+void MBCacheInvalidate(unsigned char slaveID, eMBCacheTable table, unsigned short start, unsigned short count)
+{
+    tMBCacheEntry *pEntries;
+    unsigned short i;
+    int slave;
+    
+    if(slaveID == BROADCAST_SLAVE_ID)
+    {
+        for(slave = 1; slave <= MB_CACHE_SLAVES_NUMBER; slave++)
+        {
+            MBCacheInvalidate(slave, table, start, count);
+        }
+        return;
+    }
+    
+    pEntries = GetCacheEntries(slaveID, table, start, count);
+    if(pEntries == 0)
+    {
+        return;
+    }
+    
+    for(i = 0; i < count; i++)
+    {
+        pEntries[i].isValid = FALSE;
+    }
+}
+
+/*
+    Check that all values of the range were read not longer than maxAge ago
+    u32 maxAge - ms, MB_CACHE_ANY_AGE for any valid value
+*/
+BOOL MBCacheIsFresh(unsigned char slaveID, eMBCacheTable table, unsigned short start, unsigned short count, u32 maxAge)
+{
+    tMBCacheEntry *pEntries = GetCacheEntries(slaveID, table, start, count);
+    u32 now = GetTimerCounter();
+    unsigned short i;
+    
+    if(pEntries == 0)
+    {
+        return FALSE;
+    }
+    
+    for(i = 0; i < count; i++)
+    {
+        // counter wraps after 49.7 days, the unsigned difference is the age anyway
+        if(pEntries[i].isValid == FALSE || (u32)(now - pEntries[i].stamp) > maxAge)
+        {
+            return FALSE;
+        }
+    }
+    
+    return TRUE;
+}
+
+/*
+    Read values of the range from the cache
+    return TRUE if all of them are fresh (see MBCacheIsFresh()), otherwise pValues are not changed
+*/
+BOOL MBCacheRead(unsigned char slaveID, eMBCacheTable table, unsigned short start, unsigned short count, u32 maxAge, unsigned short *pValues)
+{
+    tMBCacheEntry *pEntries;
+    unsigned short i;
+    
+    if(MBCacheIsFresh(slaveID, table, start, count, maxAge) == FALSE)
+    {
+        return FALSE;
+    }
+    
+    pEntries = GetCacheEntries(slaveID, table, start, count);
+    for(i = 0; i < count; i++)
+    {
+        pValues[i] = pEntries[i].value;
+    }
+    
+    return TRUE;
+}
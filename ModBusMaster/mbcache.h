@@ -0,0 +1,34 @@
+#ifndef __MBCACHE_H
+#define __MBCACHE_H
+
+#include "definitions.h"
+
+#define MB_CACHE_SLAVES_NUMBER                  10              /* slave IDs 1 - 10 */
+#define MB_CACHE_REGISTERS_NUMBER               100             /* holding registers 0 - 99 */
+#define MB_CACHE_BITS_NUMBER                    16              /* coils and inputs 0 - 15 */
+#define MB_CACHE_ANY_AGE                        0xFFFFFFFF      /* maxAge for any value which was read once */
+
+/* Tables of the slave which the master reads */
+typedef enum
+{
+    MB_TABLE_COILS,                                     /* FC 1, written by FC 5, 15 */
+    MB_TABLE_INPUTS,                                    /* FC 2 */
+    MB_TABLE_HOLDING_REGISTERS,                         /* FC 3, written by FC 16 */
+    MB_CACHE_TABLES_NUMBER
+}eMBCacheTable;
+
+/* Decoded value of one address, bits are 0 or 1 */
+typedef struct mbCacheEntry{
+    unsigned short value;
+    BOOL isValid;
+    u32 stamp;                                          /* GetTimerCounter() when the value was read, ms */
+}tMBCacheEntry;
+
+void InitMBCache(void);
+BOOL MBIsCachedRange(unsigned char slaveID, eMBCacheTable table, unsigned short start, unsigned short count);
+void MBCacheStore(unsigned char slaveID, eMBCacheTable table, unsigned short start, unsigned short count, const unsigned short *pValues);
+void MBCacheInvalidate(unsigned char slaveID, eMBCacheTable table, unsigned short start, unsigned short count);
+BOOL MBCacheIsFresh(unsigned char slaveID, eMBCacheTable table, unsigned short start, unsigned short count, u32 maxAge);
+BOOL MBCacheRead(unsigned char slaveID, eMBCacheTable table, unsigned short start, unsigned short count, u32 maxAge, unsigned short *pValues);
+
+#endif
@@ -0,0 +1,174 @@
+#include "stm32f4xx.h"
+#include "definitions.h"
+#include "mbmaster.h"
+#include "mbdecode.h"
+
+
+#define MB_EXCEPTION_FLAG                       0x80
+
+/*
+    View of the registers of FC 3, 4 or 23 response, the response must be checked by MBParseBuffer()
+    const unsigned char *Buffer - response, the view points into it,
+    int bytesRead - length of the response with CRC
+    return 0, SPECIFIC_MODBUS_ERROR for exception response, PACKET_SIZE_MISMATCH_ERROR if it has no registers
+*/
+int MBDecodeRegisters(const unsigned char *Buffer, int bytesRead, tMBRegisterView *pView)
+{
+    pView->pData = 0;
+    pView->count = 0;
+    
+    if(bytesRead >= 2 && (Buffer[1] & MB_EXCEPTION_FLAG))
+    {
+        return SPECIFIC_MODBUS_ERROR;
+    }
+    
+    if(bytesRead < PACKET_HEADER_AND_CRC || (Buffer[1] != 3 && Buffer[1] != 4 && Buffer[1] != 23))
+    {
+        return PACKET_SIZE_MISMATCH_ERROR;
+    }
+    
+    if(Buffer[2] != bytesRead - PACKET_HEADER_AND_CRC || (Buffer[2] & 0x01))
+    {
+        return PACKET_SIZE_MISMATCH_ERROR;
+    }
+    
+    pView->pData = &Buffer[3];
+    pView->count = Buffer[2] / 2;
+    
+    return 0;
+}
+
+/*
+    View of the coils or inputs of FC 1 or 2 response, the response must be checked by MBParseBuffer()
+    unsigned short quantity - bits of the query, the response has whole bytes only
+    return 0, SPECIFIC_MODBUS_ERROR for exception response, PACKET_SIZE_MISMATCH_ERROR if the bits don't fit
+*/
+int MBDecodeBits(const unsigned char *Buffer, int bytesRead, unsigned short quantity, tMBBitView *pView)
+{
+    pView->pData = 0;
+    pView->count = 0;
+    
+    if(bytesRead >= 2 && (Buffer[1] & MB_EXCEPTION_FLAG))
+    {
+        return SPECIFIC_MODBUS_ERROR;
+    }
+    
+    if(bytesRead < PACKET_HEADER_AND_CRC || (Buffer[1] != 1 && Buffer[1] != 2))
+    {
+        return PACKET_SIZE_MISMATCH_ERROR;
+    }
+    
+    if(Buffer[2] != bytesRead - PACKET_HEADER_AND_CRC || Buffer[2] != (quantity + 7) / 8)
+    {
+        return PACKET_SIZE_MISMATCH_ERROR;
+    }
+    
+    pView->pData = &Buffer[3];
+    pView->count = quantity;
+    
+    return 0;
+}
+
+// Register of the view, index beyond the view reads as 0
+unsigned short MBGetViewRegister(const tMBRegisterView *pView, unsigned short index)
+{
+    if(index >= pView->count)
+    {
+        return 0;
+    }
+    
+    return ((unsigned short)pView->pData[2*index] << 8) | pView->pData[2*index + 1];
+}
+
+signed short MBGetViewSigned(const tMBRegisterView *pView, unsigned short index)
+{
+    return (signed short)MBGetViewRegister(pView, index);
+}
+
+/*
+    32-bit value of registers index and index + 1
+    eMBWordOrder order - order of the device
+*/
+unsigned long MBGetViewLong(const tMBRegisterView *pView, unsigned short index, eMBWordOrder order)
+{
+    const unsigned char *pBytes;
+    
+    if(index + 1 >= pView->count)
+    {
+        return 0;
+    }
+    pBytes = &pView->pData[2*index];
+    
+    switch(order)
+    {
+    case MB_ORDER_CDAB:
+        return ((unsigned long)pBytes[2] << 24) | ((unsigned long)pBytes[3] << 16) | ((unsigned long)pBytes[0] << 8) | pBytes[1];
+    case MB_ORDER_BADC:
+        return ((unsigned long)pBytes[1] << 24) | ((unsigned long)pBytes[0] << 16) | ((unsigned long)pBytes[3] << 8) | pBytes[2];
+    case MB_ORDER_DCBA:
+        return ((unsigned long)pBytes[3] << 24) | ((unsigned long)pBytes[2] << 16) | ((unsigned long)pBytes[1] << 8) | pBytes[0];
+    case MB_ORDER_ABCD:
+    default:
+        return ((unsigned long)pBytes[0] << 24) | ((unsigned long)pBytes[1] << 16) | ((unsigned long)pBytes[2] << 8) | pBytes[3];
+    }
+}
+
+// IEEE 754 single of registers index and index + 1
+float MBGetViewFloat(const tMBRegisterView *pView, unsigned short index, eMBWordOrder order)
+{
+    union
+    {
+        u32 bits;
+        float value;
+    }convert;
+    
+    convert.bits = (u32)MBGetViewLong(pView, index, order);
+    return convert.value;
+}
+
+// Copy registers of the view to an array, for the data which must outlive the response buffer
+void MBCopyViewRegisters(const tMBRegisterView *pView, unsigned short index, unsigned short count, unsigned short *pValues)
+{
+    unsigned short i;
+    
+    for(i = 0; i < count; i++)
+    {
+        pValues[i] = MBGetViewRegister(pView, index + i);
+    }
+}
+
+// Bit of the view, index beyond the view reads as FALSE
+BOOL MBGetViewBit(const tMBBitView *pView, unsigned short index)
+{
+    if(index >= pView->count)
+    {
+        return FALSE;
+    }
+    
+    return (pView->pData[index / 8] & (1 << (index % 8))) ? TRUE : FALSE;
+}
+
+/*
+    Up to 32 bits of the view as a mask, bit 0 is the bit index
+    unsigned short count - 1 - 32
+*/
+unsigned long MBGetViewBitset(const tMBBitView *pView, unsigned short index, unsigned short count)
+{
+    unsigned long bitset = 0;
+    unsigned short i;
+    
+    if(count > 32)
+    {
+        count = 32;
+    }
+    
+    for(i = 0; i < count; i++)
+    {
+        if(MBGetViewBit(pView, index + i) == TRUE)
+        {
+            bitset |= 1UL << i;
+        }
+    }
+    
+    return bitset;
+}
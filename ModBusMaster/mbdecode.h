@@ -0,0 +1,44 @@
+#ifndef __MBDECODE_H
+#define __MBDECODE_H
+
+#include "definitions.h"
+
+/*
+    Order of the 4 bytes of 32-bit value in two registers, A is the most significant byte.
+    ModBus defines only 16-bit registers, so every device picks its own.
+*/
+typedef enum
+{
+    MB_ORDER_ABCD,                                      /* high word first, big-endian words - Modicon convention */
+    MB_ORDER_CDAB,                                      /* low word first */
+    MB_ORDER_BADC,                                      /* high word first, bytes of the words swapped */
+    MB_ORDER_DCBA                                       /* little-endian */
+}eMBWordOrder;
+
+/*
+    Views of the data of a read response. They point into the response buffer and don't own it -
+    values are decoded when they are taken, nothing is copied, so a view is valid only until the next query.
+*/
+typedef struct mbRegisterView{
+    const unsigned char *pData;                         /* 2 bytes per register, high byte first */
+    unsigned short count;
+}tMBRegisterView;
+
+typedef struct mbBitView{
+    const unsigned char *pData;                         /* 8 bits per byte, lowest address in the lowest bit */
+    unsigned short count;
+}tMBBitView;
+
+int MBDecodeRegisters(const unsigned char *Buffer, int bytesRead, tMBRegisterView *pView);
+int MBDecodeBits(const unsigned char *Buffer, int bytesRead, unsigned short quantity, tMBBitView *pView);
+
+unsigned short MBGetViewRegister(const tMBRegisterView *pView, unsigned short index);
+signed short MBGetViewSigned(const tMBRegisterView *pView, unsigned short index);
+unsigned long MBGetViewLong(const tMBRegisterView *pView, unsigned short index, eMBWordOrder order);
+float MBGetViewFloat(const tMBRegisterView *pView, unsigned short index, eMBWordOrder order);
+void MBCopyViewRegisters(const tMBRegisterView *pView, unsigned short index, unsigned short count, unsigned short *pValues);
+
+BOOL MBGetViewBit(const tMBBitView *pView, unsigned short index);
+unsigned long MBGetViewBitset(const tMBBitView *pView, unsigned short index, unsigned short count);
+
+#endif
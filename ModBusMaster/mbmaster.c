@@ -1,7 +1,11 @@
+#include "stm32f4xx.h"
 #include "definitions.h"
 #include "mbcrc.h"
 #include "serial.h"
+#include "VTimer.h"
+#include "usart.h"
 #include "mbmaster.h"
+#include "mbtiming.h"
 
 extern unsigned char QueryBuffer[QUERY_MAX_SIZE];
 extern unsigned char MBMasterResponseBuffer[RESPONSE_MAX_SIZE];
@@ -10,6 +14,7 @@ unsigned char MBMasterResponseBuffer[RESPONSE_MAX_SIZE];
 unsigned char QueryBuffer[QUERY_MAX_SIZE];
 
 int MBMasterQueryBufferLenght;
+static int MBMasterResponseLength;                      /* response of the last query in MBMasterResponseBuffer, 0 if there is none */
 
 /*
     This function writes in slave's holding registers
@@ -35,11 +40,11 @@ void PresetMultipleRegisters(unsigned char slaveID, unsigned char startAddress,
     for(i = 0; i < registersCount; i++)
     {
         //get Data Hi
-        temp = (holdingRegistersValues[i] * 0xFF00) >> 8;
+        temp = (unsigned char)(holdingRegistersValues[i] >> 8);
         QueryBuffer[2*i + 7] = temp;
         
         // get Data Lo
-        temp = holdingRegistersValues[i] * 0x00FF;
+        temp = (unsigned char)(holdingRegistersValues[i] & 0x00FF);
         QueryBuffer[2*i + 8] = temp;
     }
     
@@ -72,14 +77,14 @@ void ForceMultipleCoils(unsigned char slaveID, unsigned char coilAddress, unsign
     QueryBuffer[3] = coilAddress;
     QueryBuffer[4] = 0;
     QueryBuffer[5] = quantityOfCoils;
-    QueryBuffer[6] = (quantityOfCoils / 8) ? 2:1;
-    QueryBuffer[7] = coilsData * 0x00FF;
+    QueryBuffer[6] = (quantityOfCoils > 8) ? 2:1;
+    QueryBuffer[7] = (unsigned char)(coilsData & 0x00FF);
     
     queryLenght = 8;
     
     if(QueryBuffer[6] == 2)
     {
-        QueryBuffer[8] = (coilsData * 0xFF00) >> 8;
+        QueryBuffer[8] = (unsigned char)(coilsData >> 8);
         queryLenght = 9;
     }
     
@@ -206,43 +211,268 @@ void ReadCoilStatus(unsigned char slaveID, unsigned char startingAddress, unsign
 }
 
 
-void MBMaster(void)
+/*
+    Values which the query writes are not cached any more - even if the response is lost, the slave may have changed them
+*/
+static void MBInvalidateWrittenData(const unsigned char *CommandArray)
+{
+    unsigned short start = ((unsigned short)CommandArray[2] << 8) | CommandArray[3];
+    unsigned short count = ((unsigned short)CommandArray[4] << 8) | CommandArray[5];
+    
+    switch(CommandArray[1])
+    {
+    case 5:
+        MBCacheInvalidate(CommandArray[0], MB_TABLE_COILS, start, 1);
+        break;
+    case 15:
+        MBCacheInvalidate(CommandArray[0], MB_TABLE_COILS, start, count);
+        break;
+    case 16:
+        MBCacheInvalidate(CommandArray[0], MB_TABLE_HOLDING_REGISTERS, start, count);
+        break;
+    }
+}
+
+/*
+    Decode response of a read checked by MBParseBuffer() and keep the values in the cache
+    return 0 or PACKET_SIZE_MISMATCH_ERROR when the data does not match the query
+*/
+static int MBStoreResponse(const unsigned char *Buffer, int bytesRead, const unsigned char *CommandArray)
+{
+    unsigned short values[MB_CACHE_REGISTERS_NUMBER];
+    unsigned short start = ((unsigned short)CommandArray[2] << 8) | CommandArray[3];
+    unsigned short count = ((unsigned short)CommandArray[4] << 8) | CommandArray[5];
+    unsigned short i;
+    tMBRegisterView registers;
+    tMBBitView bits;
+    
+    if(count > MB_CACHE_REGISTERS_NUMBER)
+    {
+        return 0;                                       //not cached anyway
+    }
+    
+    switch(Buffer[1])
+    {
+    case 1:
+    case 2:
+        if(MBDecodeBits(Buffer, bytesRead, count, &bits) != 0)
+        {
+            return PACKET_SIZE_MISMATCH_ERROR;
+        }
+        for(i = 0; i < count; i++)
+        {
+            values[i] = MBGetViewBit(&bits, i);
+        }
+        MBCacheStore(Buffer[0], (Buffer[1] == 1) ? MB_TABLE_COILS : MB_TABLE_INPUTS, start, count, values);
+        break;
+    case 3:
+        if(MBDecodeRegisters(Buffer, bytesRead, &registers) != 0 || registers.count != count)
+        {
+            return PACKET_SIZE_MISMATCH_ERROR;
+        }
+        MBCopyViewRegisters(&registers, 0, count, values);
+        MBCacheStore(Buffer[0], MB_TABLE_HOLDING_REGISTERS, start, count, values);
+        break;
+    }
+    
+    return 0;
+}
+
+// Busy wait, the master blocks the main loop while it waits for the bus anyway
+static void MBMasterWait(u32 miliseconds)
+{
+    SetVTimerValue(MB_MASTER_TIMER, miliseconds);
+    while(IsVTimerElapsed(MB_MASTER_TIMER) == NOT_ELAPSED)
+    {
+    }
+}
+
+void InitMBMaster(void)
+{
+    InitMBCache();
+    InitMBTiming();
+}
+
+/*
+    Send the composed query and wait for the response, read values are kept in the cache.
+    Query without valid response is repeated up to MB_MASTER_RETRIES times with growing backoff and timeout,
+    offline slave gets only one query per MB_OFFLINE_PROBE_PERIOD (see mbtiming.h).
+    return 0 or error code of GetMBAnswer() / MBParseBuffer(), SLAVE_OFFLINE_ERROR if the query was not sent
+*/
+int MBMaster(void)
 {
    int bytesRead = 0, bytesWritten;
    int result = 0;	
+   int attempt, attempts;
+   u32 responseTime = 0;
+   unsigned char slaveID = QueryBuffer[0];
 
-   //USART_2 must be used   
-   bytesWritten = OutString(QueryBuffer, MBMasterQueryBufferLenght, USART_2, MB_MASTER_TIMER, T_10_MS);//??????????????????????does timing Ok?????????????????
-   if(bytesWritten != MBMasterQueryBufferLenght)
+   MBInvalidateWrittenData(QueryBuffer);
+   MBMasterResponseLength = 0;
+   
+   //there is no response to broadcast - give the slaves time to process it before the next query
+   if(slaveID == BROADCAST_SLAVE_ID)
    {
-       return;
+       //USART_2 must be used   
+       bytesWritten = OutString(QueryBuffer, MBMasterQueryBufferLenght, USART_2, MB_MASTER_TIMER, T_10_MS);
+       MBMasterWait(BROADCAST_TURNAROUND_TIME);
+       return (bytesWritten == MBMasterQueryBufferLenght) ? 0 : TRANSMIT_TIMEOUT_ERROR;
    }
    
-   bytesRead = GetMBAnswer(MBMasterResponseBuffer);
+   if(MBStartSlaveQuery(slaveID) == FALSE)
+   {
+       return SLAVE_OFFLINE_ERROR;
+   }
+   
+   //offline slave is only probed, a retry would cost the bus time again
+   attempts = (MBIsSlaveOffline(slaveID) == TRUE) ? 1 : 1 + MB_MASTER_RETRIES;
    
-   //bytesRead < 0 when there is error in recieving response
-   if(bytesRead >= 0)
+   for(attempt = 0; attempt < attempts; attempt++)
    {
-       result = MBParseBuffer(MBMasterResponseBuffer, QueryBuffer, bytesRead);		
-       if(result == 0)
+       if(attempt > 0)
+       {
+           MBMasterWait(MB_RETRY_BACKOFF << (attempt - 1));
+       }
+       
+       bytesWritten = OutString(QueryBuffer, MBMasterQueryBufferLenght, USART_2, MB_MASTER_TIMER, T_10_MS);
+       if(bytesWritten != MBMasterQueryBufferLenght)
        {
-           //do something with responce
+           return TRANSMIT_TIMEOUT_ERROR;               //our side fails, the slave is not to blame
        }
+       
+       bytesRead = GetMBAnswer(MBMasterResponseBuffer, MBGetResponseTimeout(slaveID), &responseTime);
+       
+       //bytesRead < 0 when there is error in recieving response
+       result = (bytesRead < 0) ? bytesRead : MBParseBuffer(MBMasterResponseBuffer, QueryBuffer, bytesRead);
+       
+       //exception response is an answer too, repeating the query gives the same one
+       if(result == 0 || result == SPECIFIC_MODBUS_ERROR)
+       {
+           MBRecordResponse(slaveID, responseTime, (attempt > 0) ? TRUE : FALSE);
+           MBMasterResponseLength = bytesRead;
+           //slave answered, a response which does not match the query is not retried
+           if(result == 0)
+           {
+               result = MBStoreResponse(MBMasterResponseBuffer, bytesRead, QueryBuffer);
+           }
+           return result;
+       }
+       
+       MBRecordAttemptFailure(slaveID, (attempt + 1 < attempts) ? TRUE : FALSE);
    }
-   return;
+   
+   MBRecordQueryFailure(slaveID);
+   return result;
 }
 
-int GetMBAnswer(unsigned char *Buffer)
+/*
+    Registers of the last response (FC 3) as a view into MBMasterResponseBuffer, valid until the next query
+    return 0 or error code of MBDecodeRegisters()
+*/
+int MBGetResponseRegisters(tMBRegisterView *pView)
+{
+    return MBDecodeRegisters(MBMasterResponseBuffer, MBMasterResponseLength, pView);
+}
+
+/*
+    Coils or inputs of the last response (FC 1, 2) as a view into MBMasterResponseBuffer, valid until the next query
+    return 0 or error code of MBDecodeBits()
+*/
+int MBGetResponseBits(tMBBitView *pView)
+{
+    unsigned short quantity = ((unsigned short)QueryBuffer[4] << 8) | QueryBuffer[5];
+    
+    return MBDecodeBits(MBMasterResponseBuffer, MBMasterResponseLength, quantity, pView);
+}
+
+/*
+    Read through the cache - the bus is used only when any value of the range is older than maxAge,
+    so pollers and readers of the same data share one query
+    unsigned char slaveID - 1 - 10,
+    eMBCacheTable table - coils, inputs or holding registers,
+    unsigned char startAddress, unsigned char count - range of the table,
+    u32 maxAge - ms, the oldest value which is good enough,
+    unsigned short *pValues - registers or bits (0, 1)
+    return 0 or error code of MBMaster(), PACKET_SIZE_MISMATCH_ERROR when the response did not give the values
+*/
+int MBMasterRead(unsigned char slaveID, eMBCacheTable table, unsigned char startAddress, unsigned char count, u32 maxAge, unsigned short *pValues)
+{
+    int result;
+    
+    if(MBIsCachedRange(slaveID, table, startAddress, count) == FALSE)
+    {
+        return NOT_CACHED_ERROR;
+    }
+    
+    if(MBCacheRead(slaveID, table, startAddress, count, maxAge, pValues) == TRUE)
+    {
+        return 0;
+    }
+    
+    switch(table)
+    {
+    case MB_TABLE_COILS:
+        ReadCoilStatus(slaveID, startAddress, count);
+        break;
+    case MB_TABLE_INPUTS:
+        ReadInputStatus(slaveID, startAddress, count);
+        break;
+    case MB_TABLE_HOLDING_REGISTERS:
+        ReadHoldingRegisters(slaveID, startAddress, count);
+        break;
+    default:
+        return NOT_CACHED_ERROR;
+    }
+    
+    result = MBMaster();
+    if(result != 0)
+    {
+        return result;
+    }
+    
+    //the response was checked but its values may still be missing in the cache
+    if(MBCacheRead(slaveID, table, startAddress, count, MB_CACHE_ANY_AGE, pValues) == FALSE)
+    {
+        return PACKET_SIZE_MISMATCH_ERROR;
+    }
+    return 0;
+}
+
+/*
+    Receive the response, it ends with MB_FRAME_GAP of silence
+    u32 responseTimeout - ms to wait for the first byte,
+    u32 *pResponseTime - ms from the call to the first byte
+    return bytes read or error code
+*/
+int GetMBAnswer(unsigned char *Buffer, u32 responseTimeout, u32 *pResponseTime)
 {
    int BytesRead = 0;
+   u32 start = GetTimerCounter();
+   unsigned char x;
    
    //USART_2 must be used   
-   BytesRead = InString(Buffer, USART_2, MB_MASTER_TIMER, T_100_MS);//??????????????????????does timing Ok?????????????????
-   
-   if(BytesRead == -1) // Error condition
+   SetVTimerValue(MB_MASTER_TIMER, responseTimeout);
+   while(IsVTimerElapsed(MB_MASTER_TIMER) == NOT_ELAPSED)
    {
-       return BUFFER_OVERRUN_ERROR; //Buffer Overload
+       //0xFF is data like any other byte, only RXNE tells that a byte came
+       if(recieveByteMyUSART(USART_2, &x) == FALSE)
+       {
+           continue;
+       }
+       
+       if(BytesRead == 0)
+       {
+           *pResponseTime = GetTimerCounter() - start;
+       }
+       if(BytesRead == RESPONSE_MAX_SIZE)
+       {
+           return BUFFER_OVERRUN_ERROR; //Buffer Overload
+       }
+       Buffer[BytesRead++] = x;
+       
+       SetVTimerValue(MB_MASTER_TIMER, MB_FRAME_GAP);
    }
+   
    if(BytesRead == 0) // No bytes read -> We have a serial port timeout
    {
        return DEVICE_TIMEOUT_ERROR;
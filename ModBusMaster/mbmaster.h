@@ -1,6 +1,9 @@
 #ifndef __MBMASTER_H
 #define __MBMASTER_H
 
+#include "mbcache.h"
+#include "mbdecode.h"
+
 #define QUERY_MAX_SIZE                  256
 #define RESPONSE_MAX_SIZE               256
 
@@ -13,21 +16,30 @@
 #define SPECIFIC_MODBUS_ERROR		-6
 #define SERIAL_PORT_ERROR		-7
 #define TRANSMIT_TIMEOUT_ERROR		-8
+#define NOT_CACHED_ERROR                -9                      /* range is outside of the master's cache */
+#define SLAVE_OFFLINE_ERROR             -10                     /* slave is offline and its probe period has not elapsed */
 
 #define PACKET_HEADER_AND_CRC	        5
 
+#define BROADCAST_SLAVE_ID              0                       /* write query for all slaves, they don't respond */
+#define BROADCAST_TURNAROUND_TIME       T_100_MS                /* slaves' processing time after broadcast query */
+
 void PresetMultipleRegisters(unsigned char slaveID, unsigned char startAddress, unsigned char registersCount, unsigned short *holdingRegistersValues);
 void ForceMultipleCoils(unsigned char slaveID, unsigned char coilAddress, unsigned char quantityOfCoils, unsigned short coilsData);
 void ForceSingleCoil(unsigned char slaveID, unsigned char coilAddress, unsigned char forceCommand);
 void ReadHoldingRegisters(unsigned char slaveID, unsigned char startingAddress, unsigned char holdingRegistersCount);
 void ReadInputStatus(unsigned char slaveID, unsigned char startingAddress, unsigned char inputsCount);
 void ReadCoilStatus(unsigned char slaveID, unsigned char startingAddress, unsigned char coilsCount);
-void MBMaster(void);
-int GetMBAnswer(unsigned char *Buffer);
+void InitMBMaster(void);
+int MBMaster(void);
+int GetMBAnswer(unsigned char *Buffer, u32 responseTimeout, u32 *pResponseTime);
 int MBParseBuffer(unsigned char *Buffer, unsigned char *CommandArray, int bytesRead);
+int MBGetResponseRegisters(tMBRegisterView *pView);
+int MBGetResponseBits(tMBBitView *pView);
+int MBMasterRead(unsigned char slaveID, eMBCacheTable table, unsigned char startAddress, unsigned char count, u32 maxAge, unsigned short *pValues);
 
 typedef struct MBCommandStructure{
-    unsigned char slaveID;                              /* slaveID takes a values between 1 - 10 */
+    unsigned char slaveID;                              /* slaveID takes a values between 1 - 10, BROADCAST_SLAVE_ID for writes to all slaves */
     
     unsigned char startAddressLO;                       /* startAddressLO is first address from which commands start. 
                                                         For Holding registers - 0 - 99
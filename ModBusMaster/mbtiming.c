@@ -0,0 +1,201 @@
+#include "stm32f4xx.h"
+#include "definitions.h"
+#include "VTimer.h"
+#include "mbtiming.h"
+
+
+static tMBSlaveTiming SlaveTimings[MB_TIMING_SLAVES_NUMBER];
+
+// return 0 for broadcast and unknown slaves, they keep the initial timeout and are never offline
+static tMBSlaveTiming *GetTiming(unsigned char slaveID)
+{
+    if(slaveID < 1 || slaveID > MB_TIMING_SLAVES_NUMBER)
+    {
+        return 0;
+    }
+    
+    return &SlaveTimings[slaveID - 1];
+}
+
+static u32 LimitTimeout(u32 timeout)
+{
+    if(timeout < MB_MIN_RESPONSE_TIMEOUT)
+    {
+        return MB_MIN_RESPONSE_TIMEOUT;
+    }
+    if(timeout > MB_MAX_RESPONSE_TIMEOUT)
+    {
+        return MB_MAX_RESPONSE_TIMEOUT;
+    }
+    return timeout;
+}
+
+// Timeout of the measured response times without the backoff of failures
+static u32 GetSmoothedTimeout(const tMBSlaveTiming *pTiming)
+{
+    if(pTiming->isMeasured == FALSE)
+    {
+        return MB_INITIAL_RESPONSE_TIMEOUT;
+    }
+    
+    return LimitTimeout((pTiming->srtt >> 3) + pTiming->rttvar);
+}
+
+void InitMBTiming(void)
+{
+    int i;
+    
+    for(i = 0; i < MB_TIMING_SLAVES_NUMBER; i++)
+    {
+        SlaveTimings[i].srtt = 0;
+        SlaveTimings[i].rttvar = 0;
+        SlaveTimings[i].timeout = MB_INITIAL_RESPONSE_TIMEOUT;
+        SlaveTimings[i].isMeasured = FALSE;
+        SlaveTimings[i].failures = 0;
+        SlaveTimings[i].isOffline = FALSE;
+        SlaveTimings[i].nextProbe = 0;
+        SlaveTimings[i].queries = 0;
+        SlaveTimings[i].retries = 0;
+        SlaveTimings[i].timeouts = 0;
+        SlaveTimings[i].offlineSkips = 0;
+    }
+}
+
+// Time to wait for the first byte of the response, ms
+u32 MBGetResponseTimeout(unsigned char slaveID)
+{
+    tMBSlaveTiming *pTiming = GetTiming(slaveID);
+    
+    return (pTiming != 0) ? pTiming->timeout : MB_INITIAL_RESPONSE_TIMEOUT;
+}
+
+BOOL MBIsSlaveOffline(unsigned char slaveID)
+{
+    tMBSlaveTiming *pTiming = GetTiming(slaveID);
+    
+    return (pTiming != 0) ? pTiming->isOffline : FALSE;
+}
+
+/*
+    Count the query and decide whether it goes to the bus
+    return FALSE for offline slave until its probe period elapses, the query is not sent then
+*/
+BOOL MBStartSlaveQuery(unsigned char slaveID)
+{
+    tMBSlaveTiming *pTiming = GetTiming(slaveID);
+    u32 now = GetTimerCounter();
+    
+    if(pTiming == 0)
+    {
+        return TRUE;
+    }
+    
+    if(pTiming->isOffline == TRUE)
+    {
+        // counter wraps after 49.7 days, the signed difference is right for the probe period
+        if((s32)(now - pTiming->nextProbe) < 0)
+        {
+            pTiming->offlineSkips++;
+            return FALSE;
+        }
+        pTiming->nextProbe = now + MB_OFFLINE_PROBE_PERIOD;
+    }
+    
+    // backoff is for the attempts of one query, a new query starts with the measured timeout
+    pTiming->timeout = GetSmoothedTimeout(pTiming);
+    pTiming->queries++;
+    return TRUE;
+}
+
+/*
+    The slave responded - a normal or an exception response
+    u32 responseTime - ms from the end of the query to the first byte of the response
+    BOOL isRetry - TRUE if the query was repeated, the time is not measured then
+*/
+void MBRecordResponse(unsigned char slaveID, u32 responseTime, BOOL isRetry)
+{
+    tMBSlaveTiming *pTiming = GetTiming(slaveID);
+    s32 delta;
+    
+    if(pTiming == 0)
+    {
+        return;
+    }
+    
+    pTiming->failures = 0;
+    pTiming->isOffline = FALSE;
+    
+    if(isRetry == TRUE)
+    {
+        return;
+    }
+    
+    if(pTiming->isMeasured == FALSE)
+    {
+        pTiming->srtt = responseTime << 3;              // SRTT = R
+        pTiming->rttvar = responseTime << 1;            // RTTVAR = R / 2
+        pTiming->isMeasured = TRUE;
+    }
+    else
+    {
+        // SRTT += (R - SRTT) / 8, RTTVAR += (|R - SRTT| - RTTVAR) / 4
+        delta = (s32)responseTime - (s32)(pTiming->srtt >> 3);
+        pTiming->srtt += delta;
+        if(delta < 0)
+        {
+            delta = -delta;
+        }
+        pTiming->rttvar += delta - (s32)(pTiming->rttvar >> 2);
+    }
+    
+    pTiming->timeout = GetSmoothedTimeout(pTiming);
+}
+
+/*
+    No response, bad CRC or response of another query - the timeout of the next attempt is doubled
+    BOOL willRetry - TRUE if the query is repeated
+*/
+void MBRecordAttemptFailure(unsigned char slaveID, BOOL willRetry)
+{
+    tMBSlaveTiming *pTiming = GetTiming(slaveID);
+    
+    if(pTiming == 0)
+    {
+        return;
+    }
+    
+    pTiming->timeouts++;
+    if(willRetry == TRUE)
+    {
+        pTiming->retries++;
+    }
+    pTiming->timeout = LimitTimeout(pTiming->timeout << 1);
+}
+
+// All attempts of the query failed, after MB_OFFLINE_FAILURES of them in a row the slave is offline
+void MBRecordQueryFailure(unsigned char slaveID)
+{
+    tMBSlaveTiming *pTiming = GetTiming(slaveID);
+    
+    if(pTiming == 0)
+    {
+        return;
+    }
+    
+    if(pTiming->failures < MB_OFFLINE_FAILURES)
+    {
+        pTiming->failures++;
+    }
+    
+    if(pTiming->failures == MB_OFFLINE_FAILURES && pTiming->isOffline == FALSE)
+    {
+        pTiming->isOffline = TRUE;
+        pTiming->nextProbe = GetTimerCounter() + MB_OFFLINE_PROBE_PERIOD;
+    }
+}
+
+// Timing and statistics of the slave, 0 for unknown slave
+const tMBSlaveTiming *MBGetSlaveTiming(unsigned char slaveID)
+{
+    return GetTiming(slaveID);
+}
@@ -0,0 +1,46 @@
+#ifndef __MBTIMING_H
+#define __MBTIMING_H
+
+#include "definitions.h"
+
+#define MB_TIMING_SLAVES_NUMBER                 10              /* slave IDs 1 - 10 */
+#define MB_INITIAL_RESPONSE_TIMEOUT             T_100_MS        /* until the first response is measured */
+#define MB_MIN_RESPONSE_TIMEOUT                 T_10_MS
+#define MB_MAX_RESPONSE_TIMEOUT                 T_1_S
+#define MB_FRAME_GAP                            5               /* ms of silence which ends the response */
+#define MB_MASTER_RETRIES                       2               /* repeated queries after the first one fails */
+#define MB_RETRY_BACKOFF                        T_10_MS         /* wait before the first retry, doubled for every next one */
+#define MB_OFFLINE_FAILURES                     3               /* failed queries in a row which take the slave offline */
+#define MB_OFFLINE_PROBE_PERIOD                 5000            /* ms, offline slave gets one query per period */
+
+/*
+    Response timing of one slave. Response time is from the end of the query to the first byte of the response,
+    it is smoothed like TCP round trip time (RFC 6298): the timeout is SRTT + 4 * RTTVAR and it is doubled
+    for every retry of the query. Times of retried queries are not measured, the response may belong to
+    the first attempt.
+*/
+typedef struct mbSlaveTiming{
+    u32 srtt;                                           /* smoothed response time, ms * 8 */
+    u32 rttvar;                                         /* response time variation, ms * 4 */
+    u32 timeout;                                        /* ms */
+    BOOL isMeasured;
+    unsigned char failures;                             /* failed queries in a row */
+    BOOL isOffline;
+    u32 nextProbe;                                      /* GetTimerCounter() of the next query of offline slave */
+    /* statistics */
+    unsigned long queries;
+    unsigned long retries;
+    unsigned long timeouts;                             /* failed attempts - no, bad or wrong response */
+    unsigned long offlineSkips;                         /* queries refused while the slave was offline */
+}tMBSlaveTiming;
+
+void InitMBTiming(void);
+u32 MBGetResponseTimeout(unsigned char slaveID);
+BOOL MBIsSlaveOffline(unsigned char slaveID);
+BOOL MBStartSlaveQuery(unsigned char slaveID);
+void MBRecordResponse(unsigned char slaveID, u32 responseTime, BOOL isRetry);
+void MBRecordAttemptFailure(unsigned char slaveID, BOOL willRetry);
+void MBRecordQueryFailure(unsigned char slaveID);
+const tMBSlaveTiming *MBGetSlaveTiming(unsigned char slaveID);
+
+#endif
@@ -0,0 +1,764 @@
+#include "stm32f4xx.h"
+#include "definitions.h"
+#include "mbslave.h"
+#include "mbbinding.h"
+
+
+extern ModBusSlaveUnit ModBusSlaves[MAX_MODBUS_SLAVE_DEVICES];
+
+static tMBSlaveBindings SlaveBindings[MAX_MODBUS_SLAVE_DEVICES];
+
+// Memory of the register blocks which are not bound, it is given out in order of definition and never released
+static unsigned short RegisterPool[REGISTER_POOL_SIZE];
+static int RegisterPoolUsed;
+
+// access checked by CheckRegisterRange()
+#define REGISTERS_READ                          0
+#define REGISTERS_WRITE                         1               // ModBus write, bound blocks must have write hook
+#define REGISTERS_UPDATE                        2               // write of the application, memory blocks only
+
+// tables read by ReadSlaveSnapshot()
+#define TABLE_COILS                             0
+#define TABLE_INPUTS                            1
+#define TABLE_HOLDING_REGISTERS                 2
+#define TABLE_INPUT_REGISTERS                   3
+
+/*
+    Remove all bindings and register blocks, every slave gets the default memory blocks -
+    holding registers 0 .. HOLDING_REGISTERS_NUMBER - 1 and input registers 0 .. INPUT_REGISTERS_NUMBER - 1
+*/
+void InitMBBindings(void)
+{
+    int i;
+    
+    RegisterPoolUsed = 0;
+    
+    for(i = 0; i < MAX_MODBUS_SLAVE_DEVICES; i++)
+    {
+        SlaveBindings[i].sequence = 0;
+        SlaveBindings[i].readCoils = 0;
+        SlaveBindings[i].writeCoils = 0;
+        SlaveBindings[i].readInputs = 0;
+        SlaveBindings[i].holdingRegisters.blocksNumber = 0;
+        SlaveBindings[i].inputRegisters.blocksNumber = 0;
+        
+        MBDefineHoldingRegisters(i, 0, HOLDING_REGISTERS_NUMBER);
+        MBDefineInputRegisters(i, 0, INPUT_REGISTERS_NUMBER);
+    }
+}
+
+/* Start change of slave's data, the sequence is odd until MBEndSlaveUpdate()
+  Producers which change data of the slave outside ModBus requests - memory blocks or data read by bound hooks -
+  put the change between MBBeginSlaveUpdate() and MBEndSlaveUpdate(), also in interrupts. ModBus reads which
+  overlap the change are repeated, so the response never mixes old and new values.
+*/
+void MBBeginSlaveUpdate(int slaveIndex)
+{
+    u32 primask = __get_PRIMASK();
+    
+    //producers of different interrupt priorities may nest, the increment must not be lost
+    __disable_irq();
+    SlaveBindings[slaveIndex].sequence++;
+    __set_PRIMASK(primask);
+    __DMB();
+}
+
+void MBEndSlaveUpdate(int slaveIndex)
+{
+    u32 primask = __get_PRIMASK();
+    
+    __DMB();
+    __disable_irq();
+    SlaveBindings[slaveIndex].sequence++;
+    __set_PRIMASK(primask);
+}
+
+// Counter which changes with every change of slave's data
+unsigned long MBGetSlaveVersion(int slaveIndex)
+{
+    return SlaveBindings[slaveIndex].sequence >> 1;
+}
+
+/* Bind coils of the slave, the slave has only MB_BOUND_BITS_NUMBER coils then
+  int slaveIndex - index in ModBusSlaves
+  tMBReadBits read - returns the coils' states
+  tMBWriteBits write - forces the coils
+*/
+void MBBindCoils(int slaveIndex, tMBReadBits read, tMBWriteBits write)
+{
+    SlaveBindings[slaveIndex].readCoils = read;
+    SlaveBindings[slaveIndex].writeCoils = write;
+}
+
+/* Bind discrete inputs of the slave, the slave has only MB_BOUND_BITS_NUMBER inputs then
+  int slaveIndex - index in ModBusSlaves
+  tMBReadBits read - returns the inputs' states
+*/
+void MBBindInputs(int slaveIndex, tMBReadBits read)
+{
+    SlaveBindings[slaveIndex].readInputs = read;
+}
+
+// Index of the block which contains the register, -1 if the register is not defined
+static int FindRegisterBlock(const tMBRegisterTable *pTable, unsigned short address)
+{
+    const tMBRegisterBlock *pBlock;
+    int low, high, middle;
+    
+    low = 0;
+    high = pTable->blocksNumber - 1;
+    
+    //binary search, blocks are sorted and do not overlap
+    while(low <= high)
+    {
+        middle = (low + high) / 2;
+        pBlock = &pTable->blocks[middle];
+        
+        if(address < pBlock->start)
+        {
+            high = middle - 1;
+        }
+        else if((unsigned long)address >= (unsigned long)pBlock->start + pBlock->count)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            return middle;
+        }
+    }
+    
+    return -1;
+}
+
+// Put the block on its place in the sorted table, there must be free space
+static void InsertRegisterBlock(tMBRegisterTable *pTable, const tMBRegisterBlock *pBlock)
+{
+    int i;
+    
+    for(i = pTable->blocksNumber; i > 0 && pTable->blocks[i - 1].start > pBlock->start; i--)
+    {
+        pTable->blocks[i] = pTable->blocks[i - 1];
+    }
+    
+    pTable->blocks[i] = *pBlock;
+    pTable->blocksNumber++;
+}
+
+static void RemoveRegisterBlock(tMBRegisterTable *pTable, int index)
+{
+    for(pTable->blocksNumber--; index < pTable->blocksNumber; index++)
+    {
+        pTable->blocks[index] = pTable->blocks[index + 1];
+    }
+}
+
+// Give the block memory from the register pool, the block must not overlap any other block
+static BOOL AddMemoryBlock(tMBRegisterTable *pTable, unsigned short start, unsigned short count)
+{
+    tMBRegisterBlock block;
+    unsigned long end;
+    int i;
+    
+    end = (unsigned long)start + count;
+    
+    if(count == 0 || end > 0x10000 || pTable->blocksNumber >= MAX_REGISTER_BLOCKS || RegisterPoolUsed + count > REGISTER_POOL_SIZE)
+    {
+        return FALSE;
+    }
+    
+    for(i = 0; i < pTable->blocksNumber; i++)
+    {
+        if(start < (unsigned long)pTable->blocks[i].start + pTable->blocks[i].count && pTable->blocks[i].start < end)
+        {
+            return FALSE;
+        }
+    }
+    
+    block.start = start;
+    block.count = count;
+    block.pMemory = &RegisterPool[RegisterPoolUsed];
+    block.read = 0;
+    block.write = 0;
+    
+    for(i = 0; i < count; i++)
+    {
+        block.pMemory[i] = 0;
+    }
+    RegisterPoolUsed += count;
+    
+    InsertRegisterBlock(pTable, &block);
+    
+    return TRUE;
+}
+
+/* Bind block of registers, memory blocks under it are cut, their registers outside the block stay
+  The function returns FALSE when the block overlaps other bound block or there is no free block.
+*/
+static BOOL AddBoundBlock(tMBRegisterTable *pTable, unsigned short start, unsigned short count, tMBReadRegisters read, tMBWriteRegisters write)
+{
+    tMBRegisterBlock block, piece;
+    unsigned long end, blockEnd;
+    int i, newBlocksNumber;
+    
+    end = (unsigned long)start + count;
+    
+    if(count == 0 || end > 0x10000 || read == 0)
+    {
+        return FALSE;
+    }
+    
+    //count blocks of the result before anything is changed
+    newBlocksNumber = pTable->blocksNumber + 1;
+    for(i = 0; i < pTable->blocksNumber; i++)
+    {
+        blockEnd = (unsigned long)pTable->blocks[i].start + pTable->blocks[i].count;
+        
+        if(start < blockEnd && pTable->blocks[i].start < end)
+        {
+            if(pTable->blocks[i].pMemory == 0)
+            {
+                return FALSE;
+            }
+            if(pTable->blocks[i].start >= start && blockEnd <= end)
+            {
+                newBlocksNumber--; //covered whole
+            }
+            else if(pTable->blocks[i].start < start && blockEnd > end)
+            {
+                newBlocksNumber++; //cut in two
+            }
+        }
+    }
+    if(newBlocksNumber > MAX_REGISTER_BLOCKS)
+    {
+        return FALSE;
+    }
+    
+    i = 0;
+    while(i < pTable->blocksNumber)
+    {
+        block = pTable->blocks[i];
+        blockEnd = (unsigned long)block.start + block.count;
+        
+        if(start >= blockEnd || block.start >= end)
+        {
+            i++;
+            continue;
+        }
+        
+        RemoveRegisterBlock(pTable, i);
+        
+        piece = block;
+        if(block.start < start)
+        {
+            piece.count = start - block.start;
+            InsertRegisterBlock(pTable, &piece); //it takes place i, the next block is checked after it
+            i++;
+        }
+        if(blockEnd > end)
+        {
+            piece.start = end;
+            piece.count = blockEnd - end;
+            piece.pMemory = block.pMemory + (end - block.start);
+            InsertRegisterBlock(pTable, &piece);
+        }
+    }
+    
+    block.start = start;
+    block.count = count;
+    block.pMemory = 0;
+    block.read = read;
+    block.write = write;
+    InsertRegisterBlock(pTable, &block);
+    
+    return TRUE;
+}
+
+/* Define block of holding registers kept in slave's memory, the registers are cleared
+  int slaveIndex - index in ModBusSlaves
+  unsigned short start, count - any range of 0 .. 65535 which does not overlap other blocks of the slave
+  
+  The function returns FALSE when the block overlaps, there is no free block or the register pool is used up.
+*/
+BOOL MBDefineHoldingRegisters(int slaveIndex, unsigned short start, unsigned short count)
+{
+    return AddMemoryBlock(&SlaveBindings[slaveIndex].holdingRegisters, start, count);
+}
+
+/* Define block of input registers kept in slave's memory, the registers are cleared
+  int slaveIndex - index in ModBusSlaves
+  unsigned short start, count - any range of 0 .. 65535 which does not overlap other blocks of the slave
+*/
+BOOL MBDefineInputRegisters(int slaveIndex, unsigned short start, unsigned short count)
+{
+    return AddMemoryBlock(&SlaveBindings[slaveIndex].inputRegisters, start, count);
+}
+
+/* Bind block of holding registers
+  int slaveIndex - index in ModBusSlaves
+  unsigned short start, count - registers of the block, they must not overlap other bound blocks of the slave
+  tMBReadRegisters read - returns the registers' values
+  tMBWriteRegisters write - takes new values, 0 for read only block
+  
+  The function returns FALSE when the block overlaps other bound block or there is no free block.
+*/
+BOOL MBBindHoldingRegisters(int slaveIndex, unsigned short start, unsigned short count, tMBReadRegisters read, tMBWriteRegisters write)
+{
+    return AddBoundBlock(&SlaveBindings[slaveIndex].holdingRegisters, start, count, read, write);
+}
+
+/* Bind block of input registers, they are read only
+  int slaveIndex - index in ModBusSlaves
+  unsigned short start, count - registers of the block, they must not overlap other bound blocks of the slave
+  tMBReadRegisters read - returns the registers' values
+*/
+BOOL MBBindInputRegisters(int slaveIndex, unsigned short start, unsigned short count, tMBReadRegisters read)
+{
+    return AddBoundBlock(&SlaveBindings[slaveIndex].inputRegisters, start, count, read, 0);
+}
+
+// Take 16 bits from any bit position of packed memory, the spare word keeps the 32-bit window in the memory
+static unsigned short GetBits(const unsigned short *pWords, unsigned long bit)
+{
+    const unsigned short *pWord = &pWords[bit >> 4];
+    
+    return (unsigned short)((((unsigned long)pWord[1] << 16) | pWord[0]) >> (bit & 0x0F));
+}
+
+// Change masked bits of 16 at any bit position of packed memory
+static void PutBits(unsigned short *pWords, unsigned long bit, unsigned short mask, unsigned short value)
+{
+    unsigned short *pWord = &pWords[bit >> 4];
+    unsigned long window, wideMask;
+    
+    window = ((unsigned long)pWord[1] << 16) | pWord[0];
+    wideMask = (unsigned long)mask << (bit & 0x0F);
+    window = (window & ~wideMask) | ((unsigned long)(value & mask) << (bit & 0x0F));
+    
+    pWord[0] = (unsigned short)window;
+    pWord[1] = (unsigned short)(window >> 16);
+}
+
+/* Copy bits from packed memory to ModBus bytes, 16 bits per step
+  unsigned char *pBytes - (count + 7) / 8 bytes, bit 0 of the first byte is the start bit
+*/
+static void ReadPackedBits(const unsigned short *pWords, unsigned short start, unsigned short count, unsigned char *pBytes)
+{
+    unsigned long bit, end;
+    unsigned short bits;
+    
+    end = (unsigned long)start + count;
+    
+    for(bit = start; bit < end; bit += 16)
+    {
+        bits = GetBits(pWords, bit);
+        if(end - bit < 16)
+        {
+            bits &= (unsigned short)((1 << (end - bit)) - 1);
+        }
+        
+        *pBytes++ = (unsigned char)bits;
+        if(end - bit > 8)
+        {
+            *pBytes++ = (unsigned char)(bits >> 8);
+        }
+    }
+}
+
+// Copy bits from ModBus bytes to packed memory, 16 bits per step
+static void WritePackedBits(unsigned short *pWords, unsigned short start, unsigned short count, const unsigned char *pBytes)
+{
+    unsigned long bit, end;
+    unsigned short mask, value;
+    
+    end = (unsigned long)start + count;
+    
+    for(bit = start; bit < end; bit += 16)
+    {
+        mask = 0xFFFF;
+        value = *pBytes++;
+        
+        if(end - bit < 16)
+        {
+            mask = (unsigned short)((1 << (end - bit)) - 1);
+        }
+        if(end - bit > 8)
+        {
+            value |= (unsigned short)(*pBytes++) << 8;
+        }
+        
+        PutBits(pWords, bit, mask, value);
+    }
+}
+
+/* Read bits of one table
+  tMBReadBits read - hook of bound table, 0 when the bits are in slave's memory
+  unsigned short *pMemory - packed bits of the slave
+  unsigned short bitsNumber - size of the table in slave's memory
+  
+  The function returns MB_EXCEPTION_ILLEGAL_DATA_ADDRESS when the range is out of the table.
+*/
+static unsigned char ReadBits(tMBReadBits read, const unsigned short *pMemory, unsigned short bitsNumber, 
+                              unsigned short start, unsigned short count, unsigned char *pBytes)
+{
+    unsigned short bound[2];
+    
+    if(read != 0)
+    {
+        if((unsigned long)start + count > MB_BOUND_BITS_NUMBER)
+        {
+            return MB_EXCEPTION_ILLEGAL_DATA_ADDRESS;
+        }
+        
+        bound[0] = read();
+        bound[1] = 0;
+        ReadPackedBits(bound, start, count, pBytes);
+        
+        return MB_EXCEPTION_NONE;
+    }
+    
+    if((unsigned long)start + count > bitsNumber)
+    {
+        return MB_EXCEPTION_ILLEGAL_DATA_ADDRESS;
+    }
+    
+    ReadPackedBits(pMemory, start, count, pBytes);
+    
+    return MB_EXCEPTION_NONE;
+}
+
+/* Force coils
+  unsigned short start, count - any range, it is checked here
+  const unsigned char *pBytes - new states packed as in ModBus request
+  
+  The function returns MB_EXCEPTION_ILLEGAL_DATA_ADDRESS and nothing is forced when the range is out of the coils.
+*/
+static unsigned char WriteCoils(int slaveIndex, unsigned short start, unsigned short count, const unsigned char *pBytes)
+{
+    unsigned short bound[2];
+    
+    if(SlaveBindings[slaveIndex].writeCoils != 0)
+    {
+        if((unsigned long)start + count > MB_BOUND_BITS_NUMBER)
+        {
+            return MB_EXCEPTION_ILLEGAL_DATA_ADDRESS;
+        }
+        
+        //all coils are forced at once
+        bound[0] = 0;
+        bound[1] = 0;
+        WritePackedBits(bound, start, count, pBytes);
+        SlaveBindings[slaveIndex].writeCoils((unsigned short)(((1UL << count) - 1) << start), bound[0]);
+        
+        return MB_EXCEPTION_NONE;
+    }
+    
+    if((unsigned long)start + count > OUTPUTS_NUMBER)
+    {
+        return MB_EXCEPTION_ILLEGAL_DATA_ADDRESS;
+    }
+    
+    WritePackedBits(ModBusSlaves[slaveIndex].outputs, start, count, pBytes);
+    
+    return MB_EXCEPTION_NONE;
+}
+
+static void CopyRegisters(const unsigned short *pSource, unsigned short *pDestination, unsigned long count)
+{
+    while(count--)
+    {
+        *pDestination++ = *pSource++;
+    }
+}
+
+/* Check that every register of the range is defined
+  unsigned char access - REGISTERS_READ, REGISTERS_WRITE - no read only block, REGISTERS_UPDATE - memory blocks only
+  
+  The function returns index of the block with the first register or -1.
+*/
+static int CheckRegisterRange(const tMBRegisterTable *pTable, unsigned short start, unsigned short count, unsigned char access)
+{
+    const tMBRegisterBlock *pBlock;
+    unsigned long address, end;
+    int first, i;
+    
+    first = FindRegisterBlock(pTable, start);
+    if(first < 0)
+    {
+        return -1;
+    }
+    
+    address = start;
+    end = (unsigned long)start + count;
+    
+    //the blocks after the first one must follow without gap
+    for(i = first; address < end; i++)
+    {
+        if(i > first && (i >= pTable->blocksNumber || pTable->blocks[i].start != address))
+        {
+            return -1;
+        }
+        
+        pBlock = &pTable->blocks[i];
+        if(pBlock->pMemory == 0 && (access == REGISTERS_UPDATE || (access == REGISTERS_WRITE && pBlock->write == 0)))
+        {
+            return -1;
+        }
+        
+        address = (unsigned long)pBlock->start + pBlock->count;
+    }
+    
+    return first;
+}
+
+/* Check holding registers before the request changes anything
+  BOOL isWrite - TRUE when the registers will be written
+  
+  The function returns TRUE when the whole range is defined (and writable).
+*/
+BOOL MBCheckHoldingRegisters(int slaveIndex, unsigned short start, unsigned short count, BOOL isWrite)
+{
+    return (CheckRegisterRange(&SlaveBindings[slaveIndex].holdingRegisters, start, count, (isWrite == TRUE) ? REGISTERS_WRITE : REGISTERS_READ) < 0) ? FALSE : TRUE;
+}
+
+/* Read registers of one table, every bound block in the range is read with one call of its hook
+  The function returns MB_EXCEPTION_ILLEGAL_DATA_ADDRESS when any register of the range is not defined.
+*/
+static unsigned char ReadRegisters(const tMBRegisterTable *pTable, unsigned short start, unsigned short count, unsigned short *pValues)
+{
+    const tMBRegisterBlock *pBlock;
+    unsigned long address, end, blockEnd;
+    int i;
+    
+    i = CheckRegisterRange(pTable, start, count, REGISTERS_READ);
+    if(i < 0)
+    {
+        return MB_EXCEPTION_ILLEGAL_DATA_ADDRESS;
+    }
+    
+    address = start;
+    end = (unsigned long)start + count;
+    
+    for(pBlock = &pTable->blocks[i]; address < end; pBlock++)
+    {
+        blockEnd = (unsigned long)pBlock->start + pBlock->count;
+        if(blockEnd > end)
+        {
+            blockEnd = end;
+        }
+        
+        if(pBlock->pMemory != 0)
+        {
+            CopyRegisters(&pBlock->pMemory[address - pBlock->start], pValues, blockEnd - address);
+        }
+        else
+        {
+            pBlock->read(address - pBlock->start, blockEnd - address, pValues);
+        }
+        
+        pValues += blockEnd - address;
+        address = blockEnd;
+    }
+    
+    return MB_EXCEPTION_NONE;
+}
+
+/* Write registers of one table, every bound block in the range is written with one call of its hook
+  unsigned char access - REGISTERS_WRITE or REGISTERS_UPDATE
+  
+  The function returns MB_EXCEPTION_ILLEGAL_DATA_ADDRESS and nothing is written when the range contains 
+  register which is not defined or block which the access can't write.
+  A hook which rejects its values stops the writing with MB_EXCEPTION_ILLEGAL_DATA_VALUE, the registers before it keep the new values.
+*/
+static unsigned char WriteRegisters(const tMBRegisterTable *pTable, unsigned short start, unsigned short count, const unsigned short *pValues, unsigned char access)
+{
+    const tMBRegisterBlock *pBlock;
+    unsigned long address, end, blockEnd;
+    int i;
+    
+    i = CheckRegisterRange(pTable, start, count, access);
+    if(i < 0)
+    {
+        return MB_EXCEPTION_ILLEGAL_DATA_ADDRESS;
+    }
+    
+    address = start;
+    end = (unsigned long)start + count;
+    
+    for(pBlock = &pTable->blocks[i]; address < end; pBlock++)
+    {
+        blockEnd = (unsigned long)pBlock->start + pBlock->count;
+        if(blockEnd > end)
+        {
+            blockEnd = end;
+        }
+        
+        if(pBlock->pMemory != 0)
+        {
+            CopyRegisters(pValues, &pBlock->pMemory[address - pBlock->start], blockEnd - address);
+        }
+        else if(pBlock->write(address - pBlock->start, blockEnd - address, pValues) == FALSE)
+        {
+            return MB_EXCEPTION_ILLEGAL_DATA_VALUE;
+        }
+        
+        pValues += blockEnd - address;
+        address = blockEnd;
+    }
+    
+    return MB_EXCEPTION_NONE;
+}
+
+// Read one table of the slave
+static unsigned char ReadSlaveTable(int slaveIndex, unsigned char table, unsigned short start, unsigned short count, void *pDestination)
+{
+    const tMBSlaveBindings *pBindings = &SlaveBindings[slaveIndex];
+    
+    switch(table)
+    {
+    case TABLE_COILS:
+        return ReadBits(pBindings->readCoils, ModBusSlaves[slaveIndex].outputs, OUTPUTS_NUMBER, start, count, (unsigned char *)pDestination);
+    case TABLE_INPUTS:
+        return ReadBits(pBindings->readInputs, ModBusSlaves[slaveIndex].inputs, INPUTS_NUMBER, start, count, (unsigned char *)pDestination);
+    case TABLE_HOLDING_REGISTERS:
+        return ReadRegisters(&pBindings->holdingRegisters, start, count, (unsigned short *)pDestination);
+    default:
+        return ReadRegisters(&pBindings->inputRegisters, start, count, (unsigned short *)pDestination);
+    }
+}
+
+/*
+    Read the table so that no update of the slave is inside the read - sequence lock without waiting for the producer.
+    When MB_SNAPSHOT_RETRIES attempts in a row are overlapped by updates, the last read runs with interrupts disabled;
+    it is one request long at most (MB_MAX_READ_REGISTERS registers or MB_MAX_READ_BITS bits).
+*/
+static unsigned char ReadSlaveSnapshot(int slaveIndex, unsigned char table, unsigned short start, unsigned short count, void *pDestination)
+{
+    volatile unsigned long *pSequence = &SlaveBindings[slaveIndex].sequence;
+    unsigned long sequence;
+    unsigned char exception;
+    u32 primask;
+    int attempt;
+    
+    for(attempt = 0; attempt < MB_SNAPSHOT_RETRIES; attempt++)
+    {
+        sequence = *pSequence;
+        __DMB();
+        exception = ReadSlaveTable(slaveIndex, table, start, count, pDestination);
+        __DMB();
+        
+        if((sequence & 0x01) == 0 && sequence == *pSequence)
+        {
+            return exception;
+        }
+    }
+    
+    primask = __get_PRIMASK();
+    __disable_irq();
+    exception = ReadSlaveTable(slaveIndex, table, start, count, pDestination);
+    __set_PRIMASK(primask);
+    
+    return exception;
+}
+
+/* Read coils, consistent with all updates of the slave
+  unsigned short start, count - any range, it is checked here
+  unsigned char *pBytes - coils packed as in ModBus response, (count + 7) / 8 bytes
+*/
+unsigned char MBReadCoils(int slaveIndex, unsigned short start, unsigned short count, unsigned char *pBytes)
+{
+    return ReadSlaveSnapshot(slaveIndex, TABLE_COILS, start, count, pBytes);
+}
+
+/* Read discrete inputs, consistent with all updates of the slave
+  unsigned short start, count - any range, it is checked here
+  unsigned char *pBytes - inputs packed as in ModBus response, (count + 7) / 8 bytes
+*/
+unsigned char MBReadInputs(int slaveIndex, unsigned short start, unsigned short count, unsigned char *pBytes)
+{
+    return ReadSlaveSnapshot(slaveIndex, TABLE_INPUTS, start, count, pBytes);
+}
+
+/* Read holding registers, consistent with all updates of the slave
+  unsigned short start, count - any range, it is checked here
+  unsigned short *pValues - count registers
+  
+  The function returns MB_EXCEPTION_ILLEGAL_DATA_ADDRESS when any register of the range is not defined.
+*/
+unsigned char MBReadHoldingRegisters(int slaveIndex, unsigned short start, unsigned short count, unsigned short *pValues)
+{
+    return ReadSlaveSnapshot(slaveIndex, TABLE_HOLDING_REGISTERS, start, count, pValues);
+}
+
+/* Read input registers, consistent with all updates of the slave
+  unsigned short start, count - any range, it is checked here
+  unsigned short *pValues - count registers
+*/
+unsigned char MBReadInputRegisters(int slaveIndex, unsigned short start, unsigned short count, unsigned short *pValues)
+{
+    return ReadSlaveSnapshot(slaveIndex, TABLE_INPUT_REGISTERS, start, count, pValues);
+}
+
+/* Force coils by ModBus request
+  unsigned short start, count - any range, it is checked here
+  const unsigned char *pBytes - new states packed as in ModBus request
+*/
+unsigned char MBWriteCoils(int slaveIndex, unsigned short start, unsigned short count, const unsigned char *pBytes)
+{
+    unsigned char exception;
+    
+    MBBeginSlaveUpdate(slaveIndex);
+    exception = WriteCoils(slaveIndex, start, count, pBytes);
+    MBEndSlaveUpdate(slaveIndex);
+    
+    return exception;
+}
+
+/* Write holding registers by ModBus request
+  unsigned short start, count - any range, it is checked here
+  const unsigned short *pValues - count registers
+  
+  The function returns MB_EXCEPTION_ILLEGAL_DATA_ADDRESS when any register is not defined or read only,
+  MB_EXCEPTION_ILLEGAL_DATA_VALUE when a write hook rejects its values.
+*/
+unsigned char MBWriteHoldingRegisters(int slaveIndex, unsigned short start, unsigned short count, const unsigned short *pValues)
+{
+    unsigned char exception;
+    
+    MBBeginSlaveUpdate(slaveIndex);
+    exception = WriteRegisters(&SlaveBindings[slaveIndex].holdingRegisters, start, count, pValues, REGISTERS_WRITE);
+    MBEndSlaveUpdate(slaveIndex);
+    
+    return exception;
+}
+
+/* Update holding registers of slave's memory blocks from the application, also from interrupts
+  unsigned short start, count - registers of memory blocks, bound blocks are changed by their owners
+  const unsigned short *pValues - count registers
+  
+  The whole range is changed at once for ModBus reads. The function returns MB_EXCEPTION_ILLEGAL_DATA_ADDRESS 
+  and nothing is written when any register is not in memory block.
+*/
+unsigned char MBSetHoldingRegisters(int slaveIndex, unsigned short start, unsigned short count, const unsigned short *pValues)
+{
+    unsigned char exception;
+    
+    MBBeginSlaveUpdate(slaveIndex);
+    exception = WriteRegisters(&SlaveBindings[slaveIndex].holdingRegisters, start, count, pValues, REGISTERS_UPDATE);
+    MBEndSlaveUpdate(slaveIndex);
+    
+    return exception;
+}
+
+// Update input registers of slave's memory blocks from the application, as MBSetHoldingRegisters()
+unsigned char MBSetInputRegisters(int slaveIndex, unsigned short start, unsigned short count, const unsigned short *pValues)
+{
+    unsigned char exception;
+    
+    MBBeginSlaveUpdate(slaveIndex);
+    exception = WriteRegisters(&SlaveBindings[slaveIndex].inputRegisters, start, count, pValues, REGISTERS_UPDATE);
+    MBEndSlaveUpdate(slaveIndex);
+    
+    return exception;
+}
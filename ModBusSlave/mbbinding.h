@@ -0,0 +1,74 @@
+#ifndef _MBBINDING_H
+#define _MBBINDING_H
+
+#include "definitions.h"
+
+#define MAX_REGISTER_BLOCKS                                     8               // memory and bound blocks of one register table of one slave
+#define MB_BOUND_BITS_NUMBER                                    16              // coils or inputs of slave bound to mask hooks
+#define MB_SNAPSHOT_RETRIES                                     3               // reads overlapped by updates before the read runs with interrupts disabled
+#define REGISTER_POOL_SPARE                                     512             // registers for blocks defined by the application
+#define REGISTER_POOL_SIZE                                      (MAX_MODBUS_SLAVE_DEVICES * (HOLDING_REGISTERS_NUMBER + INPUT_REGISTERS_NUMBER) + REGISTER_POOL_SPARE)
+
+/*
+    Hooks of bound ModBus data. Read hooks are called while the request is served, so the response 
+    carries the value of that moment; write hooks pass the new values straight to the owner.
+    
+    Bits are 16-bit masks, bit 0 is address 0, so bound coils or inputs are addresses 0 .. MB_BOUND_BITS_NUMBER - 1.
+    Register hooks get offset from the start of the bound block and count of registers in the block.
+*/
+typedef unsigned short (*tMBReadBits)(void);
+typedef void (*tMBWriteBits)(unsigned short mask, unsigned short value);
+typedef void (*tMBReadRegisters)(unsigned short offset, unsigned short count, unsigned short *pValues);
+typedef BOOL (*tMBWriteRegisters)(unsigned short offset, unsigned short count, const unsigned short *pValues);
+
+/*
+    Registers of one block are either kept in the register pool (pMemory) or bound to hooks of their owner.
+    Bound block replaces the memory under it, the memory blocks are cut around it.
+*/
+typedef struct mbRegisterBlock{
+    unsigned short start;               // first register of the block
+    unsigned short count;
+    unsigned short *pMemory;            // 0 for bound block
+    tMBReadRegisters read;
+    tMBWriteRegisters write;            // 0 for read only bound block
+}tMBRegisterBlock;
+
+// Sparse register table in the full 16-bit address space - blocks are sorted by start and never overlap
+typedef struct mbRegisterTable{
+    tMBRegisterBlock blocks[MAX_REGISTER_BLOCKS];
+    int blocksNumber;
+}tMBRegisterTable;
+
+// Data of one slave, coils and inputs which are not bound stay in ModBusSlaveUnit memory
+typedef struct mbSlaveBindings{
+    volatile unsigned long sequence;    // odd while the data is changed, see MBBeginSlaveUpdate()
+    tMBReadBits readCoils;
+    tMBWriteBits writeCoils;
+    tMBReadBits readInputs;
+    tMBRegisterTable holdingRegisters;
+    tMBRegisterTable inputRegisters;
+}tMBSlaveBindings;
+
+void InitMBBindings(void);
+void MBBeginSlaveUpdate(int slaveIndex);
+void MBEndSlaveUpdate(int slaveIndex);
+unsigned long MBGetSlaveVersion(int slaveIndex);
+unsigned char MBSetHoldingRegisters(int slaveIndex, unsigned short start, unsigned short count, const unsigned short *pValues);
+unsigned char MBSetInputRegisters(int slaveIndex, unsigned short start, unsigned short count, const unsigned short *pValues);
+void MBBindCoils(int slaveIndex, tMBReadBits read, tMBWriteBits write);
+void MBBindInputs(int slaveIndex, tMBReadBits read);
+BOOL MBDefineHoldingRegisters(int slaveIndex, unsigned short start, unsigned short count);
+BOOL MBDefineInputRegisters(int slaveIndex, unsigned short start, unsigned short count);
+BOOL MBBindHoldingRegisters(int slaveIndex, unsigned short start, unsigned short count, tMBReadRegisters read, tMBWriteRegisters write);
+BOOL MBBindInputRegisters(int slaveIndex, unsigned short start, unsigned short count, tMBReadRegisters read);
+
+// access used by the slave's command handlers
+unsigned char MBReadCoils(int slaveIndex, unsigned short start, unsigned short count, unsigned char *pBytes);
+unsigned char MBWriteCoils(int slaveIndex, unsigned short start, unsigned short count, const unsigned char *pBytes);
+unsigned char MBReadInputs(int slaveIndex, unsigned short start, unsigned short count, unsigned char *pBytes);
+BOOL MBCheckHoldingRegisters(int slaveIndex, unsigned short start, unsigned short count, BOOL isWrite);
+unsigned char MBReadHoldingRegisters(int slaveIndex, unsigned short start, unsigned short count, unsigned short *pValues);
+unsigned char MBWriteHoldingRegisters(int slaveIndex, unsigned short start, unsigned short count, const unsigned short *pValues);
+unsigned char MBReadInputRegisters(int slaveIndex, unsigned short start, unsigned short count, unsigned short *pValues);
+
+#endif
@@ -0,0 +1,237 @@
+#include "stm32f4xx.h"
+#include "definitions.h"
+#include "mbslave.h"
+#include "mbbinding.h"
+#include "mbdiagnostics.h"
+#include "delay.h"
+
+
+// statistics of FC which are not in the table
+#define OTHER_FUNCTIONS_INDEX                   (MB_STATISTICS_FUNCTIONS_NUMBER - 1)
+
+static const unsigned char StatisticsFunctions[MB_STATISTICS_FUNCTIONS_NUMBER - 1] = {1, 2, 3, 4, 5, 6, 8, 15, 16, 23};
+
+static unsigned char GetFunctionIndex(unsigned char function)
+{
+    int i;
+    
+    for(i = 0; i < OTHER_FUNCTIONS_INDEX; i++)
+    {
+        if(StatisticsFunctions[i] == function)
+        {
+            return (unsigned char)i;
+        }
+    }
+    
+    return OTHER_FUNCTIONS_INDEX;
+}
+
+/*
+    Bucket of the latency histogram: bucket 0 is < MB_LATENCY_FIRST_BUCKET_US, every next one is twice wider
+    and the last one takes all longer times
+*/
+static int GetLatencyBucket(u32 cycles)
+{
+    u32 units;
+    int bucket;
+    
+    units = CyclesToMicroseconds(cycles) / MB_LATENCY_FIRST_BUCKET_US;
+    
+    bucket = 0;
+    while(units != 0 && bucket < MB_LATENCY_BUCKETS - 1)
+    {
+        units >>= 1;
+        bucket++;
+    }
+    
+    return bucket;
+}
+
+/*
+    Count executed request of the port, called before the response is composed
+    unsigned char function - FC of the request
+    BOOL isException - TRUE if exception response is sent
+*/
+void MBCountRequest(tMBSlavePort *pPort, unsigned char function, BOOL isException)
+{
+    tMBFunctionStatistics *pFunction;
+    
+    pPort->functionIndex = GetFunctionIndex(function);
+    pFunction = &pPort->statistics.functions[pPort->functionIndex];
+    
+    pFunction->requests++;
+    if(isException == TRUE)
+    {
+        pFunction->exceptions++;
+        pPort->statistics.exceptionsSent++;
+    }
+}
+
+/*
+    Count latencies of the response, called when the response is transmitted
+    u32 turnaroundCycles - end of request frame - start of transmission
+    u32 transmissionCycles - duration of transmission
+*/
+void MBCountResponse(tMBSlavePort *pPort, u32 turnaroundCycles, u32 transmissionCycles)
+{
+    tMBFunctionStatistics *pFunction = &pPort->statistics.functions[pPort->functionIndex];
+    
+    pFunction->turnaround[GetLatencyBucket(turnaroundCycles)]++;
+    pFunction->transmission[GetLatencyBucket(transmissionCycles)]++;
+}
+
+//Diagnostics, only the counters of the port which received the request are returned or cleared
+int process_cmd8(tMBSlavePort *pPort)
+{
+    const unsigned char *pRequest = pPort->recieveBuffer;
+    unsigned char *pResponse = pPort->responseBuffer;
+    tMBSlaveStatistics *pStatistics = &pPort->statistics;
+    unsigned short subFunction, data;
+    unsigned long counter;
+    int length, i;
+    
+    subFunction = ((unsigned short)pRequest[2] << 8) | pRequest[3];
+    
+    //echo of the whole request without CRC, MBCheckRequest() accepts data field of any length
+    if(subFunction == MB_DIAG_RETURN_QUERY_DATA)
+    {
+        length = pPort->requestLength - 2;
+        for(i = 0; i < length; i++)
+        {
+            pResponse[i] = pRequest[i];
+        }
+        return length;
+    }
+    
+    data = ((unsigned short)pRequest[4] << 8) | pRequest[5];
+    
+    switch(subFunction)
+    {
+    case MB_DIAG_RESTART_COMMUNICATIONS:
+        if(data != 0x0000 && data != 0xFF00)
+        {
+            return MB_EXCEPTION_RESPONSE(MB_EXCEPTION_ILLEGAL_DATA_VALUE);
+        }
+        ClearModBusSlaveMemory((unsigned char *)pStatistics, sizeof(*pStatistics));
+        counter = data;
+        break;
+    case MB_DIAG_CLEAR_COUNTERS:
+        if(data != 0)
+        {
+            return MB_EXCEPTION_RESPONSE(MB_EXCEPTION_ILLEGAL_DATA_VALUE);
+        }
+        ClearModBusSlaveMemory((unsigned char *)pStatistics, sizeof(*pStatistics));
+        counter = 0;
+        break;
+    case MB_DIAG_BUS_MESSAGE_COUNT:
+        counter = pStatistics->framesReceived;
+        break;
+    case MB_DIAG_BUS_ERROR_COUNT:
+        counter = pStatistics->crcErrors;
+        break;
+    case MB_DIAG_EXCEPTION_ERROR_COUNT:
+        counter = pStatistics->exceptionsSent;
+        break;
+    case MB_DIAG_SLAVE_MESSAGE_COUNT:
+        counter = pStatistics->slaveMessages;
+        break;
+    case MB_DIAG_NO_RESPONSE_COUNT:
+        counter = pStatistics->broadcastsReceived;
+        break;
+    case MB_DIAG_CHARACTER_OVERRUN_COUNT:
+        counter = pStatistics->overruns;
+        break;
+    default:
+        return MB_EXCEPTION_RESPONSE(MB_EXCEPTION_ILLEGAL_FUNCTION);
+    }
+    
+    if(subFunction >= MB_DIAG_BUS_MESSAGE_COUNT && data != 0)
+    {
+        return MB_EXCEPTION_RESPONSE(MB_EXCEPTION_ILLEGAL_DATA_VALUE);
+    }
+    
+    //compose response - sub-function and the data, counters are 16-bit on the bus
+    pResponse[0] = pRequest[0];
+    pResponse[1] = pRequest[1];
+    pResponse[2] = pRequest[2];
+    pResponse[3] = pRequest[3];
+    pResponse[4] = (unsigned char)(counter >> 8);
+    pResponse[5] = (unsigned char)counter;
+    
+    return 6;
+}
+
+// ..................Statistics registers..........................
+
+static unsigned short SaturateCounter(unsigned long counter)
+{
+    return (counter > 0xFFFF) ? 0xFFFF : (unsigned short)counter;
+}
+
+static unsigned short GetCounterRegister(unsigned long counter, unsigned short offset)
+{
+    return (offset & 1) ? (unsigned short)counter : (unsigned short)(counter >> 16);
+}
+
+// Register of the port's block, offset as described in mbdiagnostics.h
+static unsigned short GetStatisticsRegister(const tMBSlaveStatistics *pStatistics, unsigned short offset)
+{
+    const tMBFunctionStatistics *pFunction;
+    unsigned long counters[MB_STATISTICS_COUNTERS_NUMBER];
+    
+    if(offset < 2 * MB_STATISTICS_COUNTERS_NUMBER)
+    {
+        counters[0] = pStatistics->framesReceived;
+        counters[1] = pStatistics->crcErrors;
+        counters[2] = pStatistics->overruns;
+        counters[3] = pStatistics->slaveMessages;
+        counters[4] = pStatistics->responsesSent;
+        counters[5] = pStatistics->exceptionsSent;
+        counters[6] = pStatistics->broadcastsReceived;
+    
+        return GetCounterRegister(counters[offset / 2], offset);
+    }
+    
+    offset -= 2 * MB_STATISTICS_COUNTERS_NUMBER;
+    pFunction = &pStatistics->functions[offset / MB_STATISTICS_FUNCTION_REGISTERS];
+    offset %= MB_STATISTICS_FUNCTION_REGISTERS;
+    
+    if(offset < 2)
+    {
+        return GetCounterRegister(pFunction->requests, offset);
+    }
+    if(offset < 4)
+    {
+        return GetCounterRegister(pFunction->exceptions, offset);
+    }
+    
+    offset -= 4;
+    if(offset < MB_LATENCY_BUCKETS)
+    {
+        return SaturateCounter(pFunction->turnaround[offset]);
+    }
+    
+    return SaturateCounter(pFunction->transmission[offset - MB_LATENCY_BUCKETS]);
+}
+
+// Read hook of the statistics block, ports which are not initialized read as 0
+static void ReadStatisticsRegisters(unsigned short offset, unsigned short count, unsigned short *pValues)
+{
+    const tMBSlaveStatistics *pStatistics;
+    unsigned short i;
+    
+    for(i = 0; i < count; i++, offset++)
+    {
+        pStatistics = MBGetPortStatistics(offset / MB_STATISTICS_PORT_REGISTERS);
+        pValues[i] = (pStatistics != 0) ? GetStatisticsRegister(pStatistics, offset % MB_STATISTICS_PORT_REGISTERS) : 0;
+    }
+}
+
+/*
+    Bind statistics of all ports as read only input registers of the slave
+    unsigned short start - first register, the block is MB_STATISTICS_REGISTERS_NUMBER registers
+*/
+BOOL MBBindStatisticsRegisters(int slaveIndex, unsigned short start)
+{
+    return MBBindInputRegisters(slaveIndex, start, MB_STATISTICS_REGISTERS_NUMBER, ReadStatisticsRegisters);
+}
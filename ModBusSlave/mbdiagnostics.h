@@ -0,0 +1,37 @@
+#ifndef _MBDIAGNOSTICS_H
+#define _MBDIAGNOSTICS_H
+
+#include "mbslave.h"
+
+// FC 8 sub-functions
+#define MB_DIAG_RETURN_QUERY_DATA                               0x00
+#define MB_DIAG_RESTART_COMMUNICATIONS                          0x01
+#define MB_DIAG_CLEAR_COUNTERS                                  0x0A
+#define MB_DIAG_BUS_MESSAGE_COUNT                               0x0B            // framesReceived
+#define MB_DIAG_BUS_ERROR_COUNT                                 0x0C            // crcErrors
+#define MB_DIAG_EXCEPTION_ERROR_COUNT                           0x0D            // exceptionsSent
+#define MB_DIAG_SLAVE_MESSAGE_COUNT                             0x0E            // slaveMessages
+#define MB_DIAG_NO_RESPONSE_COUNT                               0x0F            // broadcastsReceived
+#define MB_DIAG_CHARACTER_OVERRUN_COUNT                         0x12            // overruns
+
+/*
+    Statistics register block, read only. Ports follow each other, every port is
+        0 .. 13 - framesReceived, crcErrors, overruns, slaveMessages, responsesSent, exceptionsSent, broadcastsReceived,
+                  32-bit, high word first
+        14 ..   - MB_STATISTICS_FUNCTIONS_NUMBER blocks of tMBFunctionStatistics: requests and exceptions 32-bit,
+                  high word first, then turnaround and transmission buckets saturated to 16-bit
+    Functions are FC 1, 2, 3, 4, 5, 6, 8, 15, 16, 23 and the last block counts all other codes.
+*/
+#define MB_STATISTICS_COUNTERS_NUMBER                           7
+#define MB_STATISTICS_FUNCTION_REGISTERS                        (2 * 2 + 2 * MB_LATENCY_BUCKETS)
+#define MB_STATISTICS_PORT_REGISTERS                            (2 * MB_STATISTICS_COUNTERS_NUMBER + MB_STATISTICS_FUNCTIONS_NUMBER * MB_STATISTICS_FUNCTION_REGISTERS)
+#define MB_STATISTICS_REGISTERS_NUMBER                          (MB_PORTS_NUMBER * MB_STATISTICS_PORT_REGISTERS)
+
+// recording by the slave engine
+void MBCountRequest(tMBSlavePort *pPort, unsigned char function, BOOL isException);
+void MBCountResponse(tMBSlavePort *pPort, u32 turnaroundCycles, u32 transmissionCycles);
+
+int process_cmd8(tMBSlavePort *pPort);
+BOOL MBBindStatisticsRegisters(int slaveIndex, unsigned short start);
+
+#endif
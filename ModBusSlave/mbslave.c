@@ -2,46 +2,22 @@
 #include "definitions.h"
 #include "mbcrc.h"
 #include "mbslave.h"
+#include "mbbinding.h"
+#include "mbdiagnostics.h"
 #include "serial.h"
 #include "mytim.h"
+#include "scheduler.h"
+#include "delay.h"
 #include "usart.h"
 
 
-static volatile unsigned short MBRcvBufferPos;
-static volatile unsigned short MBSndBufferPos;
-static int ActiveSlaveIndex = INVALID_SLAVE_INDEX;
-
-
 extern ModBusSlaveUnit ModBusSlaves[MAX_MODBUS_SLAVE_DEVICES];
 
 
 ModBusSlaveUnit ModBusSlaves[MAX_MODBUS_SLAVE_DEVICES];
-unsigned char RecieveBuffer[PACKET_SIZE];
-unsigned char ResponseBuffer[RESPONSE_SIZE];
-
-typedef enum
-{
-    EV_FRAME_RECEIVED,          /*!< Frame received. */
-    EV_EXECUTE,                 /*!< Execute function. */
-} eMBEventType;
-
-typedef enum
-{
-    STATE_RX_IDLE,              /*!< Receiver is in idle state. */
-    STATE_RX_RCV,               /*!< Frame is beeing received. */
-} eMBRcvState;
-
-typedef enum
-{
-    STATE_TX_IDLE,              /*!< Transmitter is in idle state. */
-    STATE_TX_XMIT               /*!< Transmitter is in transfer state. */
-} eMBSndState;
-
-volatile eMBEventType MBQueuedEvent;
-volatile BOOL    MBEventInQueue;
 
-static volatile eMBSndState MBSndState;
-static volatile eMBRcvState MBRcvState;
+static tMBSlavePort ModBusPort;                         // USART_2
+static tMBSlavePort *SlavePorts[MB_PORTS_NUMBER];       // all ports of the engine, for the statistics
 
 // ..................UART_RX..........................
 
@@ -56,12 +32,11 @@ void InitNewMBSlaveDevices(void)
     {
         ModBusSlaves[i].address = i + 1;
         ModBusSlaves[i].isSlaveActive = FALSE;
-        ClearModBusSlaveMemory(ModBusSlaves[i].inputs, INPUTS_NUMBER);
-        ClearModBusSlaveMemory(ModBusSlaves[i].outputs, OUTPUTS_NUMBER);
-        ClearModBusSlaveMemory((unsigned char *)ModBusSlaves[i].holdingRegisters, HOLDING_REGISTERS_NUMBER * sizeof(unsigned short));
-        ClearModBusSlaveMemory(ModBusSlaves[i].recieveBuffer, PACKET_SIZE);
-        ClearModBusSlaveMemory(ModBusSlaves[i].responseBuffer, RESPONSE_SIZE);
+        ClearModBusSlaveMemory((unsigned char *)ModBusSlaves[i].inputs, sizeof(ModBusSlaves[i].inputs));
+        ClearModBusSlaveMemory((unsigned char *)ModBusSlaves[i].outputs, sizeof(ModBusSlaves[i].outputs));
     }
+    
+    InitMBBindings();
 }
 
 /*
@@ -102,24 +77,32 @@ void CopyModBusMemory(unsigned char *source, unsigned char *destination, unsigne
 }
 
 /*
-    This function recognizes for which of all slaves is addressed the current message and sets global int ActiveSlaveAddress with found slave.
-    If it's not found slave ActiveSlaveAddress = INVALID_SLAVE_ADDRESS
+    This function recognizes for which of all slaves is addressed the current message and sets activeSlaveIndex of the port with found slave.
+    If it's not found slave activeSlaveIndex is not changed
     The function returns TRUE - recieve address is valid, FALSE - recive address is not valid
+    tMBSlavePort *pPort - port which received the message
     unsigned char recieveAddress - first byte from input message
 */
-BOOL MBSlaveAddressRecognition(unsigned char recieveAddress)
+BOOL MBSlaveAddressRecognition(tMBSlavePort *pPort, unsigned char recieveAddress)
 {
     int i;
     
     BOOL isRecieveAddressValid = FALSE;
     
+    if(recieveAddress == MB_BROADCAST_ADDRESS)
+    {
+        // request for all slaves, it is executed for each of them
+        pPort->activeSlaveIndex = 0;
+        return TRUE;
+    }
+    
     for(i = 0; i < MAX_MODBUS_SLAVE_DEVICES; i++)
     {
         if(ModBusSlaves[i].address == recieveAddress)
         {
             ModBusSlaves[i].isSlaveActive = TRUE;
             isRecieveAddressValid = TRUE;
-            ActiveSlaveIndex = i;
+            pPort->activeSlaveIndex = i;
             break;
         }
     }
@@ -127,449 +110,762 @@ BOOL MBSlaveAddressRecognition(unsigned char recieveAddress)
     return isRecieveAddressValid;
 }
 
-void MBInitHardwareAndProtocol(void)
-{    
-    MBRcvState = STATE_RX_IDLE;
-    MBSndState = STATE_TX_IDLE;  
+// Returns TRUE for the functions which can be sent to MB_BROADCAST_ADDRESS - writes only
+BOOL MBIsBroadcastFunction(unsigned char function)
+{
+    return (function == 5 || function == 6 || function == 15 || function == 16);
+}
+
+/*
+    Check function code and length of a request before it is parsed
+    const unsigned char *pRequest - frame with address and CRC
+    unsigned short requestLength - length of the frame with CRC
     
-    InitNewMBSlaveDevices();
+    The function returns MB_EXCEPTION_NONE, MB_EXCEPTION_ILLEGAL_FUNCTION for unsupported function or
+    MB_EXCEPTION_ILLEGAL_DATA_VALUE when the frame is shorter or longer than the function needs.
+*/
+unsigned char MBCheckRequest(const unsigned char *pRequest, unsigned short requestLength)
+{
+    unsigned short expectedLength;
     
-    InitUSART2(MB_SLAVE_UNIT);
-    InitTIM3();
-}	
+    switch(pRequest[1])
+    {
+    case 1:
+    case 2:
+    case 3:
+    case 4:
+    case 5:
+    case 6:
+        expectedLength = 8;                             // address, function, 2 x 2 bytes, CRC
+        break;
+    case 8:
+        if(requestLength < 6)
+        {
+            return MB_EXCEPTION_ILLEGAL_DATA_VALUE;
+        }
+        //Return Query Data echoes a data field of any length, the other sub-functions have one data word
+        if(pRequest[2] == 0 && pRequest[3] == MB_DIAG_RETURN_QUERY_DATA)
+        {
+            return MB_EXCEPTION_NONE;
+        }
+        expectedLength = 8;                             // address, function, sub-function, data, CRC
+        break;
+    case 15:
+    case 16:
+        if(requestLength < 9)
+        {
+            return MB_EXCEPTION_ILLEGAL_DATA_VALUE;
+        }
+        expectedLength = 9 + pRequest[6];               // address, function, 2 x 2 bytes, byte count, data, CRC
+        break;
+    case 23:
+        if(requestLength < 13)
+        {
+            return MB_EXCEPTION_ILLEGAL_DATA_VALUE;
+        }
+        expectedLength = 13 + pRequest[10];             // address, function, 4 x 2 bytes, byte count, data, CRC
+        break;
+    default:
+        return MB_EXCEPTION_ILLEGAL_FUNCTION;
+    }
+    
+    if(requestLength != expectedLength)
+    {
+        return MB_EXCEPTION_ILLEGAL_DATA_VALUE;
+    }
+    
+    return MB_EXCEPTION_NONE;
+}
 
-void MBPollSlave( void )
+/*
+    Compose exception response: address, function code with MB_EXCEPTION_FUNCTION_FLAG, exception code.
+    The function returns length of the response without CRC.
+*/
+int MBComposeException(unsigned char *pResponse, const unsigned char *pRequest, unsigned char exception)
+{
+    pResponse[0] = pRequest[0];
+    pResponse[1] = pRequest[1] | MB_EXCEPTION_FUNCTION_FLAG;
+    pResponse[2] = exception;
+    
+    return 3;
+}
+
+/*
+    Set the port to idle state, the hardware is initialized by the caller
+    int portIndex - MB_MODBUS_PORT, MB_RS232_PORT
+    int usartID - USART_2, USART_3
+    int timerID - virtual timer of the transmission
+    int event - scheduler event of the port, EVENT_MODBUS, EVENT_RS232
+    tMBTimerEnable timerEnable, tMBTimerDisable timerDisable - end of frame timer of the port
+*/
+void MBInitPort(tMBSlavePort *pPort, int portIndex, int usartID, int timerID, int event, tMBTimerEnable timerEnable, tMBTimerDisable timerDisable)
+{
+    SlavePorts[portIndex] = pPort;
+    
+    pPort->usartID = usartID;
+    pPort->timerID = timerID;
+    pPort->event = event;
+    pPort->timerEnable = timerEnable;
+    pPort->timerDisable = timerDisable;
+    
+    pPort->rcvBufferPos = 0;
+    pPort->sndBufferPos = 0;
+    pPort->requestLength = 0;
+    pPort->activeSlaveIndex = INVALID_SLAVE_INDEX;
+    pPort->eventInQueue = FALSE;
+    pPort->rcvState = STATE_RX_IDLE;
+    pPort->sndState = STATE_TX_IDLE;
+    pPort->frameEndCycles = 0;
+    pPort->functionIndex = 0;
+    
+    ClearModBusSlaveMemory((unsigned char *)&pPort->statistics, sizeof(pPort->statistics));
+    ClearModBusSlaveMemory(pPort->recieveBuffer, PACKET_SIZE);
+    ClearModBusSlaveMemory(pPort->responseBuffer, RESPONSE_SIZE);
+}
+
+void MBPollPort(tMBSlavePort *pPort)
 {
-    static unsigned char RcvAddress;
     unsigned int crc;
     BOOL isRcvAddressValid;
     
     eMBEventType eEvent;
     
-    if( MBEventInQueue )
+    if( pPort->eventInQueue )
     {
-        eEvent = MBQueuedEvent;
-        MBEventInQueue = FALSE;
-        
+        eEvent = pPort->queuedEvent;
+        pPort->eventInQueue = FALSE;
+    
         switch ( eEvent )
         {
         case EV_FRAME_RECEIVED:
-            { 
-                RcvAddress = RecieveBuffer[0];
-                isRcvAddressValid = MBSlaveAddressRecognition(RcvAddress);
-                
+            {
+                pPort->statistics.framesReceived++;
+    
+                // too short frames can't be requests, even if CRC matches
+                if(pPort->rcvBufferPos < MB_MIN_FRAME_SIZE)
+                {
+                    break;
+                }
+    
+                isRcvAddressValid = MBSlaveAddressRecognition(pPort, pPort->recieveBuffer[0]);
+    
                 if(isRcvAddressValid == TRUE)
-                {	
-                    //copy global recieveBuffer in active slave's recieveBuffer for regular slave simulation
-                    CopyModBusMemory(RecieveBuffer, ModBusSlaves[ActiveSlaveIndex].recieveBuffer, MBRcvBufferPos);
-                    
-                    crc = usMBCRC16((unsigned char *) ModBusSlaves[ActiveSlaveIndex].recieveBuffer, MBRcvBufferPos);
+                {
+                    crc = usMBCRC16(pPort->recieveBuffer, pPort->rcvBufferPos);
                     if( crc == 0 )
                     {
-                        MBEventInQueue = TRUE;
-                        MBQueuedEvent = EV_EXECUTE;     
-                    } 
+                        pPort->statistics.slaveMessages++;
+                        pPort->requestLength = pPort->rcvBufferPos;
+                        pPort->eventInQueue = TRUE;
+                        pPort->queuedEvent = EV_EXECUTE;
+                        PostEvent(pPort->event);
+                    }
+                    else
+                    {
+                        pPort->statistics.crcErrors++;
+                    }
                 }
                 break;
             }
         case EV_EXECUTE:
-            {	
-                MB_handle_request();
+            {
+                MBHandleRequest(pPort);
                 break;
-            }   
+            }
         }
     }
 }
 
-void MBReceiveFSM( void )
+// Called by the receive interrupt of the port's USART
+void MBPortReceiveFSM(tMBSlavePort *pPort)
 {
     signed char Byte;
-        
-    Byte = (signed char)GetByte(USART_2);
     
-    switch ( MBRcvState )
-    {		
+    Byte = (signed char)GetByte(pPort->usartID);
+    
+    switch ( pPort->rcvState )
+    {
     case STATE_RX_IDLE:
-        MBRcvBufferPos = 0;
-        
-        RecieveBuffer[MBRcvBufferPos++] = Byte;
-        MBRcvState = STATE_RX_RCV;
-        
-        ModBusTimerEnable(T_10_MS); // 10 ms are enought for waiting one frame by 19200 baude rate
+        pPort->rcvBufferPos = 0;
+    
+        pPort->recieveBuffer[pPort->rcvBufferPos++] = Byte;
+        pPort->rcvState = STATE_RX_RCV;
+    
+        pPort->timerEnable(T_10_MS); // 10 ms are enought for waiting one frame by 19200 baude rate
         break;
-        
+    
     case STATE_RX_RCV:
-        if( MBRcvBufferPos < PACKET_SIZE )
+        if( pPort->rcvBufferPos < PACKET_SIZE )
         {
-            RecieveBuffer[MBRcvBufferPos++] = Byte;
+            pPort->recieveBuffer[pPort->rcvBufferPos++] = Byte;
         }
-        ModBusTimerEnable(T_10_MS);
+        else
+        {
+            pPort->statistics.overruns++;
+        }
+        pPort->timerEnable(T_10_MS);
         break;
-    }	
+    }
 }
 
-void MB_handle_request( void )
+/*
+    Execute broadcast request (address 0) for every slave in one pass. Only write functions can be broadcast;
+    there is no response - neither for executed request nor for an error, the master only waits the turnaround delay.
+*/
+void MBExecuteBroadcast(tMBSlavePort *pPort)
 {
-    int mblen;
-    unsigned int crc;
+    int i;
     
-    mblen = 0;
+    pPort->statistics.broadcastsReceived++;
+    
+    if(MBCheckRequest(pPort->recieveBuffer, pPort->requestLength) != MB_EXCEPTION_NONE || MBIsBroadcastFunction(pPort->recieveBuffer[1]) == FALSE)
+    {
+        return;
+    }
     
-    if(ModBusSlaves[ActiveSlaveIndex].recieveBuffer[0] == ModBusSlaves[ActiveSlaveIndex].address)
+    for(i = 0; i < MAX_MODBUS_SLAVE_DEVICES; i++)
     {
-        switch(ModBusSlaves[ActiveSlaveIndex].recieveBuffer[1])
+        pPort->activeSlaveIndex = i;
+        ModBusSlaves[i].isSlaveActive = TRUE;
+    
+        switch(pPort->recieveBuffer[1])
         {
-        case 1: //Read Coil Status
-            mblen = process_cmd1();
-            break;
-        case 2: //Read Discrete Input
-            mblen = process_cmd2();
-            break;
-        case 3: //Read Holding Registeers
-            mblen = process_cmd3();
-            break;
         case 5: //Force Single Coil
-            mblen = process_cmd5();
+            process_cmd5(pPort);
+            break;
+        case 6: //Preset Single Register
+            process_cmd6(pPort);
             break;
         case 15: //Force Multiple Coils
-            mblen = process_cmd15();
+            process_cmd15(pPort);
             break;
         case 16: //Preset Multiple Registers
-            mblen = process_cmd16();
+            process_cmd16(pPort);
             break;
-        default:
-            return;
         }
-        MBSndState = STATE_TX_XMIT;
     }
     
-    if( MBSndState == STATE_TX_XMIT  )
+    //responses composed by the functions are not sent
+    ClearModBusSlaveMemory(pPort->responseBuffer, RESPONSE_SIZE);
+}
+
+void MBHandleRequest(tMBSlavePort *pPort)
+{
+    int mblen;
+    unsigned char exception;
+    unsigned int crc;
+    
+    mblen = 0;
+    
+    if(pPort->recieveBuffer[0] == MB_BROADCAST_ADDRESS)
+    {
+        MBExecuteBroadcast(pPort);
+        return;
+    }
+    
+    if(pPort->recieveBuffer[0] == ModBusSlaves[pPort->activeSlaveIndex].address)
+    {
+        // unknown function and wrong length are rejected before the request is parsed
+        exception = MBCheckRequest(pPort->recieveBuffer, pPort->requestLength);
+        if(exception != MB_EXCEPTION_NONE)
+        {
+            mblen = MB_EXCEPTION_RESPONSE(exception);
+        }
+        else
+        {
+            switch(pPort->recieveBuffer[1])
+            {
+            case 1: //Read Coil Status
+                mblen = process_cmd1(pPort);
+                break;
+            case 2: //Read Discrete Input
+                mblen = process_cmd2(pPort);
+                break;
+            case 3: //Read Holding Registeers
+                mblen = process_cmd3(pPort);
+                break;
+            case 4: //Read Input Registers
+                mblen = process_cmd4(pPort);
+                break;
+            case 5: //Force Single Coil
+                mblen = process_cmd5(pPort);
+                break;
+            case 6: //Preset Single Register
+                mblen = process_cmd6(pPort);
+                break;
+            case 8: //Diagnostics
+                mblen = process_cmd8(pPort);
+                break;
+            case 15: //Force Multiple Coils
+                mblen = process_cmd15(pPort);
+                break;
+            case 16: //Preset Multiple Registers
+                mblen = process_cmd16(pPort);
+                break;
+            case 23: //Read/Write Multiple Registers
+                mblen = process_cmd23(pPort);
+                break;
+            default:
+                mblen = MB_EXCEPTION_RESPONSE(MB_EXCEPTION_ILLEGAL_FUNCTION);
+                break;
+            }
+        }
+    
+        MBCountRequest(pPort, pPort->recieveBuffer[1], (mblen < 0) ? TRUE : FALSE);
+    
+        if(mblen < 0)
+        {
+            mblen = MBComposeException(pPort->responseBuffer, pPort->recieveBuffer, -mblen);
+        }
+    
+        pPort->sndState = STATE_TX_XMIT;
+    }
+    
+    if( pPort->sndState == STATE_TX_XMIT  )
     {
-        crc = usMBCRC16(ResponseBuffer, mblen);
-        ResponseBuffer[mblen + 0] = (unsigned char) crc;
-        ResponseBuffer[mblen + 1] = (unsigned char) (crc >> 8);	
-        MBSndBufferPos = mblen + 2; //2 - CRC_LEN
-        
-        //copy global ResponseBuffer in active slave's response buffer for regular slave simulation.
-        CopyModBusMemory(ResponseBuffer, ModBusSlaves[ActiveSlaveIndex].responseBuffer, MBSndBufferPos);
+        crc = usMBCRC16(pPort->responseBuffer, mblen);
+        pPort->responseBuffer[mblen + 0] = (unsigned char) crc;
+        pPort->responseBuffer[mblen + 1] = (unsigned char) (crc >> 8);
+        pPort->sndBufferPos = mblen + 2; //2 - CRC_LEN
     }
 }
 
-void MBTimerExpired( void )
+// Called by the end of frame timer of the port
+void MBPortTimerExpired(tMBSlavePort *pPort)
 {
-    switch ( MBRcvState )
+    switch ( pPort->rcvState )
     {
     case STATE_RX_RCV:
         {
-            MBEventInQueue = TRUE;
-            MBQueuedEvent = EV_FRAME_RECEIVED;
+            pPort->frameEndCycles = GetCycleCounter();
+            pPort->eventInQueue = TRUE;
+            pPort->queuedEvent = EV_FRAME_RECEIVED;
+            PostEvent(pPort->event);
             break;
         }
     default:  ;
     }
-    ModBusTimerDisable();
-    MBRcvState = STATE_RX_IDLE;
+    pPort->timerDisable();
+    pPort->rcvState = STATE_RX_IDLE;
 }
 
-void MB_slave_transmit( void )
+void MBPortTransmit(tMBSlavePort *pPort)
 {
-    if( MBSndState == STATE_TX_XMIT )
+    u32 start;
+    
+    if( pPort->sndState == STATE_TX_XMIT )
     {
-        OutString(ResponseBuffer, MBSndBufferPos, USART_2, MB_SLAVE_TIMER, T_10_MS);
-        MBSndState = STATE_TX_IDLE;
-        
-        //Clearing Recive buffers
-        ClearModBusSlaveMemory(RecieveBuffer, PACKET_SIZE);
-        ClearModBusSlaveMemory(ModBusSlaves[ActiveSlaveIndex].recieveBuffer, PACKET_SIZE);
-        
+        start = GetCycleCounter();
+        OutString(pPort->responseBuffer, pPort->sndBufferPos, pPort->usartID, pPort->timerID, T_10_MS);
+        MBCountResponse(pPort, start - pPort->frameEndCycles, GetCycleCounter() - start);
+    
+        pPort->sndState = STATE_TX_IDLE;
+        pPort->statistics.responsesSent++;
+    
+        //Clearing Recive buffer
+        ClearModBusSlaveMemory(pPort->recieveBuffer, PACKET_SIZE);
+    
         //Clearing Response
-        ClearModBusSlaveMemory(ResponseBuffer, RESPONSE_SIZE);
-        ClearModBusSlaveMemory(ModBusSlaves[ActiveSlaveIndex].responseBuffer, RESPONSE_SIZE);
+        ClearModBusSlaveMemory(pPort->responseBuffer, RESPONSE_SIZE);
     }
 }
 
 //Read Coil Status
-char process_cmd1(void)
+int process_cmd1(tMBSlavePort *pPort)
 {
-    unsigned short outputs = 0x0000, i;
-    unsigned short temp;
-    unsigned char bytesCount;
+    const unsigned char *pRequest = pPort->recieveBuffer;
+    unsigned char *pResponse = pPort->responseBuffer;
+    unsigned short startAddress, quantity;
+    unsigned char exception;
     
-    if(RecieveBuffer[2] != 0) 
-    {
-        return 0; //check START ADDRESS HI is 0
-    }
-    if(RecieveBuffer[3] >= OUTPUTS_NUMBER) 
-    {
-        return 0;  //check START ADDRESS LO is [0:15]
-    }
-    if(RecieveBuffer[4] != 0) 
-    {
-        return 0; //check No of POINTS HI is 0
-    }
-    if((OUTPUTS_NUMBER - RecieveBuffer[3]) < RecieveBuffer[5]) 
+    startAddress = ((unsigned short)pRequest[2] << 8) | pRequest[3];
+    quantity = ((unsigned short)pRequest[4] << 8) | pRequest[5];
+    
+    if(quantity == 0 || quantity > MB_MAX_READ_BITS) 
     {
-        return 0; //check No of POINTS LO
+        return MB_EXCEPTION_RESPONSE(MB_EXCEPTION_ILLEGAL_DATA_VALUE); //check No of POINTS is 1 .. 2000
     }
     
-    //read all cois' states
-    for(i = 0; i < OUTPUTS_NUMBER; i++)
+    //coils are packed straight into the response
+    exception = MBReadCoils(pPort->activeSlaveIndex, startAddress, quantity, &pResponse[3]);
+    if(exception != MB_EXCEPTION_NONE)
     {
-        outputs |= (ModBusSlaves[ActiveSlaveIndex].outputs[i] & 0x01) << i;
+        return MB_EXCEPTION_RESPONSE(exception);
     }
     
-    //take desired action
-    outputs = outputs >> RecieveBuffer[3];
-    temp = (unsigned short)((1 << RecieveBuffer[5]) - 1);
-    outputs &= temp;
-    bytesCount = (RecieveBuffer[5] / 8) ? 2 : 1;
-    
     //compose response
-    ResponseBuffer[0] = RecieveBuffer[0]; // SLAVEID - same (already confirmed)
-    ResponseBuffer[1] = RecieveBuffer[1]; // COMMANDID - same (already confirmed)
-    ResponseBuffer[2] = bytesCount; // BYTECOUNT - is at max 2 bytes as we have 16 outputs
-    ResponseBuffer[3] = (unsigned char)(outputs & 0x00FF); //get LO Byte
-    
-    if(bytesCount == 2)
-    {
-        ResponseBuffer[4] = (unsigned char)(outputs >> 8); //get HI Byte
-    }
+    pResponse[0] = pRequest[0]; // SLAVEID - same (already confirmed)
+    pResponse[1] = pRequest[1]; // COMMANDID - same (already confirmed)
+    pResponse[2] = (quantity + 7) / 8; // BYTECOUNT - is at max 250 bytes
     
-    return bytesCount + 3; //length of response;
+    return pResponse[2] + 3; //length of response;
 }
 
 //Read Discrete Input
-char process_cmd2(void)
+int process_cmd2(tMBSlavePort *pPort)
 {
-    unsigned short inputs = 0x0000, i;
-    unsigned short temp;
-    unsigned char bytesCount;
+    const unsigned char *pRequest = pPort->recieveBuffer;
+    unsigned char *pResponse = pPort->responseBuffer;
+    unsigned short startAddress, quantity;
+    unsigned char exception;
     
-    if(RecieveBuffer[2] != 0) 
-    {
-        return 0; //check START ADDRESS HI is 0
-    }
-    if(RecieveBuffer[3] >= INPUTS_NUMBER) 
+    startAddress = ((unsigned short)pRequest[2] << 8) | pRequest[3];
+    quantity = ((unsigned short)pRequest[4] << 8) | pRequest[5];
+    
+    if(quantity == 0 || quantity > MB_MAX_READ_BITS) 
     {
-        return 0;  //check START ADDRESS LO is [0:15]
+        return MB_EXCEPTION_RESPONSE(MB_EXCEPTION_ILLEGAL_DATA_VALUE); //check No of POINTS is 1 .. 2000
     }
-    if(RecieveBuffer[4] != 0) 
+    
+    //inputs are packed straight into the response
+    exception = MBReadInputs(pPort->activeSlaveIndex, startAddress, quantity, &pResponse[3]);
+    if(exception != MB_EXCEPTION_NONE)
     {
-        return 0; //check No of POINTS HI is 0
+        return MB_EXCEPTION_RESPONSE(exception);
     }
-    if((INPUTS_NUMBER - RecieveBuffer[3]) < RecieveBuffer[5]) 
+    
+    //compose response
+    pResponse[0] = pRequest[0]; // SLAVEID - same (already confirmed)
+    pResponse[1] = pRequest[1]; // COMMANDID - same (already confirmed)
+    pResponse[2] = (quantity + 7) / 8; // BYTECOUNT - is at max 250 bytes
+    
+    return pResponse[2] + 3; //length of response;
+}
+
+//Read Holding Registeers
+int process_cmd3(tMBSlavePort *pPort)
+{
+    const unsigned char *pRequest = pPort->recieveBuffer;
+    unsigned char *pResponse = pPort->responseBuffer;
+    unsigned short registers[MB_MAX_READ_REGISTERS];
+    unsigned short startAddress, quantity;
+    unsigned char exception;
+    int i;
+    
+    startAddress = ((unsigned short)pRequest[2] << 8) | pRequest[3];
+    quantity = ((unsigned short)pRequest[4] << 8) | pRequest[5];
+    
+    if(quantity == 0 || quantity > MB_MAX_READ_REGISTERS) 
     {
-        return 0; //check No of POINTS LO
+        return MB_EXCEPTION_RESPONSE(MB_EXCEPTION_ILLEGAL_DATA_VALUE); //check No of POINTS is 1 .. 125
     }
     
-    //read all cois' states
-    for(i = 0; i < INPUTS_NUMBER; i++)
+    //values of bound registers are taken now, the whole range must be defined
+    exception = MBReadHoldingRegisters(pPort->activeSlaveIndex, startAddress, quantity, registers);
+    if(exception != MB_EXCEPTION_NONE)
     {
-        inputs |= (ModBusSlaves[ActiveSlaveIndex].inputs[i] & 0x01) << i;
+        return MB_EXCEPTION_RESPONSE(exception);
     }
     
-    //take desired action
-    inputs = inputs >> RecieveBuffer[3];
-    temp = (unsigned short)((1 << RecieveBuffer[5]) - 1);
-    inputs &= temp;
-    bytesCount = (RecieveBuffer[5] / 8) ? 2 : 1;
-    
     //compose response
-    ResponseBuffer[0] = RecieveBuffer[0]; // SLAVEID - same (already confirmed)
-    ResponseBuffer[1] = RecieveBuffer[1]; // COMMANDID - same (already confirmed)
-    ResponseBuffer[2] = bytesCount; // BYTECOUNT - is at max 2 bytes as we have 16 outputs
-    ResponseBuffer[3] = (unsigned char)(inputs & 0x00FF); //get LO Byte
+    pResponse[0] = pRequest[0]; // SLAVEID - same (already confirmed)
+    pResponse[1] = pRequest[1]; // COMMANDID - same (already confirmed)
+    pResponse[2] = quantity * 2; // BYTECOUNT - is at max 250 bytes
     
-    if(bytesCount == 2)
+    for(i = 0; i < quantity; i ++)
     {
-        ResponseBuffer[4] = (unsigned char)(inputs >> 8); //get HI Byte
+        pResponse[3 + i * 2] = registers[i] >> 8;
+        pResponse[4 + i * 2] = registers[i];
     }
     
-    return bytesCount + 3; //length of response;
+    return 3 + quantity * 2;
 }
 
-//Read Holding Registeers
-char process_cmd3(void)
+//Read Input Registers
+int process_cmd4(tMBSlavePort *pPort)
 {
+    const unsigned char *pRequest = pPort->recieveBuffer;
+    unsigned char *pResponse = pPort->responseBuffer;
+    unsigned short registers[MB_MAX_READ_REGISTERS];
+    unsigned short startAddress, quantity;
+    unsigned char exception;
     int i;
     
-    if(RecieveBuffer[2] != 0) 
-    {
-        return 0; //check START ADDRESS HI is 0
-    }
-    if(RecieveBuffer[3] >= HOLDING_REGISTERS_NUMBER) 
+    startAddress = ((unsigned short)pRequest[2] << 8) | pRequest[3];
+    quantity = ((unsigned short)pRequest[4] << 8) | pRequest[5];
+    
+    if(quantity == 0 || quantity > MB_MAX_READ_REGISTERS) 
     {
-        return 0;  //check START ADDRESS LO is < HOLDING_REGISTERS_NUMBER
+        return MB_EXCEPTION_RESPONSE(MB_EXCEPTION_ILLEGAL_DATA_VALUE); //check No of POINTS is 1 .. 125
     }
-    if(RecieveBuffer[4] != 0) 
+    
+    //values of bound registers are taken now, the whole range must be defined
+    exception = MBReadInputRegisters(pPort->activeSlaveIndex, startAddress, quantity, registers);
+    if(exception != MB_EXCEPTION_NONE)
     {
-        return 0; //check no of points hi is 0
+        return MB_EXCEPTION_RESPONSE(exception);
     }
-    if((HOLDING_REGISTERS_NUMBER - RecieveBuffer[3]) < RecieveBuffer[5]) 
-    {
-        return 0; //check No of POINTS LO
-    }    
     
     //compose response
-    ResponseBuffer[0] = RecieveBuffer[0]; // SLAVEID - same (already confirmed)
-    ResponseBuffer[1] = RecieveBuffer[1]; // COMMANDID - same (already confirmed)
-    ResponseBuffer[2] = RecieveBuffer[5] * 2; // BYTECOUNT - is at max 200 bytes as we have 100 Hold. Reg.
+    pResponse[0] = pRequest[0]; // SLAVEID - same (already confirmed)
+    pResponse[1] = pRequest[1]; // COMMANDID - same (already confirmed)
+    pResponse[2] = quantity * 2; // BYTECOUNT - is at max 250 bytes
     
-    for(i = 0; i < RecieveBuffer[5]; i ++)
+    for(i = 0; i < quantity; i ++)
     {
-        ResponseBuffer[3 + i * 2] = ModBusSlaves[ActiveSlaveIndex].holdingRegisters[i + RecieveBuffer[3]] >> 8;
-        ResponseBuffer[4 + i * 2] = ModBusSlaves[ActiveSlaveIndex].holdingRegisters[i + RecieveBuffer[3]];
+        pResponse[3 + i * 2] = registers[i] >> 8;
+        pResponse[4 + i * 2] = registers[i];
     }
     
-    return 3 + RecieveBuffer[5] * 2;
+    return 3 + quantity * 2;
 }
 
-//Force Single Coil
-char process_cmd5(void)
+//Preset Single Register
+int process_cmd6(tMBSlavePort *pPort)
 {
-    if(RecieveBuffer[2] != 0)
-    {
-        return 0; //check COIL ADDRESS HI is 0
-    }
-    if(RecieveBuffer[3] >= OUTPUTS_NUMBER) 
+    const unsigned char *pRequest = pPort->recieveBuffer;
+    unsigned char *pResponse = pPort->responseBuffer;
+    unsigned short address, value;
+    unsigned char exception;
+    
+    address = ((unsigned short)pRequest[2] << 8) | pRequest[3];
+    value = ((unsigned short)pRequest[4] << 8) | pRequest[5];
+    
+    exception = MBWriteHoldingRegisters(pPort->activeSlaveIndex, address, 1, &value);
+    if(exception != MB_EXCEPTION_NONE)
     {
-        return 0;  //check COIL ADDRESS LO is [0:15]
+        return MB_EXCEPTION_RESPONSE(exception); //not defined, read only or rejected value
     }
-    if(RecieveBuffer[4] != 0xFF && RecieveBuffer[4] != 0x00) 
+    
+    //compose response - echo of the request
+    pResponse[0] = pRequest[0];
+    pResponse[1] = pRequest[1];
+    pResponse[2] = pRequest[2];
+    pResponse[3] = pRequest[3];
+    pResponse[4] = pRequest[4];
+    pResponse[5] = pRequest[5];
+    
+    return 6;
+}
+
+//Force Single Coil
+int process_cmd5(tMBSlavePort *pPort)
+{
+    const unsigned char *pRequest = pPort->recieveBuffer;
+    unsigned char *pResponse = pPort->responseBuffer;
+    unsigned short address;
+    unsigned char coil, exception;
+    
+    address = ((unsigned short)pRequest[2] << 8) | pRequest[3];
+    
+    if(pRequest[4] != 0xFF && pRequest[4] != 0x00) 
     {
-        return 0; //check DATA HI
+        return MB_EXCEPTION_RESPONSE(MB_EXCEPTION_ILLEGAL_DATA_VALUE); //check DATA HI
     }
-    if(RecieveBuffer[5] != 0x00) 
+    if(pRequest[5] != 0x00) 
     {
-        return 0; //check DATA LO
+        return MB_EXCEPTION_RESPONSE(MB_EXCEPTION_ILLEGAL_DATA_VALUE); //check DATA LO
     }
     
     //take desired action
-    if(RecieveBuffer[4] == 0xFF)
-    {
-        ModBusSlaves[ActiveSlaveIndex].outputs[RecieveBuffer[3]] = 0x01;
-    }
-    else 
+    coil = (pRequest[4] == 0xFF) ? 0x01 : 0x00;
+    
+    exception = MBWriteCoils(pPort->activeSlaveIndex, address, 1, &coil);
+    if(exception != MB_EXCEPTION_NONE)
     {
-        ModBusSlaves[ActiveSlaveIndex].outputs[RecieveBuffer[3]] = 0x00;
+        return MB_EXCEPTION_RESPONSE(exception);
     }
     
     //compose response
-    ResponseBuffer[0] = RecieveBuffer[0];
-    ResponseBuffer[1] = RecieveBuffer[1];
-    ResponseBuffer[2] = RecieveBuffer[2];
-    ResponseBuffer[3] = RecieveBuffer[3];
-    ResponseBuffer[4] = RecieveBuffer[4];
-    ResponseBuffer[5] = RecieveBuffer[5];
+    pResponse[0] = pRequest[0];
+    pResponse[1] = pRequest[1];
+    pResponse[2] = pRequest[2];
+    pResponse[3] = pRequest[3];
+    pResponse[4] = pRequest[4];
+    pResponse[5] = pRequest[5];
     
     return 6;
 }
 
 //Force Multiple Coils
-char process_cmd15(void)
+int process_cmd15(tMBSlavePort *pPort)
 {
-    unsigned char bytesCount, i, j, currentByte, coilsCount, startAddress, ucSize;
+    const unsigned char *pRequest = pPort->recieveBuffer;
+    unsigned char *pResponse = pPort->responseBuffer;
+    unsigned short startAddress, quantity;
+    unsigned char exception;
+    
+    startAddress = ((unsigned short)pRequest[2] << 8) | pRequest[3];
+    quantity = ((unsigned short)pRequest[4] << 8) | pRequest[5];
     
-    if(RecieveBuffer[2] != 0) 
+    if(quantity == 0 || quantity > MB_MAX_WRITE_BITS) 
     {
-        return 0; //check COIL ADDRESS HI
+        return MB_EXCEPTION_RESPONSE(MB_EXCEPTION_ILLEGAL_DATA_VALUE); //check QUANTITY is 1 .. 1968
     }
-    if(RecieveBuffer[3] >= OUTPUTS_NUMBER) 
+    if(pRequest[6] != (quantity + 7) / 8) //one byte per 8 coils
     {
-        return 0; //check COIL ADDRESS LO is [0:15]
+        return MB_EXCEPTION_RESPONSE(MB_EXCEPTION_ILLEGAL_DATA_VALUE); // check BYTE COUNT
     }
-    if(RecieveBuffer[4] != 0) 
+    
+    //coils are taken 16 at once straight from the request
+    exception = MBWriteCoils(pPort->activeSlaveIndex, startAddress, quantity, &pRequest[7]);
+    if(exception != MB_EXCEPTION_NONE)
     {
-        return 0; //check QUANTITY HI
+        return MB_EXCEPTION_RESPONSE(exception);
     }
-    if((OUTPUTS_NUMBER - RecieveBuffer[3]) < RecieveBuffer[5]) 
+    
+    //compose response
+    pResponse[0] = pRequest[0];
+    pResponse[1] = pRequest[1];
+    pResponse[2] = pRequest[2];
+    pResponse[3] = pRequest[3];
+    pResponse[4] = pRequest[4];
+    pResponse[5] = pRequest[5];
+    
+    return 6;
+}
+
+//Preset Multiple Registers
+int process_cmd16(tMBSlavePort *pPort)
+{
+    const unsigned char *pRequest = pPort->recieveBuffer;
+    unsigned char *pResponse = pPort->responseBuffer;
+    unsigned short registers[MB_MAX_WRITE_REGISTERS];
+    unsigned short startAddress, quantity;
+    unsigned char exception;
+    int i;
+    
+    startAddress = ((unsigned short)pRequest[2] << 8) | pRequest[3];
+    quantity = ((unsigned short)pRequest[4] << 8) | pRequest[5];
+    
+    if(quantity == 0 || quantity > MB_MAX_WRITE_REGISTERS) 
     {
-        return 0; //check QUANTITY LO
+        return MB_EXCEPTION_RESPONSE(MB_EXCEPTION_ILLEGAL_DATA_VALUE); //check No of POINTS is 1 .. 123
     }
-    if(RecieveBuffer[5] > OUTPUTS_NUMBER) 
+    if(pRequest[6] != quantity * 2) 
     {
-        return 0; //check QUANTITY Coils - it must be less or equal then OUTPUTS_NUMBER
+        return MB_EXCEPTION_RESPONSE(MB_EXCEPTION_ILLEGAL_DATA_VALUE); //check BYTE COUNT
     }
-    if(RecieveBuffer[6] > 2 || RecieveBuffer[6] < 1) //max Coils' number is 16 which is 2 Bytes
+    
+    for (i = 0; i < quantity; i ++)
     {
-        return 0; // check BYTE COUNT
+        registers[i] = (unsigned short)pRequest[7 + i * 2] << 8;
+        registers[i] |= pRequest[8 + i * 2];
     }
     
-    ucSize = sizeof(unsigned char) * 8; //bits in 1 unsigned char
-    startAddress = RecieveBuffer[3];
-    coilsCount = RecieveBuffer[5];
-    bytesCount = RecieveBuffer[6];
-    
-    for(i = 0; i < bytesCount; i++)
+    exception = MBWriteHoldingRegisters(pPort->activeSlaveIndex, startAddress, quantity, registers);
+    if(exception != MB_EXCEPTION_NONE)
     {
-        currentByte = RecieveBuffer[7 + i];
-        
-        for(j = 0; j < ucSize; j++)
-        {
-            if(coilsCount > 0)
-            {
-                // j = 3 =>
-                // 0011 1010 - current byte
-                //&
-                // 0000 1000 - generated mask with j
-                //-----------
-                // 0000 1000 ----> 0000 0001 - result 
-                ModBusSlaves[ActiveSlaveIndex].outputs[startAddress + i * ucSize + j] = (currentByte & (1 << j)) >> j; 
-                coilsCount --;
-            }
-            else
-            {
-                break;
-            }
-        }
-    }
+        return MB_EXCEPTION_RESPONSE(exception); //not defined, read only or rejected values
+    }	
     
     //compose response
-    ResponseBuffer[0] = RecieveBuffer[0];
-    ResponseBuffer[1] = RecieveBuffer[1];
-    ResponseBuffer[2] = RecieveBuffer[2];
-    ResponseBuffer[3] = RecieveBuffer[3];
-    ResponseBuffer[4] = RecieveBuffer[4];
-    ResponseBuffer[5] = RecieveBuffer[5];
+    pResponse[0] = pRequest[0];
+    pResponse[1] = pRequest[1];
+    pResponse[2] = pRequest[2];
+    pResponse[3] = pRequest[3];
+    pResponse[4] = pRequest[4];
+    pResponse[5] = pRequest[5];
     
     return 6;
 }
 
-//Preset Multiple Registers
-char process_cmd16(void)
+//Read/Write Multiple Registers - registers are written first, the response carries the read registers
+int process_cmd23(tMBSlavePort *pPort)
 {
-    unsigned char i;
+    const unsigned char *pRequest = pPort->recieveBuffer;
+    unsigned char *pResponse = pPort->responseBuffer;
+    unsigned short registers[MB_MAX_READ_REGISTERS];
+    unsigned short readStart, readCount, writeStart, writeCount;
+    unsigned char exception;
+    int i;
+    
+    readStart = ((unsigned short)pRequest[2] << 8) | pRequest[3];
+    readCount = ((unsigned short)pRequest[4] << 8) | pRequest[5];
+    writeStart = ((unsigned short)pRequest[6] << 8) | pRequest[7];
+    writeCount = ((unsigned short)pRequest[8] << 8) | pRequest[9];
     
-    if(RecieveBuffer[2] != 0) 
+    if(readCount == 0 || readCount > MB_MAX_READ_REGISTERS) 
     {
-        return 0; //check START ADDRESS HI is 0
+        return MB_EXCEPTION_RESPONSE(MB_EXCEPTION_ILLEGAL_DATA_VALUE); //check QUANTITY TO READ is 1 .. 125
     }
-    if(RecieveBuffer[3] >= HOLDING_REGISTERS_NUMBER) 
+    if(writeCount == 0 || writeCount > MB_MAX_READ_WRITE_REGISTERS) 
     {
-        return 0;  //check START ADDRESS LO is < HOLDING_REGISTERS_NUMBER
+        return MB_EXCEPTION_RESPONSE(MB_EXCEPTION_ILLEGAL_DATA_VALUE); //check QUANTITY TO WRITE is 1 .. 121
     }
-    if(RecieveBuffer[4] != 0) 
+    if(pRequest[10] != writeCount * 2) 
     {
-        return 0; //check no of points hi is 0
+        return MB_EXCEPTION_RESPONSE(MB_EXCEPTION_ILLEGAL_DATA_VALUE); //check WRITE BYTE COUNT
     }
-    if((HOLDING_REGISTERS_NUMBER - RecieveBuffer[3]) < RecieveBuffer[5]) 
+    if(MBCheckHoldingRegisters(pPort->activeSlaveIndex, readStart, readCount, FALSE) == FALSE) 
     {
-        return 0; //check No of POINTS LO
-    }  
+        return MB_EXCEPTION_RESPONSE(MB_EXCEPTION_ILLEGAL_DATA_ADDRESS); //check READ range before anything is written
+    }
     
-    for (i = 0; i < RecieveBuffer[5]; i ++)
+    for(i = 0; i < writeCount; i ++)
     {
-        ModBusSlaves[ActiveSlaveIndex].holdingRegisters[RecieveBuffer[3] + i] = (unsigned short)RecieveBuffer[7 + i * 2] << 8;
-        ModBusSlaves[ActiveSlaveIndex].holdingRegisters[RecieveBuffer[3] + i] |= RecieveBuffer[8 + i * 2];
-    }	
+        registers[i] = (unsigned short)pRequest[11 + i * 2] << 8;
+        registers[i] |= pRequest[12 + i * 2];
+    }
+    
+    exception = MBWriteHoldingRegisters(pPort->activeSlaveIndex, writeStart, writeCount, registers);
+    if(exception != MB_EXCEPTION_NONE)
+    {
+        return MB_EXCEPTION_RESPONSE(exception); //not defined, read only or rejected values
+    }
+    
+    MBReadHoldingRegisters(pPort->activeSlaveIndex, readStart, readCount, registers);
     
     //compose response
-    ResponseBuffer[0] = RecieveBuffer[0];
-    ResponseBuffer[1] = RecieveBuffer[1];
-    ResponseBuffer[2] = RecieveBuffer[2];
-    ResponseBuffer[3] = RecieveBuffer[3];
-    ResponseBuffer[4] = RecieveBuffer[4];
-    ResponseBuffer[5] = RecieveBuffer[5];
+    pResponse[0] = pRequest[0]; // SLAVEID - same (already confirmed)
+    pResponse[1] = pRequest[1]; // COMMANDID - same (already confirmed)
+    pResponse[2] = readCount * 2; // BYTECOUNT
     
-    return 6;
+    for(i = 0; i < readCount; i ++)
+    {
+        pResponse[3 + i * 2] = registers[i] >> 8;
+        pResponse[4 + i * 2] = registers[i];
+    }
+    
+    return 3 + readCount * 2;
+}
+
+
+// Statistics of the port, 0 if the port is not initialized
+const tMBSlaveStatistics *MBGetPortStatistics(int portIndex)
+{
+    if(portIndex < 0 || portIndex >= MB_PORTS_NUMBER || SlavePorts[portIndex] == 0)
+    {
+        return 0;
+    }
+    
+    return &SlavePorts[portIndex]->statistics;
+}
+
+// ..................ModBus port (USART_2)..........................
+
+void MBInitHardwareAndProtocol(void)
+{    
+    MBInitPort(&ModBusPort, MB_MODBUS_PORT, USART_2, MB_SLAVE_TIMER, EVENT_MODBUS, ModBusTimerEnable, ModBusTimerDisable);
+    
+    InitNewMBSlaveDevices();
+    
+    InitUSART2(MB_SLAVE_UNIT);
+    InitTIM3();
+}	
+
+void MBPollSlave( void )
+{
+    MBPollPort(&ModBusPort);
+}
+
+void MBReceiveFSM( void )
+{
+    MBPortReceiveFSM(&ModBusPort);
+}
+
+void MBTimerExpired( void )
+{
+    MBPortTimerExpired(&ModBusPort);
+}
+
+void MB_slave_transmit( void )
+{
+    MBPortTransmit(&ModBusPort);
+}
+
+// Get communication statistics of ModBus (USART_2) port
+const tMBSlaveStatistics *GetMBSlaveStatistics(void)
+{
+    return &ModBusPort.statistics;
 }
@@ -4,44 +4,162 @@
 #include "definitions.h"
 
 // -------- Modbus Address ranges ---------------------
-#define HOLDING_REGISTERS_NUMBER        			100
-#define INPUTS_NUMBER                                           16
-#define OUTPUTS_NUMBER                                          16
+#define HOLDING_REGISTERS_NUMBER        			100             // default memory block of every slave, 0 .. 99
+#define INPUT_REGISTERS_NUMBER                                  100             // default memory block of every slave, 0 .. 99
+#define INPUTS_NUMBER                                           2000
+#define OUTPUTS_NUMBER                                          2000
 #define MAX_MODBUS_SLAVE_DEVICES                                10
 
+// packed bits, 16 per word; the spare word lets any 16 bits be taken as one 32-bit window
+#define MB_BIT_WORDS(BITS_NUMBER)                               ((BITS_NUMBER) / 16 + 1)
+
+// -------- Bits in one request (protocol limits) --------
+#define MB_MAX_READ_BITS                                        2000            // FC 1, 2
+#define MB_MAX_WRITE_BITS                                       1968            // FC 15
+
+// -------- Registers in one request (protocol limits) ---
+#define MB_MAX_READ_REGISTERS                                   125             // FC 3, 4 and read part of FC 23
+#define MB_MAX_WRITE_REGISTERS                                  123             // FC 16
+#define MB_MAX_READ_WRITE_REGISTERS                             121             // write part of FC 23
+
 #define PACKET_SIZE		                                256
 #define RESPONSE_SIZE 	                                        256
 
 #define INVALID_SLAVE_INDEX                                     0x0000FFFF
 
+#define MB_BROADCAST_ADDRESS                                    0               // write requests for all slaves, without response
+#define MB_MIN_FRAME_SIZE                                       4               // address, function, CRC
+
+// -------- Exception codes ---------------------------
+#define MB_EXCEPTION_NONE                                       0x00
+#define MB_EXCEPTION_ILLEGAL_FUNCTION                           0x01
+#define MB_EXCEPTION_ILLEGAL_DATA_ADDRESS                       0x02
+#define MB_EXCEPTION_ILLEGAL_DATA_VALUE                         0x03
+#define MB_EXCEPTION_FUNCTION_FLAG                              0x80            // set in function code of exception response
+
+// process_cmdN() returns length of the response or negative exception code
+#define MB_EXCEPTION_RESPONSE(EXCEPTION)                        (-(int)(EXCEPTION))
+
 
 typedef struct Slave{
     unsigned char address;
-    unsigned char inputs[INPUTS_NUMBER];
-    unsigned char outputs[OUTPUTS_NUMBER];
-    unsigned short holdingRegisters[HOLDING_REGISTERS_NUMBER];
-    unsigned char responseBuffer[RESPONSE_SIZE];
-    unsigned char recieveBuffer[PACKET_SIZE];
+    unsigned short inputs[MB_BIT_WORDS(INPUTS_NUMBER)];
+    unsigned short outputs[MB_BIT_WORDS(OUTPUTS_NUMBER)];
     BOOL isSlaveActive;
 }ModBusSlaveUnit;
 
+// -------- Performance counters --------------------
+#define MB_PORTS_NUMBER                                         2
+#define MB_MODBUS_PORT                                          0               // USART_2
+#define MB_RS232_PORT                                           1               // USART_3
+#define MB_STATISTICS_FUNCTIONS_NUMBER                          11              // FC 1, 2, 3, 4, 5, 6, 8, 15, 16, 23 and the other codes
+#define MB_LATENCY_BUCKETS                                      12              // histogram of one time
+#define MB_LATENCY_FIRST_BUCKET_US                              32              // bucket 0 is < 32 us, every next one is twice wider, the last one is open
+
+// Counters of one function code
+typedef struct mbFunctionStatistics{
+    unsigned long requests;             // executed requests, broadcasts are not counted
+    unsigned long exceptions;           // exception responses
+    unsigned long turnaround[MB_LATENCY_BUCKETS];       // end of request frame - start of response transmission
+    unsigned long transmission[MB_LATENCY_BUCKETS];     // duration of response transmission
+}tMBFunctionStatistics;
+
+// Communication statistics of one serial port
+typedef struct slaveStatistics{
+    unsigned long framesReceived;       // all frames, regardless of the address
+    unsigned long crcErrors;            // frames for our slaves with bad CRC
+    unsigned long responsesSent;
+    unsigned long broadcastsReceived;   // requests for MB_BROADCAST_ADDRESS with valid CRC
+    unsigned long overruns;             // characters lost because the frame was longer than PACKET_SIZE
+    unsigned long slaveMessages;        // requests for our slaves and broadcasts with valid CRC
+    unsigned long exceptionsSent;
+    tMBFunctionStatistics functions[MB_STATISTICS_FUNCTIONS_NUMBER];
+}tMBSlaveStatistics;
+
+
+typedef enum
+{
+    EV_FRAME_RECEIVED,          /*!< Frame received. */
+    EV_EXECUTE,                 /*!< Execute function. */
+} eMBEventType;
+
+typedef enum
+{
+    STATE_RX_IDLE,              /*!< Receiver is in idle state. */
+    STATE_RX_RCV,               /*!< Frame is beeing received. */
+} eMBRcvState;
+
+typedef enum
+{
+    STATE_TX_IDLE,              /*!< Transmitter is in idle state. */
+    STATE_TX_XMIT               /*!< Transmitter is in transfer state. */
+} eMBSndState;
+
+typedef void (*tMBTimerEnable)(unsigned short miliseconds);
+typedef void (*tMBTimerDisable)(void);
+
+/*
+    One serial port served by the slave engine. Every port has its own frame buffers and state and all ports
+    share ModBusSlaves and their bindings. Requests are executed only in the ports' scheduler tasks, which run 
+    to completion, so a request - also multi-register write - is never interleaved with a request of other port.
+*/
+typedef struct mbSlavePort{
+    int usartID;                        // USART_2, USART_3
+    int timerID;                        // virtual timer of the transmission
+    int event;                          // scheduler event posted by the port's interrupts
+    tMBTimerEnable timerEnable;         // end of frame timer
+    tMBTimerDisable timerDisable;
+    
+    volatile unsigned short rcvBufferPos;
+    volatile unsigned short sndBufferPos;
+    unsigned short requestLength;       // length of the request being executed, with CRC
+    int activeSlaveIndex;
+    volatile eMBEventType queuedEvent;
+    volatile BOOL eventInQueue;
+    volatile eMBSndState sndState;
+    volatile eMBRcvState rcvState;
+    
+    unsigned long frameEndCycles;       // DWT cycle counter when the end of request frame was found
+    unsigned char functionIndex;        // statistics of the response being transmitted
+    tMBSlaveStatistics statistics;
+    unsigned char recieveBuffer[PACKET_SIZE];
+    unsigned char responseBuffer[RESPONSE_SIZE];
+}tMBSlavePort;
+
 
 void InitNewMBSlaveDevices(void);
 void ClearModBusSlaveMemory(unsigned char *pMemory, int size);
 void CopyModBusMemory(unsigned char *source, unsigned char *destination, unsigned short cellsNumber);
-BOOL MBSlaveAddressRecognition(unsigned char recieveAddress);
+BOOL MBSlaveAddressRecognition(tMBSlavePort *pPort, unsigned char recieveAddress);
+BOOL MBIsBroadcastFunction(unsigned char function);
+unsigned char MBCheckRequest(const unsigned char *pRequest, unsigned short requestLength);
+int MBComposeException(unsigned char *pResponse, const unsigned char *pRequest, unsigned char exception);
+
+// slave engine, the same for all ports
+void MBInitPort(tMBSlavePort *pPort, int portIndex, int usartID, int timerID, int event, tMBTimerEnable timerEnable, tMBTimerDisable timerDisable);
+void MBPollPort(tMBSlavePort *pPort);
+void MBPortReceiveFSM(tMBSlavePort *pPort);
+void MBPortTimerExpired(tMBSlavePort *pPort);
+void MBPortTransmit(tMBSlavePort *pPort);
+void MBExecuteBroadcast(tMBSlavePort *pPort);
+void MBHandleRequest(tMBSlavePort *pPort);
+const tMBSlaveStatistics *MBGetPortStatistics(int portIndex);
+int process_cmd1(tMBSlavePort *pPort);
+int process_cmd3(tMBSlavePort *pPort);
+int process_cmd2(tMBSlavePort *pPort);
+int process_cmd4(tMBSlavePort *pPort);
+int process_cmd5(tMBSlavePort *pPort);
+int process_cmd6(tMBSlavePort *pPort);
+int process_cmd15(tMBSlavePort *pPort);
+int process_cmd16(tMBSlavePort *pPort);
+int process_cmd23(tMBSlavePort *pPort);
 
+// ModBus port (USART_2)
 void MBInitHardwareAndProtocol(void);
 void MBPollSlave( void );
 void MBReceiveFSM( void );
-void MB_handle_request( void );
 void MBTimerExpired( void );
 void MB_slave_transmit( void );
-char process_cmd1(void);
-char process_cmd3(void);
-char process_cmd2(void);
-char process_cmd5(void);
-char process_cmd15(void);
-char process_cmd16(void);
+const tMBSlaveStatistics *GetMBSlaveStatistics(void);
 
 #endif
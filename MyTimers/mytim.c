@@ -1,12 +1,13 @@
 #include "stm32f4xx_conf.h"
 #include "mbslave.h"
 #include "rs232.h"
+#include "scheduler.h"
 #include "mytim.h"
 
 
-extern volatile u32 timerCounter = 1;
-
-//TIM2 is for VTimer library
+//TIM2 is for VTimer library. It is free-running 32 bits counter of milliseconds without update interrupts,
+//VTimers read TIM2->CNT directly and compare it wrap-safe.
+//Compare channel 1 is the wake alarm of the scheduler's sleep.
 void InitTIM2(void)
 {
     TIM_TimeBaseInitTypeDef TIM_2_TimeBaseInitStruct;
@@ -24,11 +25,11 @@ void InitTIM2(void)
    
     TIM_DeInit(TIM2);
     
-    //TIM_2 clock = 50, MHz / prescaler = 50 000 000 / 500 = 100 000, Hz
-    //time = TIM_2 period * (1 / TIM_2 clock) = 100 * (1 / 100 000) = 0.001, s
+    //TIM_2 clock = 50, MHz / prescaler = 50 000 000 / 50 000 = 1 000, Hz
+    //counter wraps after 2^32 * (1 / TIM_2 clock) = 49.7, days
        
-    TIM_2_TimeBaseInitStruct.TIM_Prescaler = 500;
-    TIM_2_TimeBaseInitStruct.TIM_Period = 100;
+    TIM_2_TimeBaseInitStruct.TIM_Prescaler = 50000;
+    TIM_2_TimeBaseInitStruct.TIM_Period = 0xFFFFFFFF;
     TIM_2_TimeBaseInitStruct.TIM_ClockDivision = TIM_CKD_DIV1; // 0
     TIM_2_TimeBaseInitStruct.TIM_CounterMode = TIM_CounterMode_Up;
     TIM_2_TimeBaseInitStruct.TIM_RepetitionCounter = 0;
@@ -36,16 +37,36 @@ void InitTIM2(void)
     TIM_TimeBaseInit(TIM2, &TIM_2_TimeBaseInitStruct);
     
     TIM_ClearFlag(TIM2, TIM_FLAG_Update);
-    TIM_ClearITPendingBit(TIM2, TIM_IT_Update);
+    TIM_ClearFlag(TIM2, TIM_FLAG_CC1);
+}
+
+//u32 counter - TIM2 counter value of the wake up, ms
+//returns FALSE if the counter has already reached it, the alarm would fire only after the wrap
+BOOL SetWakeAlarm(u32 counter)
+{
+    TIM_SetCompare1(TIM2, counter);
+    TIM_ClearITPendingBit(TIM2, TIM_IT_CC1);
+    TIM_ITConfig(TIM2, TIM_IT_CC1, ENABLE);
     
-    TIM_ITConfig(TIM2, TIM_IT_Update, ENABLE);
+    if((s32)(counter - TIM_GetCounter(TIM2)) <= 0)
+    {
+        TIM_ITConfig(TIM2, TIM_IT_CC1, DISABLE);
+        return FALSE;
+    }
+    
+    return TRUE;
 }
 
 void TIM2_IRQHandler(void)
 {
-    timerCounter = timerCounter + 1;
-    TIM_ClearFlag(TIM2, TIM_FLAG_Update);
-    TIM_ClearITPendingBit(TIM2, TIM_IT_Update);
+    if(TIM_GetITStatus(TIM2, TIM_IT_CC1) != RESET)
+    {
+        TIM_ITConfig(TIM2, TIM_IT_CC1, DISABLE);
+        TIM_ClearFlag(TIM2, TIM_FLAG_CC1);
+        TIM_ClearITPendingBit(TIM2, TIM_IT_CC1);
+        
+        PostEvent(EVENT_TIMER);
+    }
 }
 
 
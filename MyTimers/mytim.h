@@ -1,7 +1,10 @@
 #ifndef __MYTIM_H
 #define __MYTIM_H
 
+#include "definitions.h"
+
 void InitTIM2(void);
+BOOL SetWakeAlarm(u32 counter);
 void TIM2_IRQHandler(void);
 
 void InitTIM3(void);
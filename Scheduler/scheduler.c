@@ -0,0 +1,333 @@
+#include "stm32f4xx.h"
+#include "stm32f4xx_conf.h"
+#include "definitions.h"
+#include "VTimer.h"
+#include "mytim.h"
+#include "delay.h"
+#include "scheduler.h"
+
+// Tasks are kept sorted by priority, tasks with the same priority run in the order of registration
+static tTask Tasks[MAX_TASKS_NUMBER];
+static int TasksNumber;
+
+// One byte per event, so posting from an interrupt is a single store without read-modify-write
+static volatile unsigned char EventFlags[EVENTS_NUMBER];
+static volatile u32 EventPostCycles[EVENTS_NUMBER];     // cycle counter at the first post of a pending event
+
+static tSchedulerStatistics SchedulerStatistics;
+static u32 statisticsStartCycles;
+
+void InitScheduler(void)
+{
+    int i;
+    
+    TasksNumber = 0;
+    
+    for(i = 0; i < EVENTS_NUMBER; i++)
+    {
+        EventFlags[i] = FALSE;
+    }
+    
+    ClearTaskStatistics();
+}
+
+//const char *name - name for statistics, it is not copied
+//u32 period - ms, TASK_EVERY_PASS for background polling or TASK_NO_PERIOD for tasks run only on events
+//u32 events - EVENT_MASK(EVENT_MODBUS) | ..., or NO_EVENTS
+//unsigned char priority - TASK_PRIORITY_HIGH, TASK_PRIORITY_NORMAL, TASK_PRIORITY_LOW ...
+//returns FALSE if the task table is full
+BOOL RegisterTask(const char *name, tTaskFunction function, u32 period, u32 events, unsigned char priority)
+{
+    int i;
+    
+    if(TasksNumber >= MAX_TASKS_NUMBER)
+    {
+        return FALSE;
+    }
+    
+    // insert after all tasks with the same or higher priority
+    for(i = TasksNumber; i > 0 && Tasks[i - 1].priority > priority; i--)
+    {
+        Tasks[i] = Tasks[i - 1];
+    }
+    
+    Tasks[i].name = name;
+    Tasks[i].function = function;
+    Tasks[i].period = period;
+    Tasks[i].events = events;
+    Tasks[i].priority = priority;
+    Tasks[i].release = 0;
+    if(period != TASK_EVERY_PASS && period != TASK_NO_PERIOD)
+    {
+        Tasks[i].release = GetTimerCounter() + period;
+    }
+    Tasks[i].runs = 0;
+    Tasks[i].missedDeadlines = 0;
+    Tasks[i].lastCycles = 0;
+    Tasks[i].maxCycles = 0;
+    Tasks[i].totalCycles = 0;
+    Tasks[i].maxLateness = 0;
+    
+    TasksNumber++;
+    
+    return TRUE;
+}
+
+//Can be called from interrupts
+void PostEvent(int event)
+{
+    if(EventFlags[event] == FALSE)
+    {
+        EventPostCycles[event] = GetCycleCounter();
+    }
+    EventFlags[event] = TRUE;
+}
+
+static BOOL IsEventPending(void)
+{
+    int i;
+    
+    for(i = 0; i < EVENTS_NUMBER; i++)
+    {
+        if(EventFlags[i] == TRUE)
+        {
+            return TRUE;
+        }
+    }
+    
+    return FALSE;
+}
+
+// Take all pending events, an event posted after this is handled in the next pass
+static u32 TakeEvents(void)
+{
+    u32 events = 0;
+    u32 latency;
+    u32 now = GetCycleCounter();
+    int i;
+    
+    for(i = 0; i < EVENTS_NUMBER; i++)
+    {
+        if(EventFlags[i] == TRUE)
+        {
+            EventFlags[i] = FALSE;
+            events |= EVENT_MASK(i);
+            
+            latency = now - EventPostCycles[i];
+            SchedulerStatistics.lastLatency = latency;
+            if(latency > SchedulerStatistics.maxLatency)
+            {
+                SchedulerStatistics.maxLatency = latency;
+            }
+            SchedulerStatistics.totalLatency += latency;
+            SchedulerStatistics.events++;
+        }
+    }
+    
+    return events;
+}
+
+static void RunTask(tTask *pTask)
+{
+    u32 start = GetCycleCounter();
+    
+    pTask->function();
+    
+    pTask->lastCycles = GetCycleCounter() - start;
+    if(pTask->lastCycles > pTask->maxCycles)
+    {
+        pTask->maxCycles = pTask->lastCycles;
+    }
+    pTask->totalCycles += pTask->lastCycles;
+    pTask->runs++;
+}
+
+// Release a periodic task, returns TRUE if its period has come
+static BOOL ReleaseTask(tTask *pTask)
+{
+    u32 now = GetTimerCounter();
+    u32 lateness;
+    
+    if((s32)(now - pTask->release) < 0)
+    {
+        return FALSE;
+    }
+    
+    lateness = now - pTask->release;
+    if(lateness > pTask->maxLateness)
+    {
+        pTask->maxLateness = lateness;
+    }
+    
+    if(lateness >= pTask->period)
+    {
+        pTask->missedDeadlines += lateness / pTask->period;
+        pTask->release = now + pTask->period;
+    }
+    else
+    {
+        pTask->release += pTask->period;
+    }
+    
+    return TRUE;
+}
+
+// Ms to the nearest release of a periodic task or VTimer work, 0 if there is work now
+static u32 GetTicksToNextWork(void)
+{
+    u32 ticks = GetVTimerTicksToNextEvent();
+    u32 now = GetTimerCounter();
+    s32 remaining;
+    int i;
+    
+    for(i = 0; i < TasksNumber && ticks > 0; i++)
+    {
+        // tasks of every pass run on each wake up, event tasks wake up with their interrupts
+        if(Tasks[i].period == TASK_EVERY_PASS || Tasks[i].period == TASK_NO_PERIOD)
+        {
+            continue;
+        }
+        
+        remaining = (s32)(Tasks[i].release - now);
+        if(remaining <= 0)
+        {
+            ticks = 0;
+        }
+        else if((u32)remaining < ticks)
+        {
+            ticks = (u32)remaining;
+        }
+    }
+    
+    return ticks;
+}
+
+/*
+    Sleep in WFI until an interrupt posts an event or the wake alarm of the next work fires.
+    Interrupts are disabled around the last check, so an event posted just before WFI still wakes the core.
+    The cycle counter keeps running in Sleep mode, it measures the idle time.
+*/
+static void Sleep(void)
+{
+    u32 ticks = GetTicksToNextWork();
+    u32 start;
+    
+    if(ticks == 0)
+    {
+        return;
+    }
+    
+    __disable_irq();
+    
+    if(IsEventPending() == FALSE && SetWakeAlarm(GetTimerCounter() + ticks) == TRUE)
+    {
+        start = GetCycleCounter();
+        __WFI();
+        SchedulerStatistics.idleCycles += GetCycleCounter() - start;
+        SchedulerStatistics.sleeps++;
+    }
+    
+    __enable_irq();
+}
+
+/*
+    One pass of the main loop: run the tasks of every pass and every task which has a pending event or a released period,
+    in priority order, then sleep until the next interrupt if nothing is left to do.
+    A periodic task which starts after its next release has missed the deadline;
+    the skipped releases are counted and the task is released again one period from now.
+*/
+void RunScheduler(void)
+{
+    tTask *pTask;
+    u32 events;
+    BOOL isReleased;
+    int i;
+    
+    events = TakeEvents();
+    SchedulerStatistics.passes++;
+    
+    for(i = 0; i < TasksNumber; i++)
+    {
+        pTask = &Tasks[i];
+        
+        switch(pTask->period)
+        {
+        case TASK_EVERY_PASS:
+            isReleased = TRUE;
+            break;
+        case TASK_NO_PERIOD:
+            isReleased = FALSE;
+            break;
+        default:
+            isReleased = ReleaseTask(pTask);
+            break;
+        }
+        
+        if(isReleased == TRUE || (pTask->events & events) != 0)
+        {
+            RunTask(pTask);
+        }
+    }
+    
+    Sleep();
+    
+    SchedulerStatistics.totalCycles += GetCycleCounter() - statisticsStartCycles;
+    statisticsStartCycles = GetCycleCounter();
+}
+
+int GetTasksNumber(void)
+{
+    return TasksNumber;
+}
+
+//int taskIndex - 0 ... GetTasksNumber() - 1, tasks are in the order they run
+const tTask *GetTaskStatistics(int taskIndex)
+{
+    if(taskIndex < 0 || taskIndex >= TasksNumber)
+    {
+        return 0;
+    }
+    
+    return &Tasks[taskIndex];
+}
+
+const tSchedulerStatistics *GetSchedulerStatistics(void)
+{
+    return &SchedulerStatistics;
+}
+
+//Idle time in WFI, 1/1000 of the time since the statistics were cleared
+unsigned short GetIdlePermille(void)
+{
+    if(SchedulerStatistics.totalCycles == 0)
+    {
+        return 0;
+    }
+    
+    return (unsigned short)((SchedulerStatistics.idleCycles * 1000) / SchedulerStatistics.totalCycles);
+}
+
+void ClearTaskStatistics(void)
+{
+    int i;
+    
+    for(i = 0; i < TasksNumber; i++)
+    {
+        Tasks[i].runs = 0;
+        Tasks[i].missedDeadlines = 0;
+        Tasks[i].lastCycles = 0;
+        Tasks[i].maxCycles = 0;
+        Tasks[i].totalCycles = 0;
+        Tasks[i].maxLateness = 0;
+    }
+    
+    SchedulerStatistics.passes = 0;
+    SchedulerStatistics.sleeps = 0;
+    SchedulerStatistics.events = 0;
+    SchedulerStatistics.lastLatency = 0;
+    SchedulerStatistics.maxLatency = 0;
+    SchedulerStatistics.totalLatency = 0;
+    SchedulerStatistics.idleCycles = 0;
+    SchedulerStatistics.totalCycles = 0;
+    statisticsStartCycles = GetCycleCounter();
+}
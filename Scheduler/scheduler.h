@@ -0,0 +1,71 @@
+#ifndef __SCHEDULER_H
+#define __SCHEDULER_H
+
+#include "definitions.h"
+
+#define MAX_TASKS_NUMBER                        12
+#define TASK_EVERY_PASS                         0               // period of background tasks polled on each pass
+#define TASK_NO_PERIOD                          0xFFFFFFFFUL    // period of tasks run only on their events
+#define NO_EVENTS                               0
+
+// Priorities, lower value runs first in a scheduler pass
+#define TASK_PRIORITY_HIGH                      0
+#define TASK_PRIORITY_NORMAL                    1
+#define TASK_PRIORITY_LOW                       2
+
+// Events posted by interrupts
+#define EVENT_MODBUS                            0               // ModBus frame received or request queued
+#define EVENT_RS232                             1               // RS232 frame received or request queued
+#define EVENT_TIMER                             2               // TIM2 wake alarm
+#define EVENT_OUTPUTS_STAGED                    3               // outputs wait for the next I/O scan
+#define EVENTS_NUMBER                           4
+#define EVENT_MASK(EVENT)                       (1UL << (EVENT))
+
+typedef void (*tTaskFunction)(void);
+
+/*
+    Cooperative run-to-completion task. A TASK_EVERY_PASS task runs on every scheduler pass, it does not keep
+    the core awake. Other tasks run when one of their events is pending or when their period is released;
+    a TASK_NO_PERIOD task runs only on its events.
+    Periodic tasks must start before the next release, otherwise the release is counted as a missed deadline.
+*/
+typedef struct taskStructure{
+    const char *name;
+    tTaskFunction function;
+    u32 period;                         // ms, TASK_EVERY_PASS / TASK_NO_PERIOD
+    u32 events;                         // EVENT_MASK() of the events the task waits for
+    unsigned char priority;
+    u32 release;                        // timer counter of the next release, ms
+    
+    // statistics
+    unsigned long runs;
+    unsigned long missedDeadlines;
+    u32 lastCycles;                     // execution time of the last run, DWT cycles
+    u32 maxCycles;
+    unsigned long long totalCycles;
+    u32 maxLateness;                    // the worst start delay after the release, ms
+}tTask;
+
+// Sleep and event statistics, DWT cycles
+typedef struct schedulerStatistics{
+    unsigned long passes;
+    unsigned long sleeps;
+    unsigned long events;               // handled events
+    u32 lastLatency;                    // from the first post of an event to the start of the pass handling it
+    u32 maxLatency;
+    unsigned long long totalLatency;
+    unsigned long long idleCycles;      // time in WFI
+    unsigned long long totalCycles;     // time since the statistics were cleared
+}tSchedulerStatistics;
+
+void InitScheduler(void);
+BOOL RegisterTask(const char *name, tTaskFunction function, u32 period, u32 events, unsigned char priority);
+void RunScheduler(void);
+void PostEvent(int event);
+int GetTasksNumber(void);
+const tTask *GetTaskStatistics(int taskIndex);
+const tSchedulerStatistics *GetSchedulerStatistics(void);
+unsigned short GetIdlePermille(void);
+void ClearTaskStatistics(void);
+
+#endif
@@ -0,0 +1,69 @@
+#include <string.h>
+#include "stm32f4xx.h"
+#include "definitions.h"
+#include "snapshot.h"
+
+/*
+    Initialize snapshot
+
+    tSnapshot *pSnapshot - snapshot to be initialized
+    void *buffers - storage for the two copies, it must be at least 2 * size bytes long
+    unsigned short size - size of the published data block in bytes
+*/
+void InitSnapshot(tSnapshot *pSnapshot, void *buffers, unsigned short size)
+{
+    pSnapshot->sequence = 0;
+    pSnapshot->buffers = (unsigned char *)buffers;
+    pSnapshot->size = size;
+    
+    memset(pSnapshot->buffers, 0, 2 * size);
+}
+
+/*
+    Publish new data block. Only one producer (usually an ISR) may call this function for given snapshot.
+
+    const void *data - data block with size bytes, given in InitSnapshot()
+*/
+void PublishSnapshot(tSnapshot *pSnapshot, const void *data)
+{
+    // readers switch to copy 1 while copy 0 is rewritten
+    pSnapshot->sequence++;
+    __DMB();
+    memcpy(pSnapshot->buffers, data, pSnapshot->size);
+    __DMB();
+    
+    // readers switch to copy 0 while copy 1 is rewritten
+    pSnapshot->sequence++;
+    __DMB();
+    memcpy(pSnapshot->buffers + pSnapshot->size, data, pSnapshot->size);
+    __DMB();
+}
+
+/*
+    Copy the last published data block in destination. The function never waits for the producer - 
+    it repeats the copy only if the producer has published new data in the meantime.
+
+    void *destination - buffer with size bytes, given in InitSnapshot()
+*/
+void ReadSnapshot(tSnapshot *pSnapshot, void *destination)
+{
+    u32 sequence;
+    
+    do
+    {
+        sequence = pSnapshot->sequence;
+        __DMB();
+        memcpy(destination, pSnapshot->buffers + (sequence & 0x01) * pSnapshot->size, pSnapshot->size);
+        __DMB();
+    }
+    while(sequence != pSnapshot->sequence);
+}
+
+/*
+    Returns counter which changes every time when new data is published.
+    Consumers may compare it with previous value and skip reading when nothing is changed.
+*/
+u32 GetSnapshotVersion(tSnapshot *pSnapshot)
+{
+    return pSnapshot->sequence >> 1;
+}
@@ -0,0 +1,27 @@
+#ifndef __SNAPSHOT_H
+#define __SNAPSHOT_H
+
+#include "definitions.h"
+
+/*
+    Double-buffered sequence lock (latch). One producer publishes a data block, any number of
+    consumers read a consistent copy of it without waiting for the producer and without
+    disabling interrupts.
+
+    The producer writes both copies one after another, and the sequence counter tells the
+    consumer which copy is stable at the moment: even - copy 0, odd - copy 1.
+    A consumer interrupted by the producer simply retries; a consumer which interrupts
+    the producer always finds the other copy complete.
+*/
+typedef struct snapshotStructure{
+    volatile u32 sequence;              // incremented before each copy is rewritten
+    unsigned char *buffers;             // storage for 2 copies of the data block
+    unsigned short size;                // size of one copy in bytes
+}tSnapshot;
+
+void InitSnapshot(tSnapshot *pSnapshot, void *buffers, unsigned short size);
+void PublishSnapshot(tSnapshot *pSnapshot, const void *data);
+void ReadSnapshot(tSnapshot *pSnapshot, void *destination);
+u32 GetSnapshotVersion(tSnapshot *pSnapshot);
+
+#endif
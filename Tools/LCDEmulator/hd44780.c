@@ -0,0 +1,341 @@
+/*
+    HD44780 model for host builds. It decodes the pin level protocol, keeps DDRAM/CGRAM contents
+    and checks the interface and execution timings against the datasheet.
+*/
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include "hd44780.h"
+
+// instructions
+#define HD_CLEARDISPLAY         0x01
+#define HD_RETURNHOME           0x02
+#define HD_ENTRYMODESET         0x04
+#define HD_DISPLAYCONTROL       0x08
+#define HD_CURSORSHIFT          0x10
+#define HD_FUNCTIONSET          0x20
+#define HD_SETCGRAMADDR         0x40
+#define HD_SETDDRAMADDR         0x80
+
+#define HD_ENTRY_INCREMENT      0x02
+#define HD_FUNCTION_8BIT        0x10
+#define HD_FUNCTION_2LINES      0x08
+
+static void Violation(tHD44780 *pLCD, const char *constraint, uint64_t actual, uint64_t required)
+{
+    pLCD->violations++;
+    
+    if(pLCD->violations <= HD44780_MAX_REPORTED_VIOLATIONS)
+    {
+        printf("  timing violation at %llu ns: %s is %llu ns, required %llu ns\n",
+               (unsigned long long)pLCD->now, constraint, (unsigned long long)actual, (unsigned long long)required);
+    }
+}
+
+// Address counter moves inside 0x00 - 0x27 and 0x40 - 0x67 in 2 lines mode, inside 0x00 - 0x4F in 1 line mode
+static void MoveAddressCounter(tHD44780 *pLCD)
+{
+    int increment = (pLCD->entryMode & HD_ENTRY_INCREMENT) ? 1 : -1;
+    
+    if(pLCD->isCGRAMSelected)
+    {
+        pLCD->addressCounter = (pLCD->addressCounter + increment) & (HD44780_CGRAM_SIZE - 1);
+    }
+    else if(pLCD->isTwoLines)
+    {
+        if(increment > 0)
+        {
+            if(pLCD->addressCounter == 0x27)
+            {
+                pLCD->addressCounter = 0x40;
+            }
+            else if(pLCD->addressCounter == 0x67)
+            {
+                pLCD->addressCounter = 0x00;
+            }
+            else
+            {
+                pLCD->addressCounter++;
+            }
+        }
+        else
+        {
+            if(pLCD->addressCounter == 0x40)
+            {
+                pLCD->addressCounter = 0x27;
+            }
+            else if(pLCD->addressCounter == 0x00)
+            {
+                pLCD->addressCounter = 0x67;
+            }
+            else
+            {
+                pLCD->addressCounter--;
+            }
+        }
+    }
+    else
+    {
+        pLCD->addressCounter = (pLCD->addressCounter + 0x50 + increment) % 0x50;
+    }
+}
+
+static void ExecuteInstruction(tHD44780 *pLCD, uint8_t instruction)
+{
+    uint64_t executionTime = HD44780_T_INSTRUCTION;
+    
+    pLCD->instructions++;
+    
+    if(instruction & HD_SETDDRAMADDR)
+    {
+        pLCD->addressCounter = instruction & 0x7F;
+        pLCD->isCGRAMSelected = 0;
+    }
+    else if(instruction & HD_SETCGRAMADDR)
+    {
+        pLCD->addressCounter = instruction & 0x3F;
+        pLCD->isCGRAMSelected = 1;
+    }
+    else if(instruction & HD_FUNCTIONSET)
+    {
+        pLCD->functionSetCount++;
+        if(pLCD->functionSetCount == 1)
+        {
+            executionTime = HD44780_T_FIRST_FUNCTION_SET;
+        }
+        else if(pLCD->functionSetCount == 2)
+        {
+            executionTime = HD44780_T_SECOND_FUNCTION_SET;
+        }
+        
+        pLCD->is4BitMode = (instruction & HD_FUNCTION_8BIT) ? 0 : 1;
+        pLCD->isTwoLines = (instruction & HD_FUNCTION_2LINES) ? 1 : 0;
+    }
+    else if(instruction & HD_CURSORSHIFT)
+    {
+        // display shift is not modeled, only the cursor moves
+    }
+    else if(instruction & HD_DISPLAYCONTROL)
+    {
+        pLCD->displayControl = instruction & 0x07;
+    }
+    else if(instruction & HD_ENTRYMODESET)
+    {
+        pLCD->entryMode = instruction & 0x03;
+    }
+    else if(instruction & HD_RETURNHOME)
+    {
+        pLCD->addressCounter = 0;
+        pLCD->isCGRAMSelected = 0;
+        executionTime = HD44780_T_CLEAR_HOME;
+    }
+    else if(instruction & HD_CLEARDISPLAY)
+    {
+        memset(pLCD->ddram, ' ', HD44780_DDRAM_SIZE);
+        pLCD->addressCounter = 0;
+        pLCD->isCGRAMSelected = 0;
+        pLCD->entryMode |= HD_ENTRY_INCREMENT;
+        executionTime = HD44780_T_CLEAR_HOME;
+    }
+    
+    pLCD->busyUntil = pLCD->now + executionTime;
+}
+
+static void WriteData(tHD44780 *pLCD, uint8_t value)
+{
+    pLCD->dataWrites++;
+    
+    if(pLCD->isCGRAMSelected)
+    {
+        pLCD->cgram[pLCD->addressCounter] = value & 0x1F;
+    }
+    else
+    {
+        pLCD->ddram[pLCD->addressCounter & (HD44780_DDRAM_SIZE - 1)] = value;
+    }
+    
+    MoveAddressCounter(pLCD);
+    
+    pLCD->busyUntil = pLCD->now + HD44780_T_DATA_WRITE;
+}
+
+// Data is latched on the falling edge of E
+static void Latch(tHD44780 *pLCD)
+{
+    uint8_t value;
+    
+    if(pLCD->is4BitMode)
+    {
+        if(!pLCD->isHighNibbleLatched)
+        {
+            pLCD->highNibble = pLCD->data & 0x0F;
+            pLCD->isHighNibbleLatched = 1;
+            return;
+        }
+        
+        value = (pLCD->highNibble << 4) | (pLCD->data & 0x0F);
+        pLCD->isHighNibbleLatched = 0;
+    }
+    else
+    {
+        // DB3..DB0 are not connected and they are read as 0
+        value = (pLCD->data & 0x0F) << 4;
+    }
+    
+    if(pLCD->rs)
+    {
+        WriteData(pLCD, value);
+    }
+    else
+    {
+        ExecuteInstruction(pLCD, value);
+    }
+}
+
+void HD44780PowerOn(tHD44780 *pLCD, uint64_t pinWriteTime)
+{
+    memset(pLCD, 0, sizeof(tHD44780));
+    memset(pLCD->ddram, ' ', HD44780_DDRAM_SIZE);
+    
+    // after power on the controller is in 8 bits mode, 1 line, increment
+    pLCD->entryMode = HD_ENTRY_INCREMENT;
+    pLCD->busyUntil = HD44780_T_POWER_ON;
+    pLCD->pinWriteTime = pinWriteTime;
+}
+
+void HD44780SetRS(tHD44780 *pLCD, uint8_t level)
+{
+    pLCD->now += pLCD->pinWriteTime;
+    
+    if(level == pLCD->rs)
+    {
+        return;
+    }
+    
+    if(pLCD->now - pLCD->eFallTime < HD44780_T_AH && pLCD->enablePulses > 0)
+    {
+        Violation(pLCD, "RS hold time (tAH)", pLCD->now - pLCD->eFallTime, HD44780_T_AH);
+    }
+    if(pLCD->e)
+    {
+        Violation(pLCD, "RS changed while E is high", 0, 0);
+    }
+    
+    pLCD->rs = level;
+    pLCD->rsChangeTime = pLCD->now;
+}
+
+void HD44780SetDataLine(tHD44780 *pLCD, int line, uint8_t level)
+{
+    uint8_t data;
+    
+    pLCD->now += pLCD->pinWriteTime;
+    
+    data = level ? (pLCD->data | (1 << line)) : (pLCD->data & ~(1 << line));
+    if(data == pLCD->data)
+    {
+        return;
+    }
+    
+    if(pLCD->now - pLCD->eFallTime < HD44780_T_H && pLCD->enablePulses > 0)
+    {
+        Violation(pLCD, "data hold time (tH)", pLCD->now - pLCD->eFallTime, HD44780_T_H);
+    }
+    
+    pLCD->data = data;
+    pLCD->dataChangeTime = pLCD->now;
+}
+
+void HD44780SetE(tHD44780 *pLCD, uint8_t level)
+{
+    pLCD->now += pLCD->pinWriteTime;
+    
+    if(level == pLCD->e)
+    {
+        return;
+    }
+    
+    if(level)
+    {
+        // rising edge
+        if(pLCD->enablePulses > 0 && pLCD->now - pLCD->eRiseTime < HD44780_T_CYCLE_E)
+        {
+            Violation(pLCD, "enable cycle time (tcycE)", pLCD->now - pLCD->eRiseTime, HD44780_T_CYCLE_E);
+        }
+        if(pLCD->now - pLCD->rsChangeTime < HD44780_T_AS)
+        {
+            Violation(pLCD, "RS set-up time (tAS)", pLCD->now - pLCD->rsChangeTime, HD44780_T_AS);
+        }
+        if(pLCD->now < pLCD->busyUntil)
+        {
+            Violation(pLCD, "controller is busy, remaining execution time", pLCD->busyUntil - pLCD->now, 0);
+        }
+        
+        pLCD->eRiseTime = pLCD->now;
+    }
+    else
+    {
+        // falling edge
+        if(pLCD->now - pLCD->eRiseTime < HD44780_T_PW_EH)
+        {
+            Violation(pLCD, "enable pulse width (PWEH)", pLCD->now - pLCD->eRiseTime, HD44780_T_PW_EH);
+        }
+        if(pLCD->now - pLCD->dataChangeTime < HD44780_T_DSW)
+        {
+            Violation(pLCD, "data set-up time (tDSW)", pLCD->now - pLCD->dataChangeTime, HD44780_T_DSW);
+        }
+        
+        pLCD->eFallTime = pLCD->now;
+        pLCD->enablePulses++;
+        
+        Latch(pLCD);
+    }
+    
+    pLCD->e = level;
+}
+
+void HD44780Delay(tHD44780 *pLCD, uint64_t nanoseconds)
+{
+    pLCD->now += nanoseconds;
+}
+
+/*
+    Get text of one row of 20x4 or 16x4 display. Characters from CGRAM are shown as '0' - '7'.
+
+    char *text - buffer with at least columns + 1 bytes
+*/
+void HD44780GetRow(tHD44780 *pLCD, int row, int columns, char *text)
+{
+    static const uint8_t rowOffsets[4] = {0x00, 0x40, 0x14, 0x54};
+    uint8_t character;
+    int i;
+    
+    for(i = 0; i < columns; i++)
+    {
+        character = pLCD->ddram[(rowOffsets[row & 0x03] + i) & (HD44780_DDRAM_SIZE - 1)];
+        
+        if(character < 0x10)
+        {
+            text[i] = '0' + (character & 0x07);
+        }
+        else
+        {
+            text[i] = (char)character;
+        }
+    }
+    text[columns] = '\0';
+}
+
+void HD44780Print(tHD44780 *pLCD, FILE *stream)
+{
+    char text[21];
+    int row;
+    
+    fprintf(stream, "  +--------------------+\n");
+    for(row = 0; row < 4; row++)
+    {
+        HD44780GetRow(pLCD, row, 20, text);
+        fprintf(stream, "  |%s|\n", text);
+    }
+    fprintf(stream, "  +--------------------+\n");
+}
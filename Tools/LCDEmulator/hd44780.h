@@ -0,0 +1,70 @@
+#ifndef __HD44780_H
+#define __HD44780_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+// HD44780U timing, VCC = 2.7 to 4.5 V column of the datasheet, ns
+#define HD44780_T_CYCLE_E                       1000            // enable cycle time
+#define HD44780_T_PW_EH                         450             // enable pulse width (high level)
+#define HD44780_T_AS                            60              // address (RS) set-up time
+#define HD44780_T_AH                            20              // address (RS) hold time
+#define HD44780_T_DSW                           195             // data set-up time
+#define HD44780_T_H                             10              // data hold time
+
+// execution times at fosc = 270 kHz, ns
+#define HD44780_T_POWER_ON                      40000000        // after VCC rises to 2.7 V
+#define HD44780_T_FIRST_FUNCTION_SET            4100000         // first function set of the init sequence
+#define HD44780_T_SECOND_FUNCTION_SET           100000          // second function set of the init sequence
+#define HD44780_T_CLEAR_HOME                    1520000         // clear display and return home
+#define HD44780_T_INSTRUCTION                   37000           // all other instructions
+#define HD44780_T_DATA_WRITE                    41000           // write data to RAM: 37 us + tADD 4 us
+
+#define HD44780_DDRAM_SIZE                      0x80
+#define HD44780_CGRAM_SIZE                      0x40
+#define HD44780_MAX_REPORTED_VIOLATIONS         20
+
+typedef struct hd44780Structure{
+    // interface lines
+    uint8_t rs;
+    uint8_t e;
+    uint8_t data;                               // DB7..DB4 in bits 3..0, DB3..DB0 are not connected
+    
+    // controller's registers and memory
+    uint8_t ddram[HD44780_DDRAM_SIZE];
+    uint8_t cgram[HD44780_CGRAM_SIZE];
+    uint8_t addressCounter;
+    uint8_t isCGRAMSelected;
+    uint8_t is4BitMode;
+    uint8_t isTwoLines;
+    uint8_t entryMode;
+    uint8_t displayControl;
+    uint8_t highNibble;
+    uint8_t isHighNibbleLatched;
+    int functionSetCount;                       // function sets since power on, for the init sequence timing
+    
+    // timing, ns from power on
+    uint64_t now;
+    uint64_t busyUntil;
+    uint64_t eRiseTime;
+    uint64_t eFallTime;
+    uint64_t rsChangeTime;
+    uint64_t dataChangeTime;
+    uint64_t pinWriteTime;                      // time spent for one digitalWrite()
+    
+    // statistics
+    unsigned long enablePulses;
+    unsigned long instructions;
+    unsigned long dataWrites;
+    unsigned long violations;
+}tHD44780;
+
+void HD44780PowerOn(tHD44780 *pLCD, uint64_t pinWriteTime);
+void HD44780SetRS(tHD44780 *pLCD, uint8_t level);
+void HD44780SetE(tHD44780 *pLCD, uint8_t level);
+void HD44780SetDataLine(tHD44780 *pLCD, int line, uint8_t level);
+void HD44780Delay(tHD44780 *pLCD, uint64_t nanoseconds);
+void HD44780GetRow(tHD44780 *pLCD, int row, int columns, char *text);
+void HD44780Print(tHD44780 *pLCD, FILE *stream);
+
+#endif
@@ -0,0 +1,16 @@
+/*
+    Host replacement of the device header - only the types needed by the display protocol code.
+*/
+#ifndef __HOST_STM32F4XX_H
+#define __HOST_STM32F4XX_H
+
+#include <stdint.h>
+
+typedef uint32_t u32;
+typedef uint16_t u16;
+typedef uint8_t u8;
+typedef int32_t s32;
+typedef int16_t s16;
+typedef int8_t s8;
+
+#endif
@@ -0,0 +1,188 @@
+/*
+    Host benchmark of the LCD driver. Display/LCD.c is linked against the HD44780 model instead of
+    LCDport.c, every digitalWrite() costs PIN_WRITE_TIME_NS of virtual time and delayMicroseconds()
+    only advances the virtual clock, so the result is the bus time the driver spends on the real display.
+    
+    Build and run from the repository root:
+    gcc -std=gnu99 -Wall -I Tools/LCDEmulator/host -I Tools/LCDEmulator -I Display -I Definitions -I Controller -I VTimers -o lcdbench Tools/LCDEmulator/hd44780.c Tools/LCDEmulator/lcdBenchmark.c Display/LCD.c
+    ./lcdbench
+    
+    Exit code is 1 if any timing violation was found or the display content is wrong.
+*/
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include "stm32f4xx.h"
+#include "LCD.h"
+#include "hd44780.h"
+#include "controllerDisplay.h"
+
+#define PIN_WRITE_TIME_NS                       20              // one BSRR write at 100 MHz with call overhead
+
+static tHD44780 Display;
+
+// Stubs for the firmware symbols used by LCD.c
+uint32_t SystemCoreClock = 100000000;
+
+void SetVTimerValue(int timerID, u32 ticks)
+{
+}
+
+// Pin level functions of the host build, LCD.c uses them instead of LCDport.c
+void pinMode(LCD_TypeDef pin, uint8_t mode)
+{
+}
+
+void digitalWrite(LCD_TypeDef pin, uint8_t mode)
+{
+    switch(pin)
+    {
+    case B0:
+    case B1:
+    case B2:
+    case B3:
+        HD44780SetDataLine(&Display, pin - B0, mode);
+        break;
+    case Enb:
+        HD44780SetE(&Display, mode);
+        break;
+    case RS:
+        HD44780SetRS(&Display, mode);
+        break;
+    default:
+        break;
+    }
+}
+
+void delayMicroseconds(unsigned long mksec)
+{
+    HD44780Delay(&Display, (uint64_t)mksec * 1000);
+}
+
+typedef struct benchmarkResultStructure{
+    uint64_t busTime;
+    unsigned long enablePulses;
+    unsigned long violations;
+}tBenchmarkResult;
+
+static void StartMeasurement(tBenchmarkResult *pResult)
+{
+    pResult->busTime = Display.now;
+    pResult->enablePulses = Display.enablePulses;
+    pResult->violations = Display.violations;
+}
+
+static void StopMeasurement(const char *name, tBenchmarkResult *pResult)
+{
+    pResult->busTime = Display.now - pResult->busTime;
+    pResult->enablePulses = Display.enablePulses - pResult->enablePulses;
+    pResult->violations = Display.violations - pResult->violations;
+    
+    printf("%-28s %12.1f us %8lu E pulses %6lu violations\n", name, pResult->busTime / 1000.0,
+           pResult->enablePulses, pResult->violations);
+}
+
+static int CheckRow(int row, const char *expected)
+{
+    char text[21];
+    
+    HD44780GetRow(&Display, row, 20, text);
+    if(strcmp(text, expected) != 0)
+    {
+        printf("  row %d is \"%s\", expected \"%s\"\n", row + 1, text, expected);
+        return 1;
+    }
+    
+    return 0;
+}
+
+int main(void)
+{
+    // Screen buffer is in DDRAM order: row 1, row 3, row 2, row 4
+    char screen[81] = "Level:    52.3 %    "
+                      "Output:   47.1 %    "
+                      "Setpoint: 50.0 %    "
+                      "Mode:     AUTO      ";
+    uint8_t glyphs[8][8];
+    tBenchmarkResult result;
+    int errors = 0;
+    int i, j;
+    
+    for(i = 0; i < 8; i++)
+    {
+        for(j = 0; j < 8; j++)
+        {
+            glyphs[i][j] = (j >= 7 - i) ? 0x1F : 0x00;
+        }
+    }
+    
+    HD44780PowerOn(&Display, PIN_WRITE_TIME_NS);
+    
+    printf("LCD driver bus time, pin write %d ns\n", PIN_WRITE_TIME_NS);
+    
+    // LCD.c waits for the power on time by itself
+    StartMeasurement(&result);
+    InitLCD();
+    StopMeasurement("InitLCD (with greeting)", &result);
+    
+    StartMeasurement(&result);
+    LCDclear();
+    StopMeasurement("LCDclear", &result);
+    
+    StartMeasurement(&result);
+    LCDhome();
+    StopMeasurement("LCDhome", &result);
+    
+    StartMeasurement(&result);
+    LCDprint(screen);
+    StopMeasurement("LCDprint 80 chars", &result);
+    
+    StartMeasurement(&result);
+    LCDhome();
+    LCDprint(screen);
+    StopMeasurement("screen update", &result);
+    
+    // the display task draws the screen in parts of DISPLAY_CHARS_PER_RUN characters
+    StartMeasurement(&result);
+    LCDsetCursor(0, 0);
+    LCDStrWrite((const uint8_t *)screen, DISPLAY_CHARS_PER_RUN);
+    StopMeasurement("display task part", &result);
+    
+    StartMeasurement(&result);
+    for(i = 0; i < 8; i++)
+    {
+        LCDupdateChar(i, glyphs[i]);
+    }
+    StopMeasurement("8 glyphs, first upload", &result);
+    
+    StartMeasurement(&result);
+    for(i = 0; i < 8; i++)
+    {
+        LCDupdateChar(i, glyphs[i]);
+    }
+    StopMeasurement("8 glyphs, cached", &result);
+    
+    // let the last instruction finish before the content check
+    HD44780Delay(&Display, HD44780_T_CLEAR_HOME);
+    
+    HD44780Print(&Display, stdout);
+    
+    errors += CheckRow(0, "Level:    52.3 %    ");
+    errors += CheckRow(1, "Setpoint: 50.0 %    ");
+    errors += CheckRow(2, "Output:   47.1 %    ");
+    errors += CheckRow(3, "Mode:     AUTO      ");
+    
+    for(i = 0; i < 8; i++)
+    {
+        if(memcmp(&Display.cgram[i * 8], glyphs[i], 8) != 0)
+        {
+            printf("  CGRAM character %d is wrong\n", i);
+            errors++;
+        }
+    }
+    
+    printf("total: %lu instructions, %lu data writes, %lu violations, %d content errors\n",
+           Display.instructions, Display.dataWrites, Display.violations, errors);
+    
+    return (Display.violations == 0 && errors == 0) ? 0 : 1;
+}
@@ -0,0 +1,349 @@
+/*
+    Host test of the broadcast requests. The firmware's master (ModBusMaster/mbmaster.c, mbcache.c, mbtiming.c,
+    mbdecode.c) and slave engine (ModBusSlave/mbslave.c, mbbinding.c, mbdiagnostics.c, mbcrc.c) are linked unchanged
+    and connected by a loopback line: a query of the master goes byte by byte through the slave's receive interrupt,
+    the end of frame timer, two runs of the poll task and the transmit task, the response waits in the line until
+    the master reads it. The VTimers are a virtual millisecond clock which moves on every IsVTimerElapsed() call.
+
+    The master broadcasts FC 5, 6, 15 and 16 to address 0, the test checks that MBMaster() waits the turnaround
+    time without reading the line, that no slave responds and that the values are written in every slave.
+    Then other functions and malformed writes are sent to address 0, they must change nothing and get no response.
+
+    Build and run from the repository root:
+    gcc -std=gnu99 -O2 -Wall -I Tools/MBGateway/host -I ModBusMaster -I ModBusSlave -I Definitions -I Serial -I MyTimers -I Scheduler -I USART -I Delay -I VTimers -o broadcasttest Tools/MBGateway/broadcastTest.c ModBusMaster/mbmaster.c ModBusMaster/mbcache.c ModBusMaster/mbtiming.c ModBusMaster/mbdecode.c ModBusSlave/mbslave.c ModBusSlave/mbbinding.c ModBusSlave/mbdiagnostics.c ModBusSlave/mbcrc.c
+    ./broadcasttest
+
+    Exit code is 1 if any slave was not written, was written by an ignored request or responded to a broadcast.
+*/
+#include <stdio.h>
+#include <string.h>
+#include "stm32f4xx.h"
+#include "definitions.h"
+#include "mbslave.h"
+#include "mbbinding.h"
+#include "mbcrc.h"
+#include "mbmaster.h"
+#include "serial.h"
+#include "delay.h"
+#include "usart.h"
+#include "VTimer.h"
+
+#define TEST_LINE_SIZE                          512
+#define TEST_REQUEST_MAX_SIZE                   16              // without CRC
+#define TEST_COILS_NUMBER                       16              // coils 0 - 15 of every slave are compared
+#define TEST_COIL_BYTES                         (TEST_COILS_NUMBER / 8)
+#define TEST_REGISTERS_NUMBER                   HOLDING_REGISTERS_NUMBER
+
+// Request for address 0 which the slaves must ignore
+typedef struct ignoredRequest{
+    const char *name;
+    unsigned char request[TEST_REQUEST_MAX_SIZE];
+    int length;                         // bytes without CRC
+}tIgnoredRequest;
+
+static const tIgnoredRequest IgnoredRequests[] =
+{
+    {"FC 1 read coils", {0x00, 0x01, 0x00, 0x00, 0x00, 0x10}, 6},
+    {"FC 2 read inputs", {0x00, 0x02, 0x00, 0x00, 0x00, 0x10}, 6},
+    {"FC 3 read registers", {0x00, 0x03, 0x00, 0x00, 0x00, 0x02}, 6},
+    {"FC 4 read input registers", {0x00, 0x04, 0x00, 0x00, 0x00, 0x02}, 6},
+    {"FC 8 echo", {0x00, 0x08, 0x00, 0x00, 0x12, 0x34}, 6},
+    {"FC 8 clear counters", {0x00, 0x08, 0x00, 0x0A, 0x00, 0x00}, 6},
+    {"FC 23 read and write", {0x00, 0x17, 0x00, 0x00, 0x00, 0x01, 0x00, 0x14, 0x00, 0x01, 0x02, 0x55, 0x55}, 13},
+    {"FC 7 unknown", {0x00, 0x07}, 2},
+    {"FC 5 bad value", {0x00, 0x05, 0x00, 0x00, 0x12, 0x34}, 6},
+    {"FC 6 past registers", {0x00, 0x06, 0x00, 0x64, 0x55, 0x55}, 6},
+    {"FC 16 quantity 0", {0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00}, 7},
+    {"FC 16 byte count", {0x00, 0x10, 0x00, 0x00, 0x00, 0x02, 0x02, 0x55, 0x55}, 9},
+};
+#define IGNORED_REQUESTS_NUMBER                 (sizeof(IgnoredRequests) / sizeof(IgnoredRequests[0]))
+
+// Data of all slaves, compared before and after the ignored requests
+typedef struct slavesSnapshot{
+    unsigned char coils[MAX_MODBUS_SLAVE_DEVICES][TEST_COIL_BYTES];
+    unsigned short registers[MAX_MODBUS_SLAVE_DEVICES][TEST_REGISTERS_NUMBER];
+}tSlavesSnapshot;
+
+extern unsigned char QueryBuffer[QUERY_MAX_SIZE];
+extern int MBMasterQueryBufferLenght;
+
+static unsigned char ReceivedByte;
+static unsigned char Line[TEST_LINE_SIZE];                     // responses of the slave for the master
+static int LineHead, LineTail;
+static unsigned long SlaveResponses;
+static unsigned long LineReads;
+static u32 Clock;
+static u32 MasterTimerExpiry;
+static int errors;
+
+// ..................Replacements of the firmware's drivers..........................
+
+unsigned char GetByte(int usartID)
+{
+    (void)usartID;
+    return ReceivedByte;
+}
+
+// Frame goes through the slave engine like in the scheduler
+static void SlaveReceive(const unsigned char *pFrame, int length)
+{
+    int i;
+    
+    for(i = 0; i < length; i++)
+    {
+        ReceivedByte = pFrame[i];
+        MBReceiveFSM();
+    }
+    
+    MBTimerExpired();
+    MBPollSlave();
+    MBPollSlave();
+    MB_slave_transmit();
+}
+
+int OutString(unsigned char *Str, int len, int usartID, int timerType, int miliseconds)
+{
+    (void)usartID; (void)miliseconds;
+    
+    if(timerType == MB_MASTER_TIMER)
+    {
+        SlaveReceive(Str, len);
+        return len;
+    }
+    
+    SlaveResponses++;
+    if(LineTail + len > TEST_LINE_SIZE)
+    {
+        return 0;
+    }
+    memcpy(&Line[LineTail], Str, len);
+    LineTail += len;
+    return len;
+}
+
+BOOL recieveByteMyUSART(int usartID, unsigned char *pByte)
+{
+    (void)usartID;
+    
+    LineReads++;
+    if(LineHead == LineTail)
+    {
+        return FALSE;
+    }
+    *pByte = Line[LineHead++];
+    return TRUE;
+}
+
+void SetVTimerValue(int timerID, u32 ticks)
+{
+    if(timerID == MB_MASTER_TIMER)
+    {
+        MasterTimerExpiry = Clock + ticks;
+    }
+}
+
+int IsVTimerElapsed(int timerID)
+{
+    Clock++;
+    if(timerID != MB_MASTER_TIMER)
+    {
+        return ELAPSED;
+    }
+    return ((s32)(Clock - MasterTimerExpiry) >= 0) ? ELAPSED : NOT_ELAPSED;
+}
+
+u32 GetTimerCounter(void) { return Clock; }
+void InitUSART2(int modBusUnitType) { (void)modBusUnitType; }
+void InitTIM3(void) { }
+void ModBusTimerEnable(unsigned short miliseconds) { (void)miliseconds; }
+void ModBusTimerDisable(void) { }
+void PostEvent(int event) { (void)event; }
+u32 GetCycleCounter(void) { return 0; }
+u32 CyclesToMicroseconds(u32 cycles) { return cycles / 100; }
+
+// .................................Checks...........................................
+
+static void TakeSnapshot(tSlavesSnapshot *pSnapshot)
+{
+    int i;
+    
+    memset(pSnapshot, 0, sizeof(*pSnapshot));
+    for(i = 0; i < MAX_MODBUS_SLAVE_DEVICES; i++)
+    {
+        MBReadCoils(i, 0, TEST_COILS_NUMBER, pSnapshot->coils[i]);
+        MBReadHoldingRegisters(i, 0, TEST_REGISTERS_NUMBER, pSnapshot->registers[i]);
+    }
+}
+
+/*
+    Send the composed broadcast query by MBMaster(), it must only wait the turnaround time
+    const char *name - printed with the errors
+*/
+static void MasterBroadcast(const char *name)
+{
+    unsigned long reads = LineReads, responses = SlaveResponses;
+    u32 start = Clock;
+    int result;
+    
+    result = MBMaster();
+    if(result != 0)
+    {
+        printf("%-28s MBMaster() returns %d\n", name, result);
+        errors++;
+    }
+    if(LineReads != reads || SlaveResponses != responses)
+    {
+        printf("%-28s %lu responses, master read the line %lu times\n", name, SlaveResponses - responses, LineReads - reads);
+        errors++;
+    }
+    if(Clock - start < BROADCAST_TURNAROUND_TIME)
+    {
+        printf("%-28s master waited %lu ms, turnaround is %d ms\n", name, (unsigned long)(Clock - start), BROADCAST_TURNAROUND_TIME);
+        errors++;
+    }
+}
+
+// FC 6 has no compose function in the master, the query is put in its buffer
+static void PresetSingleRegister(unsigned char slaveID, unsigned char address, unsigned short value)
+{
+    unsigned int crc;
+    
+    QueryBuffer[0] = slaveID;
+    QueryBuffer[1] = 6;
+    QueryBuffer[2] = 0;
+    QueryBuffer[3] = address;
+    QueryBuffer[4] = (unsigned char)(value >> 8);
+    QueryBuffer[5] = (unsigned char)value;
+    
+    crc = usMBCRC16(QueryBuffer, 6);
+    QueryBuffer[6] = (unsigned char)crc;
+    QueryBuffer[7] = (unsigned char)(crc >> 8);
+    
+    MBMasterQueryBufferLenght = 8;
+}
+
+static void CheckCoils(const char *name, unsigned short start, unsigned short count, unsigned short expected)
+{
+    unsigned char bytes[TEST_COIL_BYTES];
+    unsigned short value;
+    int i;
+    
+    for(i = 0; i < MAX_MODBUS_SLAVE_DEVICES; i++)
+    {
+        memset(bytes, 0, sizeof(bytes));
+        MBReadCoils(i, start, count, bytes);
+        value = bytes[0] | ((unsigned short)bytes[1] << 8);
+        if(value != expected)
+        {
+            printf("%-28s slave %d coils 0x%04X, expected 0x%04X\n", name, i + 1, value, expected);
+            errors++;
+        }
+    }
+}
+
+static void CheckRegisters(const char *name, unsigned short start, unsigned short count, const unsigned short *pExpected)
+{
+    unsigned short values[TEST_REGISTERS_NUMBER];
+    int i;
+    
+    for(i = 0; i < MAX_MODBUS_SLAVE_DEVICES; i++)
+    {
+        MBReadHoldingRegisters(i, start, count, values);
+        if(memcmp(values, pExpected, count * sizeof(unsigned short)) != 0)
+        {
+            printf("%-28s slave %d registers %u - %u are not written\n", name, i + 1, start, start + count - 1);
+            errors++;
+        }
+    }
+}
+
+// Request for address 0 which must not change any slave nor get a response
+static void CheckIgnored(const tIgnoredRequest *pCase)
+{
+    tSlavesSnapshot before, after;
+    unsigned char frame[TEST_REQUEST_MAX_SIZE + 2];
+    unsigned long responses = SlaveResponses;
+    unsigned int crc;
+    
+    memcpy(frame, pCase->request, pCase->length);
+    crc = usMBCRC16(frame, pCase->length);
+    frame[pCase->length] = (unsigned char)crc;
+    frame[pCase->length + 1] = (unsigned char)(crc >> 8);
+    
+    TakeSnapshot(&before);
+    SlaveReceive(frame, pCase->length + 2);
+    TakeSnapshot(&after);
+    
+    if(SlaveResponses != responses)
+    {
+        printf("%-28s slave responded\n", pCase->name);
+        errors++;
+    }
+    if(memcmp(&before, &after, sizeof(before)) != 0)
+    {
+        printf("%-28s slave data changed\n", pCase->name);
+        errors++;
+    }
+}
+
+int main(void)
+{
+    static const unsigned short registers[] = {0x1234, 0xBEEF, 0x00FF};
+    unsigned short values[3];
+    const tMBSlaveStatistics *pStatistics;
+    unsigned long broadcasts;
+    int result;
+    int i;
+    
+    MBInitHardwareAndProtocol();
+    InitMBMaster();
+    
+    ForceSingleCoil(BROADCAST_SLAVE_ID, 3, 0xFF);
+    MasterBroadcast("FC 5 coil 3 on");
+    CheckCoils("FC 5 coil 3 on", 3, 1, 0x0001);
+    
+    ForceMultipleCoils(BROADCAST_SLAVE_ID, 4, 10, 0x02A5);
+    MasterBroadcast("FC 15 coils 4 - 13");
+    CheckCoils("FC 15 coils 4 - 13", 4, 10, 0x02A5);
+    CheckCoils("FC 15 coil 3 kept", 3, 1, 0x0001);
+    
+    PresetSingleRegister(BROADCAST_SLAVE_ID, 99, 0xA55A);
+    MasterBroadcast("FC 6 register 99");
+    values[0] = 0xA55A;
+    CheckRegisters("FC 6 register 99", 99, 1, values);
+    
+    PresetMultipleRegisters(BROADCAST_SLAVE_ID, 10, 3, (unsigned short *)registers);
+    MasterBroadcast("FC 16 registers 10 - 12");
+    CheckRegisters("FC 16 registers 10 - 12", 10, 3, registers);
+    
+    for(i = 0; i < IGNORED_REQUESTS_NUMBER; i++)
+    {
+        CheckIgnored(&IgnoredRequests[i]);
+    }
+    
+    // the slaves still answer their own address, the master reads the broadcast values
+    for(i = 1; i <= MAX_MODBUS_SLAVE_DEVICES; i++)
+    {
+        memset(values, 0, sizeof(values));
+        result = MBMasterRead(i, MB_TABLE_HOLDING_REGISTERS, 10, 3, 0, values);
+        if(result != 0 || memcmp(values, registers, sizeof(values)) != 0)
+        {
+            printf("slave %d read by master: result %d, 0x%04X 0x%04X 0x%04X\n", i, result, values[0], values[1], values[2]);
+            errors++;
+        }
+    }
+    
+    // FC 8 clear counters above was ignored too
+    broadcasts = 4 + IGNORED_REQUESTS_NUMBER;
+    pStatistics = GetMBSlaveStatistics();
+    if(pStatistics->broadcastsReceived != broadcasts || pStatistics->responsesSent != MAX_MODBUS_SLAVE_DEVICES)
+    {
+        printf("%lu broadcasts and %lu responses counted, expected %lu and %d\n", pStatistics->broadcastsReceived,
+               pStatistics->responsesSent, broadcasts, MAX_MODBUS_SLAVE_DEVICES);
+        errors++;
+    }
+    
+    printf("4 broadcasts to %d slaves, %d ignored requests, errors: %d\n", MAX_MODBUS_SLAVE_DEVICES, (int)IGNORED_REQUESTS_NUMBER, errors);
+    
+    return errors ? 1 : 0;
+}
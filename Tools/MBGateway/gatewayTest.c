@@ -0,0 +1,395 @@
+/*
+    ModBus TCP client which checks the gateway in the loopback with the host slave (see loopbackTest.sh).
+    Slaves 1 .. 10 of rtuslave are written and read through the gateway: reads and writes of coils and registers,
+    broadcast, exception of the slave, timeout of a missing slave and the cache around queued writes - a read
+    which was on the line before a write must not leave its old data in the cache for the next read.
+
+    Build and run from the repository root, mbgateway must run with -t GATEWAY_TEST_TIMEOUT_MS or shorter:
+    gcc -std=gnu99 -O2 -Wall -o gatewaytest Tools/MBGateway/gatewayTest.c
+    ./gatewaytest 127.0.0.1 1502
+
+    Exit code is 1 if any answer is wrong or missing.
+*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#define GATEWAY_TEST_TIMEOUT_MS                 200             // gateway's timeout of a missing slave
+#define TEST_ANSWER_TIMEOUT_MS                  2000
+#define TEST_MISSING_UNIT                       11
+#define TEST_MAX_PENDING                        8               // answers which came before the awaited one
+
+#define MBAP_HEADER_SIZE                        7
+#define MB_PDU_MAX_SIZE                         253
+#define MB_EXCEPTION_FLAG                       0x80
+#define MB_EXCEPTION_ILLEGAL_DATA_VALUE         0x03
+#define MB_EXCEPTION_TARGET_FAILED              0x0B
+
+// Answer of one transaction
+typedef struct testAnswer{
+    unsigned short transactionId;
+    unsigned char pdu[MB_PDU_MAX_SIZE];
+    int pduLength;
+}tTestAnswer;
+
+static int Socket = -1;
+static tTestAnswer Pending[TEST_MAX_PENDING];
+static int PendingCount;
+static int errors;
+
+static void PutWord(unsigned char *pBytes, unsigned short value)
+{
+    pBytes[0] = (unsigned char)(value >> 8);
+    pBytes[1] = (unsigned char)value;
+}
+
+static unsigned short GetWord(const unsigned char *pBytes)
+{
+    return ((unsigned short)pBytes[0] << 8) | pBytes[1];
+}
+
+// ..................Transactions..........................
+
+static void Send(unsigned short transactionId, unsigned char unit, const unsigned char *pPdu, int pduLength)
+{
+    unsigned char adu[MBAP_HEADER_SIZE + MB_PDU_MAX_SIZE];
+    
+    PutWord(&adu[0], transactionId);
+    PutWord(&adu[2], 0);
+    PutWord(&adu[4], (unsigned short)(pduLength + 1));
+    adu[6] = unit;
+    memcpy(&adu[MBAP_HEADER_SIZE], pPdu, pduLength);
+    
+    if(send(Socket, adu, MBAP_HEADER_SIZE + pduLength, MSG_NOSIGNAL) != MBAP_HEADER_SIZE + pduLength)
+    {
+        perror("send");
+        exit(1);
+    }
+}
+
+// Requests sent while the socket is corked go in one segment
+static void SetCork(int isCorked)
+{
+    setsockopt(Socket, IPPROTO_TCP, TCP_CORK, &isCorked, sizeof(isCorked));
+}
+
+// Read exactly length bytes, return 0 on timeout or closed connection
+static int ReceiveBytes(unsigned char *pBytes, int length)
+{
+    struct pollfd socketPoll;
+    int n, received = 0;
+    
+    socketPoll.fd = Socket;
+    socketPoll.events = POLLIN;
+    
+    while(received < length)
+    {
+        if(poll(&socketPoll, 1, TEST_ANSWER_TIMEOUT_MS) <= 0)
+        {
+            return 0;
+        }
+        n = (int)recv(Socket, &pBytes[received], length - received, 0);
+        if(n <= 0)
+        {
+            return 0;
+        }
+        received += n;
+    }
+    
+    return 1;
+}
+
+/*
+    Wait for the answer of the transaction, answers of the other ones are kept for later
+    return PDU length, 0 if the answer did not come
+*/
+static int Receive(unsigned short transactionId, unsigned char *pPdu)
+{
+    unsigned char header[MBAP_HEADER_SIZE];
+    tTestAnswer answer;
+    int i, length;
+    
+    for(;;)
+    {
+        for(i = 0; i < PendingCount; i++)
+        {
+            if(Pending[i].transactionId == transactionId)
+            {
+                length = Pending[i].pduLength;
+                memcpy(pPdu, Pending[i].pdu, length);
+                Pending[i] = Pending[--PendingCount];
+                return length;
+            }
+        }
+    
+        if(!ReceiveBytes(header, MBAP_HEADER_SIZE))
+        {
+            return 0;
+        }
+        answer.transactionId = GetWord(&header[0]);
+        answer.pduLength = GetWord(&header[4]) - 1;
+        if(answer.pduLength < 2 || answer.pduLength > MB_PDU_MAX_SIZE || !ReceiveBytes(answer.pdu, answer.pduLength))
+        {
+            return 0;
+        }
+    
+        if(answer.transactionId == transactionId)
+        {
+            memcpy(pPdu, answer.pdu, answer.pduLength);
+            return answer.pduLength;
+        }
+        if(PendingCount == TEST_MAX_PENDING)
+        {
+            return 0;
+        }
+        Pending[PendingCount++] = answer;
+    }
+}
+
+// Send the request and wait for its answer, return PDU length or 0
+static int Transact(unsigned short transactionId, unsigned char unit, const unsigned char *pRequest, int requestLength, unsigned char *pAnswer)
+{
+    Send(transactionId, unit, pRequest, requestLength);
+    return Receive(transactionId, pAnswer);
+}
+
+// ..................Requests..........................
+
+static int ComposeReadRegisters(unsigned char *pPdu, unsigned short start, unsigned short count)
+{
+    pPdu[0] = 3;
+    PutWord(&pPdu[1], start);
+    PutWord(&pPdu[3], count);
+    return 5;
+}
+
+static int ComposeWriteRegisters(unsigned char *pPdu, unsigned short start, unsigned short count, const unsigned short *pValues)
+{
+    int i;
+    
+    pPdu[0] = 16;
+    PutWord(&pPdu[1], start);
+    PutWord(&pPdu[3], count);
+    pPdu[5] = (unsigned char)(2 * count);
+    for(i = 0; i < count; i++)
+    {
+        PutWord(&pPdu[6 + 2 * i], pValues[i]);
+    }
+    return 6 + 2 * count;
+}
+
+// Answer of FC 3 with the expected values
+static void CheckRegisters(const char *name, const unsigned char *pPdu, int pduLength, unsigned short count, const unsigned short *pExpected)
+{
+    int i;
+    
+    if(pduLength != 2 + 2 * count || pPdu[0] != 3 || pPdu[1] != 2 * count)
+    {
+        printf("%-32s answer of %d bytes, function 0x%02X\n", name, pduLength, pduLength ? pPdu[0] : 0);
+        errors++;
+        return;
+    }
+    
+    for(i = 0; i < count; i++)
+    {
+        if(GetWord(&pPdu[2 + 2 * i]) != pExpected[i])
+        {
+            printf("%-32s register %d is 0x%04X, expected 0x%04X\n", name, i, GetWord(&pPdu[2 + 2 * i]), pExpected[i]);
+            errors++;
+        }
+    }
+}
+
+static void CheckException(const char *name, const unsigned char *pPdu, int pduLength, unsigned char function, unsigned char exception)
+{
+    if(pduLength != 2 || pPdu[0] != (function | MB_EXCEPTION_FLAG) || pPdu[1] != exception)
+    {
+        printf("%-32s answer of %d bytes, expected exception %d\n", name, pduLength, exception);
+        errors++;
+    }
+}
+
+// ..................Checks..........................
+
+static void CheckRegistersWriteRead(void)
+{
+    static const unsigned short values[] = {0x0102, 0x0304, 0x0506, 0x0708};
+    unsigned char request[MB_PDU_MAX_SIZE], answer[MB_PDU_MAX_SIZE];
+    int length;
+    
+    length = ComposeWriteRegisters(request, 0, 4, values);
+    length = Transact(1, 1, request, length, answer);
+    if(length != 5 || answer[0] != 16 || GetWord(&answer[3]) != 4)
+    {
+        printf("%-32s answer of %d bytes\n", "FC 16 unit 1", length);
+        errors++;
+    }
+    
+    length = ComposeReadRegisters(request, 0, 4);
+    length = Transact(2, 1, request, length, answer);
+    CheckRegisters("FC 3 unit 1", answer, length, 4, values);
+    
+    // second read is a cache hit, a part of the cached read too
+    length = ComposeReadRegisters(request, 1, 2);
+    length = Transact(3, 1, request, length, answer);
+    CheckRegisters("FC 3 unit 1 part of cached read", answer, length, 2, &values[1]);
+}
+
+static void CheckCoils(void)
+{
+    static const unsigned char forceCoil[] = {5, 0x00, 0x07, 0xFF, 0x00};
+    static const unsigned char forceCoils[] = {15, 0x00, 0x08, 0x00, 0x03, 0x01, 0x05};
+    static const unsigned char readCoils[] = {1, 0x00, 0x00, 0x00, 0x10};
+    unsigned char answer[MB_PDU_MAX_SIZE];
+    int length;
+    
+    length = Transact(10, 2, forceCoil, sizeof(forceCoil), answer);
+    if(length != 5 || memcmp(answer, forceCoil, 5) != 0)
+    {
+        printf("%-32s answer of %d bytes\n", "FC 5 unit 2", length);
+        errors++;
+    }
+    length = Transact(11, 2, forceCoils, sizeof(forceCoils), answer);
+    if(length != 5 || answer[0] != 15)
+    {
+        printf("%-32s answer of %d bytes\n", "FC 15 unit 2", length);
+        errors++;
+    }
+    
+    // coil 7 from FC 5, coils 8 and 10 from FC 15
+    length = Transact(12, 2, readCoils, sizeof(readCoils), answer);
+    if(length != 4 || answer[0] != 1 || answer[1] != 2 || answer[2] != 0x80 || answer[3] != 0x05)
+    {
+        printf("%-32s answer of %d bytes: 0x%02X 0x%02X\n", "FC 1 unit 2", length, answer[2], answer[3]);
+        errors++;
+    }
+}
+
+static void CheckBroadcast(void)
+{
+    static const unsigned short value = 0x4242;
+    unsigned char request[MB_PDU_MAX_SIZE], answer[MB_PDU_MAX_SIZE];
+    int length, unit;
+    
+    // read first, the broadcast must drop the cached data of every unit
+    for(unit = 1; unit <= 10; unit++)
+    {
+        length = ComposeReadRegisters(request, 50, 1);
+        Transact(20 + unit, unit, request, length, answer);
+    }
+    
+    // no answer, the next request waits for the broadcast delay of the gateway
+    request[0] = 6;
+    PutWord(&request[1], 50);
+    PutWord(&request[3], value);
+    Send(20, 0, request, 5);
+    
+    for(unit = 1; unit <= 10; unit++)
+    {
+        length = ComposeReadRegisters(request, 50, 1);
+        length = Transact(40 + unit, unit, request, length, answer);
+        CheckRegisters("FC 3 after broadcast FC 6", answer, length, 1, &value);
+    }
+    
+    if(PendingCount != 0)
+    {
+        printf("%-32s %d unexpected answers\n", "broadcast FC 6", PendingCount);
+        errors++;
+    }
+}
+
+static void CheckExceptions(void)
+{
+    unsigned char request[MB_PDU_MAX_SIZE], answer[MB_PDU_MAX_SIZE];
+    int length;
+    
+    length = ComposeReadRegisters(request, 0, 0);
+    length = Transact(60, 1, request, length, answer);
+    CheckException("FC 3 quantity 0", answer, length, 3, MB_EXCEPTION_ILLEGAL_DATA_VALUE);
+    
+    length = ComposeReadRegisters(request, 0, 1);
+    length = Transact(61, TEST_MISSING_UNIT, request, length, answer);
+    CheckException("FC 3 missing unit", answer, length, 3, MB_EXCEPTION_TARGET_FAILED);
+}
+
+/*
+    Read of the range is on the line, a write of the range waits behind the timeout of the missing unit.
+    The read answer comes with the old values, the next read of the range must wait for the write and get the new ones.
+*/
+static void CheckReadAroundQueuedWrite(void)
+{
+    static const unsigned short oldValues[] = {0x1111, 0x2222};
+    static const unsigned short newValues[] = {0x3333, 0x4444};
+    unsigned char request[MB_PDU_MAX_SIZE], answer[MB_PDU_MAX_SIZE];
+    int length;
+    
+    length = ComposeWriteRegisters(request, 30, 2, oldValues);
+    Transact(70, 3, request, length, answer);
+    
+    // one segment, the gateway queues all three before the read is answered
+    SetCork(1);
+    length = ComposeReadRegisters(request, 30, 2);
+    Send(71, 3, request, length);
+    length = ComposeReadRegisters(request, 0, 1);
+    Send(72, TEST_MISSING_UNIT, request, length);
+    length = ComposeWriteRegisters(request, 30, 2, newValues);
+    Send(73, 3, request, length);
+    SetCork(0);
+    
+    length = Receive(71, answer);
+    CheckRegisters("FC 3 before queued write", answer, length, 2, oldValues);
+    
+    length = ComposeReadRegisters(request, 30, 2);
+    length = Transact(74, 3, request, length, answer);
+    CheckRegisters("FC 3 after queued write", answer, length, 2, newValues);
+    
+    length = Receive(72, answer);
+    CheckException("FC 3 missing unit", answer, length, 3, MB_EXCEPTION_TARGET_FAILED);
+    length = Receive(73, answer);
+    if(length != 5 || answer[0] != 16)
+    {
+        printf("%-32s answer of %d bytes\n", "FC 16 queued write", length);
+        errors++;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    struct sockaddr_in address;
+    int one = 1;
+    
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons((unsigned short)((argc > 2) ? atoi(argv[2]) : 1502));
+    if(inet_pton(AF_INET, (argc > 1) ? argv[1] : "127.0.0.1", &address.sin_addr) != 1)
+    {
+        fprintf(stderr, "usage: gatewaytest [address] [port]\n");
+        return 2;
+    }
+    
+    Socket = socket(AF_INET, SOCK_STREAM, 0);
+    if(Socket < 0 || connect(Socket, (struct sockaddr *)&address, sizeof(address)) != 0)
+    {
+        perror("gateway");
+        return 1;
+    }
+    setsockopt(Socket, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    
+    CheckRegistersWriteRead();
+    CheckCoils();
+    CheckBroadcast();
+    CheckExceptions();
+    CheckReadAroundQueuedWrite();
+    
+    close(Socket);
+    printf("errors: %d\n", errors);
+    
+    return errors ? 1 : 0;
+}
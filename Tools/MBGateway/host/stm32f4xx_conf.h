@@ -0,0 +1,9 @@
+/*
+    Host replacement of the peripheral library configuration, the ModBus slave needs the device header only.
+*/
+#ifndef __HOST_STM32F4XX_CONF_H
+#define __HOST_STM32F4XX_CONF_H
+
+#include "stm32f4xx.h"
+
+#endif
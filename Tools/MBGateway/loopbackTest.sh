@@ -0,0 +1,36 @@
+#!/bin/sh
+#
+# Loopback test of the gateway: rtuslave, mbgateway and gatewaytest are built, the gateway is connected to
+# the pty of the slave and gatewaytest checks its answers (see gatewayTest.c).
+#
+# Run from the repository root:
+# sh Tools/MBGateway/loopbackTest.sh [tcp port]
+#
+# Exit code is 1 if any check failed or the slave or the gateway did not start.
+
+PORT=${1:-1502}
+DIR=$(mktemp -d)
+SLAVE_SOURCES="ModBusSlave/mbslave.c ModBusSlave/mbbinding.c ModBusSlave/mbdiagnostics.c ModBusSlave/mbcrc.c"
+SLAVE_INCLUDES="-I Tools/MBGateway/host -I ModBusSlave -I Definitions -I Serial -I MyTimers -I Scheduler -I USART -I Delay"
+
+trap 'kill $SLAVE $GATEWAY 2>/dev/null; rm -rf "$DIR"' EXIT
+
+gcc -std=gnu99 -O2 -Wall $SLAVE_INCLUDES -o "$DIR/rtuslave" Tools/MBGateway/rtuSlave.c $SLAVE_SOURCES || exit 1
+gcc -std=gnu99 -O2 -Wall -I ModBusSlave -o "$DIR/mbgateway" Tools/MBGateway/mbGateway.c ModBusSlave/mbcrc.c || exit 1
+gcc -std=gnu99 -O2 -Wall -o "$DIR/gatewaytest" Tools/MBGateway/gatewayTest.c || exit 1
+
+"$DIR/rtuslave" > "$DIR/pty" &
+SLAVE=$!
+for i in 1 2 3 4 5 6 7 8 9 10; do
+    [ -s "$DIR/pty" ] && break
+    sleep 0.1
+done
+[ -s "$DIR/pty" ] || { echo "rtuslave did not start"; exit 1; }
+
+# timeout of the missing unit as gatewaytest expects it
+"$DIR/mbgateway" "$(cat "$DIR/pty")" -p "$PORT" -t 200 &
+GATEWAY=$!
+sleep 0.3
+kill -0 $GATEWAY 2>/dev/null || { echo "mbgateway did not start"; exit 1; }
+
+"$DIR/gatewaytest" 127.0.0.1 "$PORT"
@@ -0,0 +1,857 @@
+/*
+    Host ModBus TCP to RTU gateway. Any number of TCP clients (up to GATEWAY_MAX_CLIENTS) are served by one epoll
+    loop and their requests are put through one serial line in order of arrival - RTU has one request on the bus
+    at a time. The serial line is a tty (USART2/USART3 of the controller through a converter) or a pty of rtuslave.
+
+    Reads (FC 1, 2, 3, 4) are answered from the cache while the answer is younger than the cache age and no write
+    through the gateway touched it; a register read is also served from a cached read which covers it.
+    Writes (FC 5, 6, 15, 16, 23) drop the cached data they overlap, other functions drop all data of the unit.
+    While a write of the unit waits in the queue or is on the line, its reads are neither answered from the cache
+    nor cached - a read which was on the line before the write returns the old data.
+    Unit 0 is RTU broadcast - it is sent to the bus and, like on the bus, not answered.
+
+    Exceptions of the gateway itself: 0x06 (busy) when the queue is full, 0x0B (target failed to respond) for
+    timeout, bad CRC and response which does not match the request.
+
+    Build and run from the repository root:
+    gcc -std=gnu99 -O2 -Wall -I ModBusSlave -o mbgateway Tools/MBGateway/mbGateway.c ModBusSlave/mbcrc.c
+    ./mbgateway /dev/pts/3 -p 1502 -b 19200 -c 200 -t 500
+
+    Loopback test with the host slave:
+    ./rtuslave &                                -- prints the pty path
+    ./mbgateway <pty path> -p 1502
+    and point any ModBus TCP client at 127.0.0.1:1502, slave addresses are 1 .. 10.
+    sh Tools/MBGateway/loopbackTest.sh builds and starts both and checks the answers by gatewaytest.
+*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include "mbcrc.h"
+
+#define GATEWAY_MAX_CLIENTS                     32
+#define GATEWAY_QUEUE_SIZE                      64              // requests waiting for the serial line
+#define GATEWAY_CACHE_ENTRIES                   64
+#define GATEWAY_MAX_EVENTS                      16
+#define GATEWAY_DEFAULT_PORT                    502
+#define GATEWAY_DEFAULT_BAUD_RATE               19200
+#define GATEWAY_DEFAULT_CACHE_AGE_MS            100             // 0 - no cache
+#define GATEWAY_DEFAULT_TIMEOUT_MS              500             // request sent - first byte of the response
+#define GATEWAY_BROADCAST_DELAY_MS              100             // turnaround delay after broadcast
+
+// epoll tags, clients are tagged by their index
+#define TAG_LISTEN                              GATEWAY_MAX_CLIENTS
+#define TAG_SERIAL                              (GATEWAY_MAX_CLIENTS + 1)
+#define TAG_TIMER                               (GATEWAY_MAX_CLIENTS + 2)
+
+#define MBAP_HEADER_SIZE                        7               // transaction, protocol, length, unit
+#define MB_PDU_MAX_SIZE                         253
+#define MBAP_ADU_MAX_SIZE                       (MBAP_HEADER_SIZE + MB_PDU_MAX_SIZE)
+#define RTU_ADU_MAX_SIZE                        (1 + MB_PDU_MAX_SIZE + 2)
+
+#define MB_BROADCAST_UNIT                       0
+#define MB_EXCEPTION_FLAG                       0x80
+#define MB_EXCEPTION_BUSY                       0x06
+#define MB_EXCEPTION_TARGET_FAILED              0x0B
+
+typedef struct gatewayClient{
+    int fd;                             // -1 for free slot
+    unsigned long generation;           // changes with every client of the slot, answers for closed clients are dropped
+    unsigned char buffer[MBAP_ADU_MAX_SIZE];
+    int length;
+}tGatewayClient;
+
+typedef struct gatewayRequest{
+    int clientIndex;
+    unsigned long generation;
+    unsigned short transactionId;
+    unsigned char unit;
+    unsigned char pdu[MB_PDU_MAX_SIZE];
+    int pduLength;
+}tGatewayRequest;
+
+// Successful read response of one unit
+typedef struct gatewayCacheEntry{
+    int isValid;
+    unsigned char unit;
+    unsigned char function;             // 1, 2, 3, 4
+    unsigned short start;
+    unsigned short count;
+    unsigned long long stamp;           // ms
+    unsigned char pdu[MB_PDU_MAX_SIZE];
+    int pduLength;
+}tGatewayCacheEntry;
+
+typedef struct gatewayStatistics{
+    unsigned long requests;
+    unsigned long cacheHits;
+    unsigned long forwarded;
+    unsigned long timeouts;
+    unsigned long badResponses;         // CRC, unit or function does not match
+    unsigned long busyRejects;
+}tGatewayStatistics;
+
+static tGatewayClient Clients[GATEWAY_MAX_CLIENTS];
+static tGatewayRequest Queue[GATEWAY_QUEUE_SIZE];
+static int QueueHead, QueueCount;
+static tGatewayCacheEntry Cache[GATEWAY_CACHE_ENTRIES];
+static int PendingWrites[256];          // per unit, requests which may write and are queued or on the line
+static tGatewayStatistics Statistics;
+
+static int Epoll, ListenFd, SerialFd, TimerFd;
+static int CacheAgeMs = GATEWAY_DEFAULT_CACHE_AGE_MS;
+static int TimeoutMs = GATEWAY_DEFAULT_TIMEOUT_MS;
+static int FrameGapMs;
+
+// request on the serial line
+static int IsLineBusy;
+static tGatewayRequest Active;
+static unsigned char RtuBuffer[RTU_ADU_MAX_SIZE];
+static int RtuLength;
+
+static volatile sig_atomic_t IsStopRequested;
+
+static unsigned long long NowMs(void)
+{
+    struct timespec now;
+    
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long long)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+// Start the line timer, 0 stops it
+static void SetLineTimer(int miliseconds)
+{
+    struct itimerspec timer;
+    
+    memset(&timer, 0, sizeof(timer));
+    timer.it_value.tv_sec = miliseconds / 1000;
+    timer.it_value.tv_nsec = (long)(miliseconds % 1000) * 1000000;
+    timerfd_settime(TimerFd, 0, &timer, 0);
+}
+
+static unsigned short GetWord(const unsigned char *pBytes)
+{
+    return ((unsigned short)pBytes[0] << 8) | pBytes[1];
+}
+
+static void PutWord(unsigned char *pBytes, unsigned short value)
+{
+    pBytes[0] = (unsigned char)(value >> 8);
+    pBytes[1] = (unsigned char)value;
+}
+
+// ..................Clients..........................
+
+static void CloseClient(int index)
+{
+    epoll_ctl(Epoll, EPOLL_CTL_DEL, Clients[index].fd, 0);
+    close(Clients[index].fd);
+    Clients[index].fd = -1;
+    Clients[index].generation++;
+    Clients[index].length = 0;
+}
+
+// Answer of the request, dropped if its client is gone
+static void SendResponse(const tGatewayRequest *pRequest, const unsigned char *pPdu, int pduLength)
+{
+    tGatewayClient *pClient = &Clients[pRequest->clientIndex];
+    unsigned char adu[MBAP_ADU_MAX_SIZE];
+    
+    if(pClient->fd < 0 || pClient->generation != pRequest->generation || pRequest->unit == MB_BROADCAST_UNIT)
+    {
+        return;
+    }
+    
+    PutWord(&adu[0], pRequest->transactionId);
+    PutWord(&adu[2], 0);
+    PutWord(&adu[4], (unsigned short)(pduLength + 1));
+    adu[6] = pRequest->unit;
+    memcpy(&adu[MBAP_HEADER_SIZE], pPdu, pduLength);
+    
+    // answers are small, a client which can't take one is stuck
+    if(send(pClient->fd, adu, MBAP_HEADER_SIZE + pduLength, MSG_NOSIGNAL) != MBAP_HEADER_SIZE + pduLength)
+    {
+        CloseClient(pRequest->clientIndex);
+    }
+}
+
+static void SendException(const tGatewayRequest *pRequest, unsigned char exception)
+{
+    unsigned char pdu[2];
+    
+    pdu[0] = pRequest->pdu[0] | MB_EXCEPTION_FLAG;
+    pdu[1] = exception;
+    SendResponse(pRequest, pdu, sizeof(pdu));
+}
+
+// ..................Cache..........................
+
+static int IsReadFunction(unsigned char function)
+{
+    return function >= 1 && function <= 4;
+}
+
+static int IsRegisterFunction(unsigned char function)
+{
+    return function == 3 || function == 4;
+}
+
+/*
+    Table written by the request and its range, the function of the table is the read function of that data
+    return 0 if the request writes nothing, -1 if it is not known what it writes or the request is too short
+*/
+static int GetWrittenRange(const tGatewayRequest *pRequest, unsigned short *pStart, unsigned short *pCount)
+{
+    const unsigned char *pPdu = pRequest->pdu;
+    
+    if(pRequest->pduLength < ((pPdu[0] == 23) ? 9 : 5))
+    {
+        return -1;
+    }
+    
+    switch(pPdu[0])
+    {
+    case 1:
+    case 2:
+    case 3:
+    case 4:
+    case 8:
+        return 0;
+    case 5:
+        *pStart = GetWord(&pPdu[1]);
+        *pCount = 1;
+        return 1;
+    case 15:
+        *pStart = GetWord(&pPdu[1]);
+        *pCount = GetWord(&pPdu[3]);
+        return 1;
+    case 6:
+        *pStart = GetWord(&pPdu[1]);
+        *pCount = 1;
+        return 3;
+    case 16:
+        *pStart = GetWord(&pPdu[1]);
+        *pCount = GetWord(&pPdu[3]);
+        return 3;
+    case 23:
+        *pStart = GetWord(&pPdu[5]);
+        *pCount = GetWord(&pPdu[7]);
+        return 3;
+    default:
+        return -1;
+    }
+}
+
+// Count the request which may write from its queueing to its end
+static void AddPendingWrite(const tGatewayRequest *pRequest)
+{
+    unsigned short start, count;
+    
+    if(GetWrittenRange(pRequest, &start, &count) != 0)
+    {
+        PendingWrites[pRequest->unit]++;
+    }
+}
+
+static void RemovePendingWrite(const tGatewayRequest *pRequest)
+{
+    unsigned short start, count;
+    
+    if(GetWrittenRange(pRequest, &start, &count) != 0)
+    {
+        PendingWrites[pRequest->unit]--;
+    }
+}
+
+// Data of the unit may change before the cached answer or the answer on the line gets to the client
+static int IsWritePending(unsigned char unit)
+{
+    return PendingWrites[unit] > 0 || PendingWrites[MB_BROADCAST_UNIT] > 0;
+}
+
+// Drop cached data the request may change
+static void InvalidateCache(const tGatewayRequest *pRequest)
+{
+    unsigned short start, count;
+    int table, i;
+    tGatewayCacheEntry *pEntry;
+    
+    table = GetWrittenRange(pRequest, &start, &count);
+    if(table == 0)
+    {
+        return;
+    }
+    
+    for(i = 0; i < GATEWAY_CACHE_ENTRIES; i++)
+    {
+        pEntry = &Cache[i];
+        if(!pEntry->isValid || (pRequest->unit != MB_BROADCAST_UNIT && pEntry->unit != pRequest->unit))
+        {
+            continue;
+        }
+    
+        if(table < 0 || (pEntry->function == table && start < pEntry->start + pEntry->count && pEntry->start < start + count))
+        {
+            pEntry->isValid = 0;
+        }
+    }
+}
+
+/*
+    Compose the answer of the read from the cache
+    return PDU length, 0 if the data is not cached or too old
+*/
+static int ReadCache(const tGatewayRequest *pRequest, unsigned char *pPdu)
+{
+    unsigned char function = pRequest->pdu[0];
+    unsigned short start = GetWord(&pRequest->pdu[1]);
+    unsigned short count = GetWord(&pRequest->pdu[3]);
+    unsigned long long now = NowMs();
+    tGatewayCacheEntry *pEntry;
+    int i;
+    
+    if(count == 0)
+    {
+        return 0;                                       // the slave answers with exception
+    }
+    
+    for(i = 0; i < GATEWAY_CACHE_ENTRIES; i++)
+    {
+        pEntry = &Cache[i];
+        if(!pEntry->isValid || pEntry->unit != pRequest->unit || pEntry->function != function || now - pEntry->stamp > (unsigned long long)CacheAgeMs)
+        {
+            continue;
+        }
+    
+        if(pEntry->start == start && pEntry->count == count)
+        {
+            memcpy(pPdu, pEntry->pdu, pEntry->pduLength);
+            return pEntry->pduLength;
+        }
+    
+        // registers are whole bytes, a part of a bigger read is cut out
+        if(IsRegisterFunction(function) && pEntry->start <= start && start + count <= pEntry->start + pEntry->count)
+        {
+            pPdu[0] = function;
+            pPdu[1] = (unsigned char)(2 * count);
+            memcpy(&pPdu[2], &pEntry->pdu[2 + 2 * (start - pEntry->start)], 2 * count);
+            return 2 + 2 * count;
+        }
+    }
+    
+    return 0;
+}
+
+// Keep successful read response, the same read or the oldest entry is replaced
+static void WriteCache(const tGatewayRequest *pRequest, const unsigned char *pPdu, int pduLength)
+{
+    unsigned short start = GetWord(&pRequest->pdu[1]);
+    unsigned short count = GetWord(&pRequest->pdu[3]);
+    tGatewayCacheEntry *pEntry, *pVictim;
+    int i;
+    
+    pVictim = &Cache[0];
+    for(i = 0; i < GATEWAY_CACHE_ENTRIES; i++)
+    {
+        pEntry = &Cache[i];
+        if(pEntry->isValid && pEntry->unit == pRequest->unit && pEntry->function == pRequest->pdu[0] && pEntry->start == start && pEntry->count == count)
+        {
+            pVictim = pEntry;
+            break;
+        }
+        if(!pEntry->isValid)
+        {
+            pVictim = pEntry;
+        }
+        else if(pVictim->isValid && pEntry->stamp < pVictim->stamp)
+        {
+            pVictim = pEntry;
+        }
+    }
+    
+    pVictim->isValid = 1;
+    pVictim->unit = pRequest->unit;
+    pVictim->function = pRequest->pdu[0];
+    pVictim->start = start;
+    pVictim->count = count;
+    pVictim->stamp = NowMs();
+    memcpy(pVictim->pdu, pPdu, pduLength);
+    pVictim->pduLength = pduLength;
+}
+
+// ..................Serial line..........................
+
+/*
+    Length of the whole RTU response, known from its first bytes
+    return 0 if it is not known yet or the function is not known - the frame gap ends the response then
+*/
+static int GetResponseLength(void)
+{
+    if(RtuLength < 2)
+    {
+        return 0;
+    }
+    
+    if(RtuBuffer[1] & MB_EXCEPTION_FLAG)
+    {
+        return 5;                                       // address, function, exception, CRC
+    }
+    
+    switch(RtuBuffer[1])
+    {
+    case 1:
+    case 2:
+    case 3:
+    case 4:
+    case 23:
+        return (RtuLength < 3) ? 0 : 5 + RtuBuffer[2];  // address, function, byte count, data, CRC
+    case 5:
+    case 6:
+    case 15:
+    case 16:
+        return 8;
+    case 8:
+        return 3 + Active.pduLength;                    // address, echo of the request, CRC
+    default:
+        return 0;
+    }
+}
+
+static void StartNextRequest(void)
+{
+    unsigned char frame[RTU_ADU_MAX_SIZE], drop[RTU_ADU_MAX_SIZE];
+    unsigned int crc;
+    int length;
+    
+    while(!IsLineBusy && QueueCount > 0)
+    {
+        Active = Queue[QueueHead];
+        QueueHead = (QueueHead + 1) % GATEWAY_QUEUE_SIZE;
+        QueueCount--;
+    
+        // nobody waits for the answer, broadcast is sent anyway
+        if(Active.unit != MB_BROADCAST_UNIT && (Clients[Active.clientIndex].fd < 0 || Clients[Active.clientIndex].generation != Active.generation))
+        {
+            RemovePendingWrite(&Active);
+            continue;
+        }
+    
+        frame[0] = Active.unit;
+        memcpy(&frame[1], Active.pdu, Active.pduLength);
+        length = 1 + Active.pduLength;
+        crc = usMBCRC16(frame, length);
+        frame[length++] = (unsigned char)crc;
+        frame[length++] = (unsigned char)(crc >> 8);
+    
+        // late answer of the previous request must not be taken for this one
+        while(read(SerialFd, drop, sizeof(drop)) > 0)
+        {
+        }
+    
+        RtuLength = 0;
+        Statistics.forwarded++;
+        if(write(SerialFd, frame, length) != length)
+        {
+            RemovePendingWrite(&Active);
+            SendException(&Active, MB_EXCEPTION_TARGET_FAILED);
+            continue;
+        }
+    
+        IsLineBusy = 1;
+        SetLineTimer((Active.unit == MB_BROADCAST_UNIT) ? GATEWAY_BROADCAST_DELAY_MS : TimeoutMs);
+    }
+}
+
+// Response is complete or the line is silent, answer the client and start the next request
+static void FinishRequest(void)
+{
+    const unsigned char *pPdu = &RtuBuffer[1];
+    int pduLength = RtuLength - 3;
+    
+    SetLineTimer(0);
+    IsLineBusy = 0;
+    RemovePendingWrite(&Active);
+    
+    if(Active.unit == MB_BROADCAST_UNIT)
+    {
+        InvalidateCache(&Active);
+    }
+    else if(RtuLength == 0)
+    {
+        Statistics.timeouts++;
+        SendException(&Active, MB_EXCEPTION_TARGET_FAILED);
+    }
+    else if(RtuLength < 5 || usMBCRC16(RtuBuffer, RtuLength) != 0 || RtuBuffer[0] != Active.unit || (RtuBuffer[1] & ~MB_EXCEPTION_FLAG) != Active.pdu[0])
+    {
+        Statistics.badResponses++;
+        SendException(&Active, MB_EXCEPTION_TARGET_FAILED);
+    }
+    else
+    {
+        if((pPdu[0] & MB_EXCEPTION_FLAG) == 0)
+        {
+            // reads which were on the line before the write could cache the old data
+            InvalidateCache(&Active);
+            if(CacheAgeMs > 0 && IsReadFunction(pPdu[0]) && !IsWritePending(Active.unit))
+            {
+                WriteCache(&Active, pPdu, pduLength);
+            }
+        }
+        SendResponse(&Active, pPdu, pduLength);
+    }
+    
+    StartNextRequest();
+}
+
+static void ReadSerial(void)
+{
+    unsigned char bytes[RTU_ADU_MAX_SIZE];
+    int n, expected;
+    
+    n = (int)read(SerialFd, bytes, sizeof(bytes));
+    if(n <= 0)
+    {
+        if(n < 0 && errno != EAGAIN && errno != EINTR)
+        {
+            perror("serial");
+            IsStopRequested = 1;
+        }
+        return;
+    }
+    
+    // nothing is expected - noise or answer after timeout
+    if(!IsLineBusy || Active.unit == MB_BROADCAST_UNIT)
+    {
+        return;
+    }
+    
+    if(RtuLength + n > RTU_ADU_MAX_SIZE)
+    {
+        n = RTU_ADU_MAX_SIZE - RtuLength;
+    }
+    memcpy(&RtuBuffer[RtuLength], bytes, n);
+    RtuLength += n;
+    
+    expected = GetResponseLength();
+    if((expected != 0 && RtuLength >= expected) || RtuLength == RTU_ADU_MAX_SIZE)
+    {
+        FinishRequest();
+    }
+    else
+    {
+        SetLineTimer(FrameGapMs);
+    }
+}
+
+static int GetBaudRate(int baudRate, speed_t *pSpeed)
+{
+    switch(baudRate)
+    {
+    case 2400:   *pSpeed = B2400;   return 1;
+    case 9600:   *pSpeed = B9600;   return 1;
+    case 19200:  *pSpeed = B19200;  return 1;
+    case 38400:  *pSpeed = B38400;  return 1;
+    case 57600:  *pSpeed = B57600;  return 1;
+    case 115200: *pSpeed = B115200; return 1;
+    default:     return 0;
+    }
+}
+
+static int OpenSerial(const char *path, int baudRate)
+{
+    struct termios tty;
+    speed_t speed;
+    int fd;
+    
+    if(!GetBaudRate(baudRate, &speed))
+    {
+        fprintf(stderr, "unsupported baud rate %d\n", baudRate);
+        return -1;
+    }
+    
+    fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if(fd < 0)
+    {
+        perror(path);
+        return -1;
+    }
+    
+    if(tcgetattr(fd, &tty) == 0)
+    {
+        cfmakeraw(&tty);
+        cfsetispeed(&tty, speed);
+        cfsetospeed(&tty, speed);
+        tty.c_cflag |= CLOCAL | CREAD;
+        tcsetattr(fd, TCSANOW, &tty);
+    }
+    
+    // 3.5 characters of 11 bits, at least 2 ms for the scheduling of the host
+    FrameGapMs = (38500 + baudRate - 1) / baudRate;
+    if(FrameGapMs < 2)
+    {
+        FrameGapMs = 2;
+    }
+    
+    return fd;
+}
+
+// ..................TCP..........................
+
+static void HandleRequest(int clientIndex, const unsigned char *pAdu, int pduLength)
+{
+    tGatewayRequest request, *pRequest = &request;
+    unsigned char pdu[MB_PDU_MAX_SIZE];
+    int length;
+    
+    Statistics.requests++;
+    
+    pRequest->clientIndex = clientIndex;
+    pRequest->generation = Clients[clientIndex].generation;
+    pRequest->transactionId = GetWord(&pAdu[0]);
+    pRequest->unit = pAdu[6];
+    memcpy(pRequest->pdu, &pAdu[MBAP_HEADER_SIZE], pduLength);
+    pRequest->pduLength = pduLength;
+    
+    if(CacheAgeMs > 0 && pRequest->unit != MB_BROADCAST_UNIT && IsReadFunction(pRequest->pdu[0]) && pduLength == 5 && !IsWritePending(pRequest->unit))
+    {
+        length = ReadCache(pRequest, pdu);
+        if(length > 0)
+        {
+            Statistics.cacheHits++;
+            SendResponse(pRequest, pdu, length);
+            return;
+        }
+    }
+    
+    if(QueueCount == GATEWAY_QUEUE_SIZE)
+    {
+        Statistics.busyRejects++;
+        SendException(pRequest, MB_EXCEPTION_BUSY);
+        return;
+    }
+    
+    // a read answered from the cache after this must not return the old data
+    InvalidateCache(pRequest);
+    AddPendingWrite(pRequest);
+    Queue[(QueueHead + QueueCount) % GATEWAY_QUEUE_SIZE] = request;
+    QueueCount++;
+    
+    StartNextRequest();
+}
+
+static void ReadClient(int index)
+{
+    tGatewayClient *pClient = &Clients[index];
+    unsigned short length;
+    int n, aduLength;
+    
+    n = (int)recv(pClient->fd, &pClient->buffer[pClient->length], MBAP_ADU_MAX_SIZE - pClient->length, 0);
+    if(n <= 0)
+    {
+        if(n == 0 || (errno != EAGAIN && errno != EINTR))
+        {
+            CloseClient(index);
+        }
+        return;
+    }
+    pClient->length += n;
+    
+    // several requests may come in one segment, a request may come in several
+    while(pClient->fd >= 0 && pClient->length >= MBAP_HEADER_SIZE)
+    {
+        length = GetWord(&pClient->buffer[4]);
+        if(GetWord(&pClient->buffer[2]) != 0 || length < 2 || length > MB_PDU_MAX_SIZE + 1)
+        {
+            CloseClient(index);                         // not ModBus, the stream can't be synchronized again
+            return;
+        }
+    
+        aduLength = MBAP_HEADER_SIZE - 1 + length;
+        if(pClient->length < aduLength)
+        {
+            break;
+        }
+    
+        HandleRequest(index, pClient->buffer, length - 1);
+    
+        if(pClient->fd >= 0)
+        {
+            pClient->length -= aduLength;
+            memmove(pClient->buffer, &pClient->buffer[aduLength], pClient->length);
+        }
+    }
+}
+
+static void AcceptClient(void)
+{
+    struct epoll_event event;
+    int fd, i, one = 1;
+    
+    fd = accept4(ListenFd, 0, 0, SOCK_NONBLOCK);
+    if(fd < 0)
+    {
+        return;
+    }
+    
+    for(i = 0; i < GATEWAY_MAX_CLIENTS; i++)
+    {
+        if(Clients[i].fd < 0)
+        {
+            break;
+        }
+    }
+    if(i == GATEWAY_MAX_CLIENTS)
+    {
+        close(fd);
+        return;
+    }
+    
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    
+    Clients[i].fd = fd;
+    Clients[i].length = 0;
+    event.events = EPOLLIN;
+    event.data.u32 = i;
+    epoll_ctl(Epoll, EPOLL_CTL_ADD, fd, &event);
+}
+
+static int OpenListener(int port)
+{
+    struct sockaddr_in address;
+    int fd, one = 1;
+    
+    fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if(fd < 0)
+    {
+        return -1;
+    }
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons((unsigned short)port);
+    
+    if(bind(fd, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(fd, 16) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    
+    return fd;
+}
+
+// ..................Main loop..........................
+
+static void Stop(int signal)
+{
+    (void)signal;
+    IsStopRequested = 1;
+}
+
+static void AddToEpoll(int fd, unsigned int tag)
+{
+    struct epoll_event event;
+    
+    event.events = EPOLLIN;
+    event.data.u32 = tag;
+    epoll_ctl(Epoll, EPOLL_CTL_ADD, fd, &event);
+}
+
+static void Usage(void)
+{
+    fprintf(stderr, "usage: mbgateway <serial device> [-p tcp port] [-b baud rate] [-c cache age ms] [-t timeout ms]\n");
+}
+
+int main(int argc, char **argv)
+{
+    struct epoll_event events[GATEWAY_MAX_EVENTS];
+    unsigned long long expirations;
+    int port = GATEWAY_DEFAULT_PORT, baudRate = GATEWAY_DEFAULT_BAUD_RATE;
+    int option, n, i;
+    
+    while((option = getopt(argc, argv, "p:b:c:t:")) != -1)
+    {
+        switch(option)
+        {
+        case 'p': port = atoi(optarg); break;
+        case 'b': baudRate = atoi(optarg); break;
+        case 'c': CacheAgeMs = atoi(optarg); break;
+        case 't': TimeoutMs = atoi(optarg); break;
+        default: Usage(); return 2;
+        }
+    }
+    if(optind != argc - 1 || TimeoutMs <= 0)
+    {
+        Usage();
+        return 2;
+    }
+    
+    for(i = 0; i < GATEWAY_MAX_CLIENTS; i++)
+    {
+        Clients[i].fd = -1;
+    }
+    
+    SerialFd = OpenSerial(argv[optind], baudRate);
+    ListenFd = OpenListener(port);
+    TimerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+    Epoll = epoll_create1(0);
+    if(SerialFd < 0 || ListenFd < 0 || TimerFd < 0 || Epoll < 0)
+    {
+        perror("mbgateway");
+        return 1;
+    }
+    
+    AddToEpoll(ListenFd, TAG_LISTEN);
+    AddToEpoll(SerialFd, TAG_SERIAL);
+    AddToEpoll(TimerFd, TAG_TIMER);
+    
+    signal(SIGINT, Stop);
+    signal(SIGTERM, Stop);
+    
+    while(!IsStopRequested)
+    {
+        n = epoll_wait(Epoll, events, GATEWAY_MAX_EVENTS, -1);
+        for(i = 0; i < n; i++)
+        {
+            switch(events[i].data.u32)
+            {
+            case TAG_LISTEN:
+                AcceptClient();
+                break;
+            case TAG_SERIAL:
+                ReadSerial();
+                break;
+            case TAG_TIMER:
+                if(read(TimerFd, &expirations, sizeof(expirations)) == sizeof(expirations) && IsLineBusy)
+                {
+                    FinishRequest();                    // timeout, end of frame or end of broadcast delay
+                }
+                break;
+            default:
+                if(Clients[events[i].data.u32].fd >= 0)
+                {
+                    ReadClient(events[i].data.u32);
+                }
+                break;
+            }
+        }
+    }
+    
+    printf("requests %lu, cache hits %lu, forwarded %lu, timeouts %lu, bad responses %lu, busy %lu\n",
+           Statistics.requests, Statistics.cacheHits, Statistics.forwarded, Statistics.timeouts, Statistics.badResponses, Statistics.busyRejects);
+    
+    return 0;
+}
@@ -0,0 +1,163 @@
+/*
+    Host ModBus RTU slave on a pseudo-terminal. The firmware's slave engine (ModBusSlave/mbslave.c, mbbinding.c,
+    mbdiagnostics.c, mbcrc.c) is linked unchanged; the USART, the end of frame timer and the scheduler are replaced
+    by the pty and poll(). The slave side path of the pty is printed, give it to mbgateway as the serial line.
+
+    Slaves have addresses 1 .. MAX_MODBUS_SLAVE_DEVICES with the default register blocks. Slave 1 has
+    input registers 0, 1 bound to the uptime in seconds (high word first), which changes by itself, and the
+    communication statistics from input register 1000 like the controller.
+
+    Build and run from the repository root:
+    gcc -std=gnu99 -O2 -Wall -I Tools/MBGateway/host -I ModBusSlave -I Definitions -I Serial -I MyTimers -I Scheduler -I USART -I Delay -o rtuslave Tools/MBGateway/rtuSlave.c ModBusSlave/mbslave.c ModBusSlave/mbbinding.c ModBusSlave/mbdiagnostics.c ModBusSlave/mbcrc.c
+    ./rtuslave
+*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "stm32f4xx.h"
+#include "definitions.h"
+#include "mbslave.h"
+#include "mbbinding.h"
+#include "mbdiagnostics.h"
+#include "serial.h"
+#include "delay.h"
+
+#define SLAVE_FRAME_GAP_MS                      5               // silence which ends the request frame
+#define SLAVE_UPTIME_REGISTERS_START            0
+#define SLAVE_STATISTICS_REGISTERS_START        1000
+
+static int PtyMaster = -1;
+static unsigned char ReceivedByte;
+static BOOL IsFrameTimerEnabled;
+static struct timespec StartTime;
+
+// ..................Replacements of the firmware's drivers..........................
+
+unsigned char GetByte(int usartID)
+{
+    (void)usartID;
+    return ReceivedByte;
+}
+
+int OutString(unsigned char *Str, int len, int usartID, int timerType, int miliseconds)
+{
+    (void)usartID; (void)timerType; (void)miliseconds;
+    return (int)write(PtyMaster, Str, len);
+}
+
+void InitUSART2(int modBusUnitType) { (void)modBusUnitType; }
+void InitTIM3(void) { }
+void ModBusTimerEnable(unsigned short miliseconds) { (void)miliseconds; IsFrameTimerEnabled = TRUE; }
+void ModBusTimerDisable(void) { IsFrameTimerEnabled = FALSE; }
+void PostEvent(int event) { (void)event; }
+
+static double SecondsSinceStart(void)
+{
+    struct timespec now;
+    
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - StartTime.tv_sec) + (now.tv_nsec - StartTime.tv_nsec) * 1e-9;
+}
+
+// 100 MHz like the firmware's HCLK
+u32 GetCycleCounter(void)
+{
+    return (u32)(unsigned long long)(SecondsSinceStart() * 1e8);
+}
+
+u32 CyclesToMicroseconds(u32 cycles)
+{
+    return cycles / 100;
+}
+
+// ..................Slave data..........................
+
+static void ReadUptime(unsigned short offset, unsigned short count, unsigned short *pValues)
+{
+    unsigned long uptime = (unsigned long)SecondsSinceStart();
+    
+    while(count--)
+    {
+        *pValues++ = (offset++ == 0) ? (unsigned short)(uptime >> 16) : (unsigned short)uptime;
+    }
+}
+
+static int OpenPty(void)
+{
+    struct termios tty;
+    int slave;
+    
+    PtyMaster = posix_openpt(O_RDWR | O_NOCTTY);
+    if(PtyMaster < 0 || grantpt(PtyMaster) != 0 || unlockpt(PtyMaster) != 0)
+    {
+        return -1;
+    }
+    
+    // the slave side stays open, so the master side does not see hang up between the gateway's sessions
+    slave = open(ptsname(PtyMaster), O_RDWR | O_NOCTTY);
+    if(slave < 0 || tcgetattr(slave, &tty) != 0)
+    {
+        return -1;
+    }
+    cfmakeraw(&tty);
+    tcsetattr(slave, TCSANOW, &tty);
+    
+    return slave;
+}
+
+int main(void)
+{
+    struct pollfd pty;
+    unsigned char bytes[256];
+    int i, n;
+    
+    clock_gettime(CLOCK_MONOTONIC, &StartTime);
+    
+    if(OpenPty() < 0)
+    {
+        perror("pty");
+        return 1;
+    }
+    
+    MBInitHardwareAndProtocol();
+    MBBindInputRegisters(0, SLAVE_UPTIME_REGISTERS_START, 2, ReadUptime);
+    MBBindStatisticsRegisters(0, SLAVE_STATISTICS_REGISTERS_START);
+    
+    printf("%s\n", ptsname(PtyMaster));
+    fflush(stdout);
+    
+    pty.fd = PtyMaster;
+    pty.events = POLLIN;
+    
+    for(;;)
+    {
+        n = poll(&pty, 1, IsFrameTimerEnabled ? SLAVE_FRAME_GAP_MS : -1);
+        if(n < 0)
+        {
+            perror("poll");
+            return 1;
+        }
+    
+        if(n == 0)
+        {
+            // end of frame, the scheduler would run the poll task twice - frame check and execution
+            MBTimerExpired();
+            MBPollSlave();
+            MBPollSlave();
+            MB_slave_transmit();
+            continue;
+        }
+    
+        n = (int)read(PtyMaster, bytes, sizeof(bytes));
+        for(i = 0; i < n; i++)
+        {
+            ReceivedByte = bytes[i];
+            MBReceiveFSM();
+        }
+    }
+}
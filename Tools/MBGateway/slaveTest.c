@@ -0,0 +1,233 @@
+/*
+    Host test of the request checks of the slave engine. ModBusSlave/mbslave.c, mbbinding.c, mbdiagnostics.c and
+    mbcrc.c are linked unchanged like in rtuSlave.c, the USART is replaced by a buffer: every request frame
+    goes byte by byte through the receive interrupt, then the end of frame timer, two runs of the poll task
+    (frame check and execution) and the transmit task run like in the scheduler. The response is checked for
+    its length, CRC, function code and exception code.
+
+    Slaves have addresses 1 .. MAX_MODBUS_SLAVE_DEVICES with the default register blocks:
+    OUTPUTS_NUMBER coils, INPUTS_NUMBER inputs, HOLDING_REGISTERS_NUMBER and INPUT_REGISTERS_NUMBER registers.
+
+    Build and run from the repository root:
+    gcc -std=gnu99 -O2 -Wall -I Tools/MBGateway/host -I ModBusSlave -I Definitions -I Serial -I MyTimers -I Scheduler -I USART -I Delay -o slavetest Tools/MBGateway/slaveTest.c ModBusSlave/mbslave.c ModBusSlave/mbbinding.c ModBusSlave/mbdiagnostics.c ModBusSlave/mbcrc.c
+    ./slavetest
+
+    Exit code is 1 if any response is wrong.
+*/
+#include <stdio.h>
+#include <string.h>
+#include "stm32f4xx.h"
+#include "definitions.h"
+#include "mbslave.h"
+#include "mbcrc.h"
+#include "serial.h"
+#include "delay.h"
+
+#define TEST_REQUEST_MAX_SIZE                   16              // without CRC
+#define TEST_NO_RESPONSE                        0
+
+// One request and the response it must get
+typedef struct slaveTestCase{
+    const char *name;
+    unsigned char request[TEST_REQUEST_MAX_SIZE];
+    int length;                         // bytes of request without CRC, negative for a frame of the bytes only
+    int responseLength;                 // bytes of response with CRC, TEST_NO_RESPONSE if the slave keeps silent
+    unsigned char exception;            // MB_EXCEPTION_NONE for normal response
+}tSlaveTestCase;
+
+static const tSlaveTestCase TestCases[] =
+{
+    // frames shorter than MB_MIN_FRAME_SIZE are dropped, even with good CRC
+    {"1 byte frame", {0x01}, -1, TEST_NO_RESPONSE, 0},
+    {"address and CRC", {0x01}, 1, TEST_NO_RESPONSE, 0},
+    {"address, function, CRC", {0x01, 0x03}, 2, 5, MB_EXCEPTION_ILLEGAL_DATA_VALUE},
+    
+    // length which does not match the function
+    {"FC 3 without quantity", {0x01, 0x03, 0x00, 0x00}, 4, 5, MB_EXCEPTION_ILLEGAL_DATA_VALUE},
+    {"FC 3 with extra byte", {0x01, 0x03, 0x00, 0x00, 0x00, 0x01, 0x00}, 7, 5, MB_EXCEPTION_ILLEGAL_DATA_VALUE},
+    {"FC 16 short data", {0x01, 0x10, 0x00, 0x00, 0x00, 0x02, 0x04, 0x00, 0x01}, 9, 5, MB_EXCEPTION_ILLEGAL_DATA_VALUE},
+    
+    // unknown functions
+    {"FC 7", {0x01, 0x07}, 2, 5, MB_EXCEPTION_ILLEGAL_FUNCTION},
+    {"FC 43", {0x01, 0x2B, 0x0E, 0x01, 0x00}, 5, 5, MB_EXCEPTION_ILLEGAL_FUNCTION},
+    {"FC 0x7F", {0x01, 0x7F, 0x00, 0x00, 0x00, 0x01}, 6, 5, MB_EXCEPTION_ILLEGAL_FUNCTION},
+    
+    // addresses out of the slave's tables
+    {"FC 1 past coils", {0x01, 0x01, 0x07, 0xCF, 0x00, 0x02}, 6, 5, MB_EXCEPTION_ILLEGAL_DATA_ADDRESS},
+    {"FC 2 past inputs", {0x01, 0x02, 0x07, 0xD0, 0x00, 0x01}, 6, 5, MB_EXCEPTION_ILLEGAL_DATA_ADDRESS},
+    {"FC 3 past registers", {0x01, 0x03, 0x00, 0x63, 0x00, 0x02}, 6, 5, MB_EXCEPTION_ILLEGAL_DATA_ADDRESS},
+    {"FC 3 undefined block", {0x01, 0x03, 0x80, 0x00, 0x00, 0x01}, 6, 5, MB_EXCEPTION_ILLEGAL_DATA_ADDRESS},
+    {"FC 4 past registers", {0x01, 0x04, 0x00, 0x64, 0x00, 0x01}, 6, 5, MB_EXCEPTION_ILLEGAL_DATA_ADDRESS},
+    {"FC 5 past coils", {0x01, 0x05, 0x07, 0xD0, 0xFF, 0x00}, 6, 5, MB_EXCEPTION_ILLEGAL_DATA_ADDRESS},
+    {"FC 6 past registers", {0x01, 0x06, 0x00, 0x64, 0x12, 0x34}, 6, 5, MB_EXCEPTION_ILLEGAL_DATA_ADDRESS},
+    {"FC 15 past coils", {0x01, 0x0F, 0x07, 0xCF, 0x00, 0x02, 0x01, 0x03}, 8, 5, MB_EXCEPTION_ILLEGAL_DATA_ADDRESS},
+    {"FC 16 past registers", {0x01, 0x10, 0x00, 0x63, 0x00, 0x02, 0x04, 0x00, 0x01, 0x00, 0x02}, 11, 5, MB_EXCEPTION_ILLEGAL_DATA_ADDRESS},
+    {"FC 23 read past registers", {0x01, 0x17, 0x00, 0x64, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x02, 0x00, 0x01}, 13, 5, MB_EXCEPTION_ILLEGAL_DATA_ADDRESS},
+    {"FC 23 write past registers", {0x01, 0x17, 0x00, 0x00, 0x00, 0x01, 0x00, 0x64, 0x00, 0x01, 0x02, 0x00, 0x01}, 13, 5, MB_EXCEPTION_ILLEGAL_DATA_ADDRESS},
+    
+    // quantities out of the protocol limits
+    {"FC 1 quantity 0", {0x01, 0x01, 0x00, 0x00, 0x00, 0x00}, 6, 5, MB_EXCEPTION_ILLEGAL_DATA_VALUE},
+    {"FC 1 quantity 2001", {0x01, 0x01, 0x00, 0x00, 0x07, 0xD1}, 6, 5, MB_EXCEPTION_ILLEGAL_DATA_VALUE},
+    {"FC 2 quantity 0", {0x01, 0x02, 0x00, 0x00, 0x00, 0x00}, 6, 5, MB_EXCEPTION_ILLEGAL_DATA_VALUE},
+    {"FC 2 quantity 2001", {0x01, 0x02, 0x00, 0x00, 0x07, 0xD1}, 6, 5, MB_EXCEPTION_ILLEGAL_DATA_VALUE},
+    {"FC 3 quantity 0", {0x01, 0x03, 0x00, 0x00, 0x00, 0x00}, 6, 5, MB_EXCEPTION_ILLEGAL_DATA_VALUE},
+    {"FC 3 quantity 126", {0x01, 0x03, 0x00, 0x00, 0x00, 0x7E}, 6, 5, MB_EXCEPTION_ILLEGAL_DATA_VALUE},
+    {"FC 4 quantity 0", {0x01, 0x04, 0x00, 0x00, 0x00, 0x00}, 6, 5, MB_EXCEPTION_ILLEGAL_DATA_VALUE},
+    {"FC 4 quantity 126", {0x01, 0x04, 0x00, 0x00, 0x00, 0x7E}, 6, 5, MB_EXCEPTION_ILLEGAL_DATA_VALUE},
+    {"FC 15 quantity 0", {0x01, 0x0F, 0x00, 0x00, 0x00, 0x00, 0x00}, 7, 5, MB_EXCEPTION_ILLEGAL_DATA_VALUE},
+    {"FC 15 quantity 1969", {0x01, 0x0F, 0x00, 0x00, 0x07, 0xB1, 0x01, 0xFF}, 8, 5, MB_EXCEPTION_ILLEGAL_DATA_VALUE},
+    {"FC 15 byte count", {0x01, 0x0F, 0x00, 0x00, 0x00, 0x09, 0x01, 0xFF}, 8, 5, MB_EXCEPTION_ILLEGAL_DATA_VALUE},
+    {"FC 16 quantity 0", {0x01, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00}, 7, 5, MB_EXCEPTION_ILLEGAL_DATA_VALUE},
+    {"FC 16 quantity 124", {0x01, 0x10, 0x00, 0x00, 0x00, 0x7C, 0x02, 0x00, 0x01}, 9, 5, MB_EXCEPTION_ILLEGAL_DATA_VALUE},
+    {"FC 16 byte count", {0x01, 0x10, 0x00, 0x00, 0x00, 0x02, 0x02, 0x00, 0x01}, 9, 5, MB_EXCEPTION_ILLEGAL_DATA_VALUE},
+    {"FC 23 read quantity 0", {0x01, 0x17, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x02, 0x00, 0x01}, 13, 5, MB_EXCEPTION_ILLEGAL_DATA_VALUE},
+    {"FC 23 read quantity 126", {0x01, 0x17, 0x00, 0x00, 0x00, 0x7E, 0x00, 0x00, 0x00, 0x01, 0x02, 0x00, 0x01}, 13, 5, MB_EXCEPTION_ILLEGAL_DATA_VALUE},
+    {"FC 23 write quantity 0", {0x01, 0x17, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00}, 11, 5, MB_EXCEPTION_ILLEGAL_DATA_VALUE},
+    {"FC 23 write quantity 122", {0x01, 0x17, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x7A, 0x02, 0x00, 0x01}, 13, 5, MB_EXCEPTION_ILLEGAL_DATA_VALUE},
+    {"FC 23 write byte count", {0x01, 0x17, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x02, 0x02, 0x00, 0x01}, 13, 5, MB_EXCEPTION_ILLEGAL_DATA_VALUE},
+    {"FC 5 bad value", {0x01, 0x05, 0x00, 0x00, 0x12, 0x34}, 6, 5, MB_EXCEPTION_ILLEGAL_DATA_VALUE},
+    
+    // requests at the limits are served
+    {"FC 1 last coils", {0x01, 0x01, 0x07, 0xCE, 0x00, 0x02}, 6, 6, MB_EXCEPTION_NONE},
+    {"FC 3 last registers", {0x01, 0x03, 0x00, 0x62, 0x00, 0x02}, 6, 9, MB_EXCEPTION_NONE},
+    {"FC 4 first register", {0x01, 0x04, 0x00, 0x00, 0x00, 0x01}, 6, 7, MB_EXCEPTION_NONE},
+    {"FC 6 last register", {0x01, 0x06, 0x00, 0x63, 0x12, 0x34}, 6, 8, MB_EXCEPTION_NONE},
+    {"FC 23 read and write", {0x01, 0x17, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x02, 0x00, 0x01}, 13, 7, MB_EXCEPTION_NONE},
+    
+    // frames for other devices are not answered
+    {"address 11", {0x0B, 0x03, 0x00, 0x00, 0x00, 0x01}, 6, TEST_NO_RESPONSE, 0},
+};
+#define TEST_CASES_NUMBER                       (sizeof(TestCases) / sizeof(TestCases[0]))
+
+static unsigned char ReceivedByte;
+static unsigned char Response[RESPONSE_SIZE];
+static int ResponseLength;
+
+// ..................Replacements of the firmware's drivers..........................
+
+unsigned char GetByte(int usartID)
+{
+    (void)usartID;
+    return ReceivedByte;
+}
+
+int OutString(unsigned char *Str, int len, int usartID, int timerType, int miliseconds)
+{
+    (void)usartID; (void)timerType; (void)miliseconds;
+    memcpy(Response, Str, len);
+    ResponseLength = len;
+    return len;
+}
+
+void InitUSART2(int modBusUnitType) { (void)modBusUnitType; }
+void InitTIM3(void) { }
+void ModBusTimerEnable(unsigned short miliseconds) { (void)miliseconds; }
+void ModBusTimerDisable(void) { }
+void PostEvent(int event) { (void)event; }
+u32 GetCycleCounter(void) { return 0; }
+u32 CyclesToMicroseconds(u32 cycles) { return cycles / 100; }
+
+/*
+    Send the request with its CRC to the slave engine and take the response
+    int length - bytes without CRC, negative for a frame of the bytes only
+    returns length of the response with CRC, TEST_NO_RESPONSE if there is none
+*/
+static int Transact(const unsigned char *pRequest, int length)
+{
+    unsigned char frame[TEST_REQUEST_MAX_SIZE + 2];
+    unsigned int crc;
+    int frameLength = (length < 0) ? -length : length + 2;
+    int i;
+    
+    memcpy(frame, pRequest, (length < 0) ? -length : length);
+    if(length >= 0)
+    {
+        crc = usMBCRC16(frame, length);
+        frame[length] = (unsigned char)crc;
+        frame[length + 1] = (unsigned char)(crc >> 8);
+    }
+    
+    ResponseLength = TEST_NO_RESPONSE;
+    for(i = 0; i < frameLength; i++)
+    {
+        ReceivedByte = frame[i];
+        MBReceiveFSM();
+    }
+    
+    // end of frame, the scheduler runs the poll task twice - frame check and execution
+    MBTimerExpired();
+    MBPollSlave();
+    MBPollSlave();
+    MB_slave_transmit();
+    
+    return ResponseLength;
+}
+
+static int CheckResponse(const tSlaveTestCase *pCase)
+{
+    int length = Transact(pCase->request, pCase->length);
+    
+    if(length != pCase->responseLength)
+    {
+        printf("%-28s response of %d bytes, expected %d\n", pCase->name, length, pCase->responseLength);
+        return 1;
+    }
+    if(length == TEST_NO_RESPONSE)
+    {
+        return 0;
+    }
+    
+    if(usMBCRC16(Response, length) != 0 || Response[0] != pCase->request[0])
+    {
+        printf("%-28s bad CRC or address\n", pCase->name);
+        return 1;
+    }
+    if(pCase->exception == MB_EXCEPTION_NONE)
+    {
+        if(Response[1] != pCase->request[1])
+        {
+            printf("%-28s function 0x%02X, expected 0x%02X\n", pCase->name, Response[1], pCase->request[1]);
+            return 1;
+        }
+        return 0;
+    }
+    
+    if(Response[1] != (pCase->request[1] | MB_EXCEPTION_FUNCTION_FLAG) || Response[2] != pCase->exception)
+    {
+        printf("%-28s function 0x%02X exception %d, expected 0x%02X exception %d\n", pCase->name, Response[1], Response[2],
+               pCase->request[1] | MB_EXCEPTION_FUNCTION_FLAG, pCase->exception);
+        return 1;
+    }
+    
+    return 0;
+}
+
+int main(void)
+{
+    const tMBSlaveStatistics *pStatistics;
+    unsigned long exceptions = 0;
+    int errors = 0;
+    int i;
+    
+    MBInitHardwareAndProtocol();
+    
+    for(i = 0; i < TEST_CASES_NUMBER; i++)
+    {
+        errors += CheckResponse(&TestCases[i]);
+        if(TestCases[i].responseLength != TEST_NO_RESPONSE && TestCases[i].exception != MB_EXCEPTION_NONE)
+        {
+            exceptions++;
+        }
+    }
+    
+    pStatistics = GetMBSlaveStatistics();
+    if(pStatistics->exceptionsSent != exceptions)
+    {
+        printf("%lu exception responses counted, %lu expected\n", pStatistics->exceptionsSent, exceptions);
+        errors++;
+    }
+    
+    printf("%d requests, %lu exception responses, errors: %d\n", (int)TEST_CASES_NUMBER, exceptions, errors);
+    
+    return errors ? 1 : 0;
+}
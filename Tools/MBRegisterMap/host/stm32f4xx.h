@@ -0,0 +1,17 @@
+/*
+    Host replacement of the device header - only the types and core functions used by the ModBus register map.
+*/
+#ifndef __HOST_STM32F4XX_H
+#define __HOST_STM32F4XX_H
+
+#include <stdint.h>
+
+typedef uint32_t u32;
+
+// single thread on host, there is nothing to mask or order
+static inline uint32_t __get_PRIMASK(void) { return 0; }
+static inline void __set_PRIMASK(uint32_t primask) { (void)primask; }
+static inline void __disable_irq(void) { }
+static inline void __DMB(void) { }
+
+#endif
@@ -0,0 +1,103 @@
+/*
+    Host benchmark of the sparse ModBus register map. ModBusSlave/mbbinding.c is linked alone, one slave gets
+    MAX_REGISTER_BLOCKS blocks spread over the 16-bit address space and single registers are read at random
+    defined addresses, which is the worst case of the block search.
+    
+    Build and run from the repository root:
+    gcc -std=gnu99 -O2 -Wall -I Tools/MBRegisterMap/host -I ModBusSlave -I Definitions -o mbmapbench Tools/MBRegisterMap/registerMapBenchmark.c ModBusSlave/mbbinding.c
+    ./mbmapbench
+    
+    Exit code is 1 if any register is read back wrong or an undefined register is accepted.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "stm32f4xx.h"
+#include "definitions.h"
+#include "mbslave.h"
+#include "mbbinding.h"
+
+#define BENCHMARK_SLAVE                         1
+#define BENCHMARK_BLOCK_SIZE                    16
+#define BENCHMARK_BLOCK_STEP                    8000            // distance of the blocks' starts
+#define BENCHMARK_READS                         10000000
+
+ModBusSlaveUnit ModBusSlaves[MAX_MODBUS_SLAVE_DEVICES];
+
+// Bound block - register value is its address
+static void ReadAddress(unsigned short offset, unsigned short count, unsigned short *pValues)
+{
+    while(count--)
+    {
+        *pValues++ = (unsigned short)(7 * BENCHMARK_BLOCK_STEP + offset++);
+    }
+}
+
+static double NowNs(void)
+{
+    struct timespec now;
+    
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    
+    return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+int main(void)
+{
+    unsigned short addresses[1024], value;
+    unsigned long checksum = 0;
+    double start, elapsed;
+    int i, errors = 0;
+    
+    InitMBBindings();
+    
+    //default block 0 .. 99 is block 0, then 6 memory blocks and one bound block
+    for(i = 1; i < MAX_REGISTER_BLOCKS - 1; i++)
+    {
+        if(MBDefineHoldingRegisters(BENCHMARK_SLAVE, i * BENCHMARK_BLOCK_STEP, BENCHMARK_BLOCK_SIZE) == FALSE)
+        {
+            printf("block %d not defined\n", i);
+            return 1;
+        }
+    }
+    if(MBBindHoldingRegisters(BENCHMARK_SLAVE, i * BENCHMARK_BLOCK_STEP, BENCHMARK_BLOCK_SIZE, ReadAddress, 0) == FALSE)
+    {
+        printf("bound block not defined\n");
+        return 1;
+    }
+    
+    for(i = 0; i < 1024; i++)
+    {
+        addresses[i] = (rand() % MAX_REGISTER_BLOCKS) * BENCHMARK_BLOCK_STEP + rand() % BENCHMARK_BLOCK_SIZE;
+        
+        value = addresses[i];
+        if(addresses[i] < 7 * BENCHMARK_BLOCK_STEP && MBWriteHoldingRegisters(BENCHMARK_SLAVE, addresses[i], 1, &value) != MB_EXCEPTION_NONE)
+        {
+            errors++;
+        }
+    }
+    
+    //registers between the blocks and the end of the address space are not defined
+    if(MBReadHoldingRegisters(BENCHMARK_SLAVE, BENCHMARK_BLOCK_SIZE + 100, 1, &value) == MB_EXCEPTION_NONE ||
+       MBReadHoldingRegisters(BENCHMARK_SLAVE, 0xFFFF, 1, &value) == MB_EXCEPTION_NONE ||
+       MBReadHoldingRegisters(BENCHMARK_SLAVE, BENCHMARK_BLOCK_STEP + BENCHMARK_BLOCK_SIZE - 1, 2, &value) == MB_EXCEPTION_NONE)
+    {
+        errors++;
+    }
+    
+    start = NowNs();
+    for(i = 0; i < BENCHMARK_READS; i++)
+    {
+        if(MBReadHoldingRegisters(BENCHMARK_SLAVE, addresses[i & 1023], 1, &value) != MB_EXCEPTION_NONE || value != addresses[i & 1023])
+        {
+            errors++;
+        }
+        checksum += value;
+    }
+    elapsed = NowNs() - start;
+    
+    printf("%d blocks, %d single register reads: %.1f ns per read (checksum %lu)\n", MAX_REGISTER_BLOCKS, BENCHMARK_READS, elapsed / BENCHMARK_READS, checksum);
+    printf("errors: %d\n", errors);
+    
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,84 @@
+/*
+    Host replacement of the peripheral library - GPIO, RCC, ADC and DAC declarations used by the pin map
+    and the Init* functions. The check records GPIO_Init() and RCC_AHB1PeriphClockCmd() calls.
+*/
+#ifndef __HOST_STM32F4XX_CONF_H
+#define __HOST_STM32F4XX_CONF_H
+
+#include <stdint.h>
+
+typedef uint32_t u32;
+typedef uint16_t u16;
+typedef uint8_t u8;
+typedef int32_t s32;
+
+typedef enum {DISABLE = 0, ENABLE = !DISABLE} FunctionalState;
+
+typedef struct
+{
+    char name;                          // 'A' ... 'E'
+}GPIO_TypeDef;
+
+typedef struct
+{
+    int number;                         // 1 ... 3
+}ADC_TypeDef;
+
+extern GPIO_TypeDef HostGPIOA, HostGPIOB, HostGPIOC, HostGPIOD, HostGPIOE;
+extern ADC_TypeDef HostADC1, HostADC2, HostADC3;
+
+#define GPIOA                           (&HostGPIOA)
+#define GPIOB                           (&HostGPIOB)
+#define GPIOC                           (&HostGPIOC)
+#define GPIOD                           (&HostGPIOD)
+#define GPIOE                           (&HostGPIOE)
+#define ADC1                            (&HostADC1)
+#define ADC2                            (&HostADC2)
+#define ADC3                            (&HostADC3)
+
+typedef enum {GPIO_Mode_IN = 0x00, GPIO_Mode_OUT = 0x01, GPIO_Mode_AF = 0x02, GPIO_Mode_AN = 0x03} GPIOMode_TypeDef;
+typedef enum {GPIO_OType_PP = 0x00, GPIO_OType_OD = 0x01} GPIOOType_TypeDef;
+typedef enum {GPIO_Speed_2MHz = 0x00, GPIO_Speed_25MHz = 0x01, GPIO_Speed_50MHz = 0x02, GPIO_Speed_100MHz = 0x03} GPIOSpeed_TypeDef;
+typedef enum {GPIO_PuPd_NOPULL = 0x00, GPIO_PuPd_UP = 0x01, GPIO_PuPd_DOWN = 0x02} GPIOPuPd_TypeDef;
+
+typedef struct
+{
+    uint32_t GPIO_Pin;
+    GPIOMode_TypeDef GPIO_Mode;
+    GPIOSpeed_TypeDef GPIO_Speed;
+    GPIOOType_TypeDef GPIO_OType;
+    GPIOPuPd_TypeDef GPIO_PuPd;
+}GPIO_InitTypeDef;
+
+#define GPIO_Pin_0                      ((uint16_t)0x0001)
+#define GPIO_Pin_1                      ((uint16_t)0x0002)
+#define GPIO_Pin_2                      ((uint16_t)0x0004)
+#define GPIO_Pin_3                      ((uint16_t)0x0008)
+#define GPIO_Pin_4                      ((uint16_t)0x0010)
+#define GPIO_Pin_5                      ((uint16_t)0x0020)
+#define GPIO_Pin_6                      ((uint16_t)0x0040)
+#define GPIO_Pin_7                      ((uint16_t)0x0080)
+#define GPIO_Pin_8                      ((uint16_t)0x0100)
+#define GPIO_Pin_9                      ((uint16_t)0x0200)
+#define GPIO_Pin_10                     ((uint16_t)0x0400)
+#define GPIO_Pin_11                     ((uint16_t)0x0800)
+#define GPIO_Pin_12                     ((uint16_t)0x1000)
+#define GPIO_Pin_13                     ((uint16_t)0x2000)
+#define GPIO_Pin_14                     ((uint16_t)0x4000)
+#define GPIO_Pin_15                     ((uint16_t)0x8000)
+
+#define RCC_AHB1Periph_GPIOA            ((uint32_t)0x00000001)
+#define RCC_AHB1Periph_GPIOB            ((uint32_t)0x00000002)
+#define RCC_AHB1Periph_GPIOC            ((uint32_t)0x00000004)
+#define RCC_AHB1Periph_GPIOD            ((uint32_t)0x00000008)
+#define RCC_AHB1Periph_GPIOE            ((uint32_t)0x00000010)
+
+#define DAC_Channel_1                   ((uint32_t)0x00000000)
+#define DAC_Channel_2                   ((uint32_t)0x00000010)
+
+#define assert_param(expr)              ((void)0)
+
+void GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_InitStruct);
+void RCC_AHB1PeriphClockCmd(uint32_t RCC_AHB1Periph, FunctionalState NewState);
+
+#endif
@@ -0,0 +1,323 @@
+/*
+    Host check of the pin descriptor table. Definitions/pinMap.c and Definitions/initPeripheral.c are linked
+    against recording GPIO and RCC functions and compared with the pin assignments of the switch statements
+    the table replaced: port, pin, clock, mode, pull and ADC/DAC channel of every ID, in the table and in what
+    the Init* functions configure. Baseline keeps the old values as they were, the intentional changes are
+    listed in Deviations.
+
+    Build and run from the repository root:
+    gcc -std=gnu99 -Wall -I Tools/PinMapCheck/host -I Definitions -I ADC -I DAC -o pinmapcheck Tools/PinMapCheck/pinMapCheck.c Definitions/pinMap.c Definitions/initPeripheral.c
+    ./pinmapcheck
+
+    Exit code is 1 if any value differs from the baseline other than by a listed deviation.
+*/
+#include <stdio.h>
+#include <stdint.h>
+#include "stm32f4xx_conf.h"
+#include "definitions.h"
+#include "pinMap.h"
+#include "initPeripheral.h"
+
+typedef enum
+{
+    FIELD_PORT,
+    FIELD_PIN,
+    FIELD_CLOCK,
+    FIELD_MODE,
+    FIELD_PULL,
+    FIELD_ADC,
+    FIELD_CHANNEL,
+    FIELDS_NUMBER
+}eField;
+
+typedef struct baselinePinStructure{
+    int id;
+    const char *name;
+    tPinDescriptor pin;
+}tBaselinePin;
+
+typedef struct deviationStructure{
+    int id;
+    eField field;
+    uintptr_t value;                    // value in the table instead of the baseline one
+    const char *reason;
+}tDeviation;
+
+GPIO_TypeDef HostGPIOA = {'A'}, HostGPIOB = {'B'}, HostGPIOC = {'C'}, HostGPIOD = {'D'}, HostGPIOE = {'E'};
+ADC_TypeDef HostADC1 = {1}, HostADC2 = {2}, HostADC3 = {3};
+
+static const char *FieldNames[FIELDS_NUMBER] = {"port", "pin", "clock", "mode", "pull", "ADC", "channel"};
+
+/*
+    Pins as the switch statements of initPeripheral.c configured them, ADC and DAC channels of userLibrary.c
+*/
+static const tBaselinePin Baseline[] =
+{
+    {BUTTON_1,   "BUTTON_1",   {GPIOC, GPIO_Pin_6,   RCC_AHB1Periph_GPIOC, GPIO_Mode_IN,  GPIO_PuPd_NOPULL, 0, 0}},
+    {BUTTON_2,   "BUTTON_2",   {GPIOC, GPIO_Pin_8,   RCC_AHB1Periph_GPIOC, GPIO_Mode_IN,  GPIO_PuPd_NOPULL, 0, 0}},
+    {BUTTON_3,   "BUTTON_3",   {GPIOC, GPIO_Pin_9,   RCC_AHB1Periph_GPIOC, GPIO_Mode_IN,  GPIO_PuPd_NOPULL, 0, 0}},
+    {BUTTON_4,   "BUTTON_4",   {GPIOD, GPIO_Pin_11,  RCC_AHB1Periph_GPIOD, GPIO_Mode_IN,  GPIO_PuPd_NOPULL, 0, 0}},
+    {BUTTON_5,   "BUTTON_5",   {GPIOA, GPIO_Pin_8,   RCC_AHB1Periph_GPIOA, GPIO_Mode_IN,  GPIO_PuPd_NOPULL, 0, 0}},
+    {BUTTON_6,   "BUTTON_6",   {GPIOD, GPIO_Pin_0,   RCC_AHB1Periph_GPIOD, GPIO_Mode_IN,  GPIO_PuPd_NOPULL, 0, 0}},
+    {BUTTON_7,   "BUTTON_7",   {GPIOE, GPIO_Pin_1,   RCC_AHB1Periph_GPIOE, GPIO_Mode_IN,  GPIO_PuPd_NOPULL, 0, 0}},
+    {BUTTON_8,   "BUTTON_8",   {GPIOE, GPIO_Pin_0,   RCC_AHB1Periph_GPIOE, GPIO_Mode_IN,  GPIO_PuPd_NOPULL, 0, 0}},
+    {LED_1,      "LED_1",      {GPIOD, GPIO_Pin_15,  RCC_AHB1Periph_GPIOD, GPIO_Mode_OUT, GPIO_PuPd_UP,     0, 0}},
+    {LED_2,      "LED_2",      {GPIOD, GPIO_Pin_13,  RCC_AHB1Periph_GPIOD, GPIO_Mode_OUT, GPIO_PuPd_UP,     0, 0}},
+    {LED_3,      "LED_3",      {GPIOD, GPIO_Pin_14,  RCC_AHB1Periph_GPIOD, GPIO_Mode_OUT, GPIO_PuPd_UP,     0, 0}},
+    {LED_4,      "LED_4",      {GPIOD, GPIO_Pin_12,  RCC_AHB1Periph_GPIOD, GPIO_Mode_OUT, GPIO_PuPd_UP,     0, 0}},
+    {LED_5,      "LED_5",      {GPIOC, GPIO_Pin_11,  RCC_AHB1Periph_GPIOC, GPIO_Mode_OUT, GPIO_PuPd_UP,     0, 0}},
+    {LED_6,      "LED_6",      {GPIOD, GPIO_Pin_2,   RCC_AHB1Periph_GPIOD, GPIO_Mode_OUT, GPIO_PuPd_UP,     0, 0}},
+    {LED_7,      "LED_7",      {GPIOB, GPIO_Pin_3,   RCC_AHB1Periph_GPIOB, GPIO_Mode_OUT, GPIO_PuPd_UP,     0, 0}},
+    {LED_8,      "LED_8",      {GPIOB, GPIO_Pin_7,   RCC_AHB1Periph_GPIOB, GPIO_Mode_OUT, GPIO_PuPd_UP,     0, 0}},
+    {TRIMMER_1,  "TRIMMER_1",  {GPIOC, GPIO_Pin_1,   RCC_AHB1Periph_GPIOC, GPIO_Mode_AN,  GPIO_PuPd_NOPULL, ADC3, 11}},
+    {TRIMMER_2,  "TRIMMER_2",  {GPIOA, GPIO_Pin_1,   RCC_AHB1Periph_GPIOA, GPIO_Mode_AN,  GPIO_PuPd_NOPULL, ADC3, 1}},
+    {TRIMMER_3,  "TRIMMER_3",  {GPIOC, GPIO_Pin_2,   RCC_AHB1Periph_GPIOC, GPIO_Mode_AN,  GPIO_PuPd_NOPULL, ADC3, 12}},
+    {SWITCH_1,   "SWITCH_1",   {GPIOE, GPIO_Pin_14,  RCC_AHB1Periph_GPIOC, GPIO_Mode_IN,  GPIO_PuPd_NOPULL, 0, 0}},
+    {SWITCH_2,   "SWITCH_2",   {GPIOE, GPIO_Pin_15,  RCC_AHB1Periph_GPIOC, GPIO_Mode_IN,  GPIO_PuPd_NOPULL, 0, 0}},
+    {INPUT_1,    "INPUT_1",    {GPIOC, GPIO_Pin_13,  RCC_AHB1Periph_GPIOC, GPIO_Mode_IN,  GPIO_PuPd_NOPULL, 0, 0}},
+    {INPUT_2,    "INPUT_2",    {GPIOE, GPIO_Pin_5,   RCC_AHB1Periph_GPIOE, GPIO_Mode_IN,  GPIO_PuPd_NOPULL, 0, 0}},
+    {INPUT_3,    "INPUT_3",    {GPIOB, GPIO_Pin_8,   RCC_AHB1Periph_GPIOB, GPIO_Mode_IN,  GPIO_PuPd_NOPULL, 0, 0}},
+    {INPUT_4,    "INPUT_4",    {GPIOB, GPIO_Pin_4,   RCC_AHB1Periph_GPIOB, GPIO_Mode_IN,  GPIO_PuPd_NOPULL, 0, 0}},
+    {INPUT_5,    "INPUT_5",    {GPIOD, GPIO_Pin_7,   RCC_AHB1Periph_GPIOD, GPIO_Mode_IN,  GPIO_PuPd_NOPULL, 0, 0}},
+    {INPUT_6,    "INPUT_6",    {GPIOD, GPIO_Pin_3,   RCC_AHB1Periph_GPIOD, GPIO_Mode_IN,  GPIO_PuPd_NOPULL, 0, 0}},
+    {INPUT_7,    "INPUT_7",    {GPIOD, GPIO_Pin_1,   RCC_AHB1Periph_GPIOD, GPIO_Mode_IN,  GPIO_PuPd_NOPULL, 0, 0}},
+    {INPUT_8,    "INPUT_8",    {GPIOA, GPIO_Pin_10,  RCC_AHB1Periph_GPIOA, GPIO_Mode_IN,  GPIO_PuPd_NOPULL, 0, 0}},
+    {INPUT_9,    "INPUT_9",    {GPIOE, GPIO_Pin_6,   RCC_AHB1Periph_GPIOE, GPIO_Mode_IN,  GPIO_PuPd_NOPULL, 0, 0}},
+    {INPUT_10,   "INPUT_10",   {GPIOE, GPIO_Pin_4,   RCC_AHB1Periph_GPIOE, GPIO_Mode_IN,  GPIO_PuPd_NOPULL, 0, 0}},
+    {INPUT_11,   "INPUT_11",   {GPIOE, GPIO_Pin_2,   RCC_AHB1Periph_GPIOE, GPIO_Mode_IN,  GPIO_PuPd_NOPULL, 0, 0}},
+    {INPUT_12,   "INPUT_12",   {GPIOB, GPIO_Pin_6,   RCC_AHB1Periph_GPIOB, GPIO_Mode_IN,  GPIO_PuPd_NOPULL, 0, 0}},
+    {INPUT_13,   "INPUT_13",   {GPIOB, GPIO_Pin_5,   RCC_AHB1Periph_GPIOB, GPIO_Mode_IN,  GPIO_PuPd_NOPULL, 0, 0}},
+    {INPUT_14,   "INPUT_14",   {GPIOD, GPIO_Pin_6,   RCC_AHB1Periph_GPIOD, GPIO_Mode_IN,  GPIO_PuPd_NOPULL, 0, 0}},
+    {INPUT_15,   "INPUT_15",   {GPIOD, GPIO_Pin_4,   RCC_AHB1Periph_GPIOD, GPIO_Mode_IN,  GPIO_PuPd_NOPULL, 0, 0}},
+    {INPUT_16,   "INPUT_16",   {GPIOC, GPIO_Pin_12,  RCC_AHB1Periph_GPIOC, GPIO_Mode_IN,  GPIO_PuPd_NOPULL, 0, 0}},
+    {OUTPUT_1,   "OUTPUT_1",   {GPIOB, GPIO_Pin_1,   RCC_AHB1Periph_GPIOB, GPIO_Mode_OUT, GPIO_PuPd_UP,     0, 0}},
+    {OUTPUT_2,   "OUTPUT_2",   {GPIOE, GPIO_Pin_7,   RCC_AHB1Periph_GPIOE, GPIO_Mode_OUT, GPIO_PuPd_UP,     0, 0}},
+    {OUTPUT_3,   "OUTPUT_3",   {GPIOE, GPIO_Pin_9,   RCC_AHB1Periph_GPIOE, GPIO_Mode_OUT, GPIO_PuPd_UP,     0, 0}},
+    {OUTPUT_4,   "OUTPUT_4",   {GPIOB, GPIO_Pin_11,  RCC_AHB1Periph_GPIOB, GPIO_Mode_OUT, GPIO_PuPd_UP,     0, 0}},
+    {OUTPUT_5,   "OUTPUT_5",   {GPIOE, GPIO_Pin_15,  RCC_AHB1Periph_GPIOE, GPIO_Mode_OUT, GPIO_PuPd_UP,     0, 0}},
+    {OUTPUT_6,   "OUTPUT_6",   {GPIOE, GPIO_Pin_13,  RCC_AHB1Periph_GPIOE, GPIO_Mode_OUT, GPIO_PuPd_UP,     0, 0}},
+    {OUTPUT_7,   "OUTPUT_7",   {GPIOE, GPIO_Pin_11,  RCC_AHB1Periph_GPIOE, GPIO_Mode_OUT, GPIO_PuPd_UP,     0, 0}},
+    {OUTPUT_8,   "OUTPUT_8",   {GPIOC, GPIO_Pin_3,   RCC_AHB1Periph_GPIOC, GPIO_Mode_OUT, GPIO_PuPd_UP,     0, 0}},
+    {OUTPUT_9,   "OUTPUT_9",   {GPIOB, GPIO_Pin_0,   RCC_AHB1Periph_GPIOB, GPIO_Mode_OUT, GPIO_PuPd_UP,     0, 0}},
+    {OUTPUT_10,  "OUTPUT_10",  {GPIOD, GPIO_Pin_10,  RCC_AHB1Periph_GPIOD, GPIO_Mode_OUT, GPIO_PuPd_UP,     0, 0}},
+    {OUTPUT_11,  "OUTPUT_11",  {GPIOE, GPIO_Pin_8,   RCC_AHB1Periph_GPIOE, GPIO_Mode_OUT, GPIO_PuPd_UP,     0, 0}},
+    {OUTPUT_12,  "OUTPUT_12",  {GPIOE, GPIO_Pin_10,  RCC_AHB1Periph_GPIOE, GPIO_Mode_OUT, GPIO_PuPd_UP,     0, 0}},
+    {OUTPUT_13,  "OUTPUT_13",  {GPIOB, GPIO_Pin_10,  RCC_AHB1Periph_GPIOB, GPIO_Mode_OUT, GPIO_PuPd_UP,     0, 0}},
+    {OUTPUT_14,  "OUTPUT_14",  {GPIOE, GPIO_Pin_14,  RCC_AHB1Periph_GPIOE, GPIO_Mode_OUT, GPIO_PuPd_UP,     0, 0}},
+    {OUTPUT_15,  "OUTPUT_15",  {GPIOE, GPIO_Pin_12,  RCC_AHB1Periph_GPIOB, GPIO_Mode_OUT, GPIO_PuPd_UP,     0, 0}},
+    {OUTPUT_16,  "OUTPUT_16",  {GPIOA, GPIO_Pin_9,   RCC_AHB1Periph_GPIOA, GPIO_Mode_OUT, GPIO_PuPd_UP,     0, 0}},
+    {ADC_1,      "ADC_1",      {GPIOC, GPIO_Pin_4,   RCC_AHB1Periph_GPIOC, GPIO_Mode_AN,  GPIO_PuPd_NOPULL, ADC1, 14}},
+    {ADC_2,      "ADC_2",      {GPIOC, GPIO_Pin_5,   RCC_AHB1Periph_GPIOC, GPIO_Mode_AN,  GPIO_PuPd_NOPULL, ADC2, 15}},
+    {DAC_1,      "DAC_1",      {GPIOA, GPIO_Pin_4,   RCC_AHB1Periph_GPIOA, GPIO_Mode_AN,  GPIO_PuPd_NOPULL, 0, DAC_Channel_1}},
+    {DAC_2,      "DAC_2",      {GPIOA, GPIO_Pin_5,   RCC_AHB1Periph_GPIOA, GPIO_Mode_AN,  GPIO_PuPd_NOPULL, 0, DAC_Channel_2}},
+};
+#define BASELINE_SIZE                           (sizeof(Baseline) / sizeof(Baseline[0]))
+
+static const tDeviation Deviations[] =
+{
+    {SWITCH_1, FIELD_PORT, (uintptr_t)GPIOC, "init configured PE14, the switch is read from PC14"},
+    {SWITCH_2, FIELD_PORT, (uintptr_t)GPIOC, "init configured PE15, the switch is read from PC15"},
+    {OUTPUT_15, FIELD_CLOCK, RCC_AHB1Periph_GPIOE, "PE12 was configured with the clock of GPIOB"},
+};
+#define DEVIATIONS_SIZE                         (sizeof(Deviations) / sizeof(Deviations[0]))
+
+// Calls of the peripheral library made by the last Init* function
+static GPIO_TypeDef *initPort;
+static GPIO_InitTypeDef initStructure;
+static uint32_t enabledClocks;
+static ADC_TypeDef *initADC;
+static int initDACChannel;
+static int initCalls;
+static int errors;
+
+void GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_InitStruct)
+{
+    initPort = GPIOx;
+    initStructure = *GPIO_InitStruct;
+    initCalls++;
+}
+
+void RCC_AHB1PeriphClockCmd(uint32_t RCC_AHB1Periph, FunctionalState NewState)
+{
+    if(NewState == ENABLE)
+    {
+        enabledClocks |= RCC_AHB1Periph;
+    }
+}
+
+void Init_ADC1(void) { initADC = ADC1; }
+void Init_ADC2(void) { initADC = ADC2; }
+void Init_ADC3(void) { initADC = ADC3; }
+void Init_DAC_1(int initValue) { initDACChannel = DAC_Channel_1; }
+void Init_DAC_2(int initValue) { initDACChannel = DAC_Channel_2; }
+
+static uintptr_t GetField(const tPinDescriptor *pPin, eField field)
+{
+    switch(field)
+    {
+    case FIELD_PORT:
+        return (uintptr_t)pPin->port;
+    case FIELD_PIN:
+        return pPin->pin;
+    case FIELD_CLOCK:
+        return pPin->clock;
+    case FIELD_MODE:
+        return pPin->mode;
+    case FIELD_PULL:
+        return pPin->pull;
+    case FIELD_ADC:
+        return (uintptr_t)pPin->adc;
+    default:
+        return pPin->channel;
+    }
+}
+
+static const char *GetName(int id)
+{
+    int i;
+    
+    for(i = 0; i < BASELINE_SIZE; i++)
+    {
+        if(Baseline[i].id == id)
+        {
+            return Baseline[i].name;
+        }
+    }
+    
+    return "?";
+}
+
+static const tDeviation *FindDeviation(int id, eField field)
+{
+    int i;
+    
+    for(i = 0; i < DEVIATIONS_SIZE; i++)
+    {
+        if(Deviations[i].id == id && Deviations[i].field == field)
+        {
+            return &Deviations[i];
+        }
+    }
+    
+    return 0;
+}
+
+static void Check(const char *name, const char *what, eField field, uintptr_t value, uintptr_t expected)
+{
+    if(value != expected)
+    {
+        printf("%-10s %s %s: 0x%lX, expected 0x%lX\n", name, what, FieldNames[field], (unsigned long)value, (unsigned long)expected);
+        errors++;
+    }
+}
+
+// Configure the pin by its own Init* function
+static void InitByID(int id)
+{
+    initPort = 0;
+    enabledClocks = 0;
+    initADC = 0;
+    initDACChannel = -1;
+    initCalls = 0;
+    
+    if(id >= BUTTON_1 && id <= BUTTON_8)
+    {
+        InitButton(id);
+    }
+    else if(id >= LED_1 && id <= LED_8)
+    {
+        InitLED(id);
+    }
+    else if(id >= TRIMMER_1 && id <= TRIMMER_3)
+    {
+        InitTrimmer(id);
+    }
+    else if(id >= SWITCH_1 && id <= SWITCH_2)
+    {
+        InitSwitch(id);
+    }
+    else if(id >= INPUT_1 && id <= INPUT_16)
+    {
+        InitInput(id);
+    }
+    else if(id >= OUTPUT_1 && id <= OUTPUT_16)
+    {
+        InitOutput(id);
+    }
+    else if(id >= ADC_1 && id <= ADC_2)
+    {
+        InitADC(id);
+    }
+    else
+    {
+        InitDAC(id, 0);
+    }
+}
+
+int main(void)
+{
+    const tBaselinePin *pBaseline;
+    const tPinDescriptor *pPin;
+    const tDeviation *pDeviation;
+    uintptr_t expected;
+    int i, field;
+    
+    if(BASELINE_SIZE != PIN_MAP_SIZE - 1)
+    {
+        printf("PinMap has %d IDs, baseline %d\n", PIN_MAP_SIZE - 1, (int)BASELINE_SIZE);
+        errors++;
+    }
+    
+    for(i = 0; i < BASELINE_SIZE; i++)
+    {
+        pBaseline = &Baseline[i];
+        pPin = &PinMap[pBaseline->id];
+    
+        // table against the baseline
+        for(field = 0; field < FIELDS_NUMBER; field++)
+        {
+            expected = GetField(&pBaseline->pin, field);
+            pDeviation = FindDeviation(pBaseline->id, field);
+            if(pDeviation != 0)
+            {
+                if(expected == pDeviation->value)
+                {
+                    printf("%-10s deviation of %s is in the baseline already\n", pBaseline->name, FieldNames[field]);
+                    errors++;
+                }
+                expected = pDeviation->value;
+            }
+            Check(pBaseline->name, "table", field, GetField(pPin, field), expected);
+        }
+    
+        // Init* function against the table
+        InitByID(pBaseline->id);
+        if(initCalls != 1)
+        {
+            printf("%-10s init configured %d pins\n", pBaseline->name, initCalls);
+            errors++;
+            continue;
+        }
+        Check(pBaseline->name, "init", FIELD_PORT, (uintptr_t)initPort, (uintptr_t)pPin->port);
+        Check(pBaseline->name, "init", FIELD_PIN, initStructure.GPIO_Pin, pPin->pin);
+        Check(pBaseline->name, "init", FIELD_CLOCK, enabledClocks, pPin->clock);
+        Check(pBaseline->name, "init", FIELD_MODE, initStructure.GPIO_Mode, pPin->mode);
+        Check(pBaseline->name, "init", FIELD_PULL, initStructure.GPIO_PuPd, pPin->pull);
+        if(pPin->adc != 0)
+        {
+            Check(pBaseline->name, "init", FIELD_ADC, (uintptr_t)initADC, (uintptr_t)pPin->adc);
+        }
+        if(pBaseline->id == DAC_1 || pBaseline->id == DAC_2)
+        {
+            Check(pBaseline->name, "init", FIELD_CHANNEL, initDACChannel, pPin->channel);
+        }
+    }
+    
+    for(i = 0; i < DEVIATIONS_SIZE; i++)
+    {
+        printf("deviation: %s %s - %s\n", GetName(Deviations[i].id), FieldNames[Deviations[i].field], Deviations[i].reason);
+    }
+    printf("%d IDs checked, errors: %d\n", (int)BASELINE_SIZE, errors);
+    
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,17 @@
+/*
+    Host replacement of the device header - the types and core functions used by the scheduler.
+    Interrupt masking does nothing, simulated interrupts come only from the simulation, __WFI() is its idle.
+*/
+#ifndef __HOST_STM32F4XX_H
+#define __HOST_STM32F4XX_H
+
+#include <stdint.h>
+
+typedef uint32_t u32;
+typedef int32_t s32;
+
+static inline void __disable_irq(void) { }
+static inline void __enable_irq(void) { }
+void __WFI(void);
+
+#endif
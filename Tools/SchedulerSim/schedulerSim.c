@@ -0,0 +1,421 @@
+/*
+    Host simulation of the main loop. Scheduler/scheduler.c is linked against a virtual clock: the DWT cycle
+    counter runs at SIM_HCLK_MHZ, TIM2 counts its milliseconds and __WFI() jumps to the next interrupt or the wake
+    alarm. The tasks of main() are registered in the same order and burn the execution times set below
+    (the LCD part is the bus time of the host LCD benchmark). Both slave ports work as the port engine of mbslave.c:
+    the end of frame interrupt queues EV_FRAME_RECEIVED, the poll task checks the frame and queues EV_EXECUTE
+    for the next pass, then the request is executed and the transmit task sends the response. The master
+    sends its next request a random time after the response.
+    The statistics are printed as the board keeps them - execution times, missed deadlines, event latency and idle time.
+
+    Build and run from the repository root:
+    gcc -std=gnu99 -Wall -I Tools/SchedulerSim/host -I Scheduler -I Definitions -I VTimers -I MyTimers -I Delay -o schedsim Tools/SchedulerSim/schedulerSim.c Scheduler/scheduler.c -lm
+    ./schedsim
+
+    Exit code is 1 if any task never ran, a port event was not handled in the next pass, a periodic task
+    missed its deadline or the event latency is over SIM_LATENCY_BUDGET_US.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "stm32f4xx.h"
+#include "definitions.h"
+#include "VTimer.h"
+#include "mytim.h"
+#include "delay.h"
+#include "scheduler.h"
+
+#define SIM_HCLK_MHZ                            100
+#define SIM_CYCLES_PER_MS                       (SIM_HCLK_MHZ * 1000ULL)
+#define SIM_TIME_MS                             60000           // one minute of the loop
+#define SIM_LATENCY_BUDGET_US                   2000            // from an interrupt to the pass which handles it
+
+// Execution times of the tasks, us - estimates but the LCD part
+#define SIM_VTIMER_TIME                         2
+#define SIM_IO_SCAN_TIME                        3
+#define SIM_FRAME_CHECK_TIME                    15              // EV_FRAME_RECEIVED: address and CRC
+#define SIM_EXECUTE_TIME                        30              // EV_EXECUTE: request parsed and response built
+#define SIM_TRANSMIT_TIME                       10
+#define SIM_DISPLAY_TIME                        5               // page buttons polled
+#define SIM_DISPLAY_FORMAT_TIME                 80              // page formatted into the frame
+#define SIM_LCD_PART_TIME                       1323            // "display task part" of the host LCD benchmark
+#define SIM_LCD_PARTS                           8               // DISPLAY_FRAME_SIZE / DISPLAY_CHARS_PER_RUN
+#define SIM_LCD_REFRESH_PERIOD                  500             // ms, LCD_REFRESH_PERIOD
+#define SIM_DISPLAY_PERIOD                      10              // ms, DISPLAY_TASK_PERIOD
+
+// Port events of mbslave.c
+typedef enum{
+    eSimNoEvent = 0,
+    eSimFrameReceived,
+    eSimExecute
+}tSimPortEvent;
+
+// Slave port with its master, the master waits for the response before the next request
+typedef struct simPortStructure{
+    const char *name;
+    int event;
+    u32 period;                         // ms, mean time from a response to the next request
+    unsigned long long next;            // cycles of the next end of frame, ~0 while the master waits
+    unsigned long long frameCycles;     // end of the frame which is served
+    tSimPortEvent queuedEvent;
+    BOOL isResponseReady;
+    
+    unsigned long frames;
+    unsigned long responses;
+    unsigned long long totalResponseCycles;
+    unsigned long long maxResponseCycles;
+    
+    // posts of the port event, the poll task takes all posts made before its pass
+    unsigned long posts;
+    unsigned long passPosts;            // posts before the current pass
+    unsigned long takenPosts;
+    unsigned long pendingPasses;        // passes which started with the event pending
+    unsigned long pollRuns;
+    unsigned long lostEvents;
+}tSimPort;
+
+static tSimPort SimPorts[] =
+{
+    {"ModBus", EVENT_MODBUS, 20},       // ModBus master polling the board
+    {"RS232", EVENT_RS232, 100},        // terminal on RS232
+};
+#define SIM_PORTS_NUMBER                        (sizeof(SimPorts) / sizeof(SimPorts[0]))
+
+static unsigned long long SimCycles;
+static u32 wakeAlarm;
+static BOOL isWakeAlarmSet;
+static u32 nextRefresh = SIM_LCD_REFRESH_PERIOD;
+static BOOL isRefreshPending;
+static int lcdPart = SIM_LCD_PARTS;
+
+// Exponential time with the mean of period ms
+static unsigned long long RandomCycles(u32 period)
+{
+    double u = (rand() + 1.0) / (RAND_MAX + 2.0);
+    
+    return 1 + (unsigned long long)(-(double)period * SIM_CYCLES_PER_MS * log(u));
+}
+
+static void SimPostEvent(tSimPort *pPort)
+{
+    pPort->posts++;
+    PostEvent(pPort->event);
+}
+
+// Run the end of frame interrupts which come until the cycle counter reaches until
+static void RunInterrupts(unsigned long long until)
+{
+    tSimPort *pFirst;
+    int i;
+    
+    while(1)
+    {
+        pFirst = &SimPorts[0];
+        for(i = 1; i < SIM_PORTS_NUMBER; i++)
+        {
+            if(SimPorts[i].next < pFirst->next)
+            {
+                pFirst = &SimPorts[i];
+            }
+        }
+        if(pFirst->next > until)
+        {
+            return;
+        }
+    
+        SimCycles = pFirst->next;
+        pFirst->next = ~0ULL;
+        pFirst->frames++;
+        pFirst->frameCycles = SimCycles;
+        pFirst->queuedEvent = eSimFrameReceived;
+        SimPostEvent(pFirst);
+    }
+}
+
+// Task code takes this time, interrupts which come meanwhile post their events
+static void Burn(u32 microseconds)
+{
+    unsigned long long end = SimCycles + (unsigned long long)microseconds * SIM_HCLK_MHZ;
+    
+    RunInterrupts(end);
+    SimCycles = end;
+}
+
+/*
+    Hardware of the scheduler
+*/
+u32 GetCycleCounter(void)
+{
+    return (u32)SimCycles;
+}
+
+u32 GetTimerCounter(void)
+{
+    return (u32)(SimCycles / SIM_CYCLES_PER_MS);
+}
+
+BOOL SetWakeAlarm(u32 counter)
+{
+    if((s32)(counter - GetTimerCounter()) <= 0)
+    {
+        return FALSE;
+    }
+    
+    wakeAlarm = counter;
+    isWakeAlarmSet = TRUE;
+    return TRUE;
+}
+
+// Sleep until the next interrupt, the wake alarm of TIM2 posts EVENT_TIMER
+void __WFI(void)
+{
+    unsigned long long alarm = ~0ULL;
+    unsigned long long first = ~0ULL;
+    int i;
+    
+    if(isWakeAlarmSet == TRUE)
+    {
+        alarm = (SimCycles / SIM_CYCLES_PER_MS + (u32)(wakeAlarm - GetTimerCounter())) * SIM_CYCLES_PER_MS;
+    }
+    
+    for(i = 0; i < SIM_PORTS_NUMBER; i++)
+    {
+        if(SimPorts[i].next < first)
+        {
+            first = SimPorts[i].next;
+        }
+    }
+    if(first <= alarm)
+    {
+        RunInterrupts(first);
+        return;
+    }
+    
+    SimCycles = alarm;
+    isWakeAlarmSet = FALSE;
+    PostEvent(EVENT_TIMER);
+}
+
+/*
+    VTimers: the wheel is empty but for the LCD refresh timer, it has work on each cascade of level 0.
+    The refresh callback only marks the refresh, the display task draws.
+*/
+void VTimerTask(void)
+{
+    Burn(SIM_VTIMER_TIME);
+    
+    if((s32)(GetTimerCounter() - nextRefresh) >= 0)
+    {
+        nextRefresh += SIM_LCD_REFRESH_PERIOD;
+        isRefreshPending = TRUE;
+    }
+}
+
+u32 GetVTimerTicksToNextEvent(void)
+{
+    u32 now = GetTimerCounter();
+    u32 ticks = WHEEL_LEVEL0_SIZE - (now & (WHEEL_LEVEL0_SIZE - 1));
+    
+    if((s32)(nextRefresh - now) <= 0)
+    {
+        return 0;
+    }
+    if(nextRefresh - now < ticks)
+    {
+        ticks = nextRefresh - now;
+    }
+    
+    return ticks;
+}
+
+/*
+    Tasks of main()
+*/
+static void ProcessImageTask(void)
+{
+    Burn(SIM_IO_SCAN_TIME);
+}
+
+// MBPollPort(): one port event per run, a checked frame is executed in the next pass
+static void SimPollPort(tSimPort *pPort)
+{
+    tSimPortEvent event = pPort->queuedEvent;
+    
+    pPort->takenPosts = pPort->passPosts;
+    pPort->pollRuns++;
+    pPort->queuedEvent = eSimNoEvent;
+    
+    switch(event)
+    {
+    case eSimFrameReceived:
+        Burn(SIM_FRAME_CHECK_TIME);
+        pPort->queuedEvent = eSimExecute;
+        SimPostEvent(pPort);
+        break;
+    case eSimExecute:
+        Burn(SIM_EXECUTE_TIME);
+        pPort->isResponseReady = TRUE;
+        break;
+    default:
+        break;
+    }
+}
+
+// MBPortTransmit(): the master sends its next request after the response
+static void SimTransmitPort(tSimPort *pPort)
+{
+    unsigned long long responseCycles;
+    
+    if(pPort->isResponseReady == FALSE)
+    {
+        return;
+    }
+    
+    responseCycles = SimCycles - pPort->frameCycles;
+    if(responseCycles > pPort->maxResponseCycles)
+    {
+        pPort->maxResponseCycles = responseCycles;
+    }
+    pPort->totalResponseCycles += responseCycles;
+    pPort->responses++;
+    pPort->isResponseReady = FALSE;
+    
+    Burn(SIM_TRANSMIT_TIME);
+    pPort->next = SimCycles + RandomCycles(pPort->period);
+}
+
+static void MBPollSlave(void)
+{
+    SimPollPort(&SimPorts[0]);
+}
+
+static void MB_slave_transmit(void)
+{
+    SimTransmitPort(&SimPorts[0]);
+}
+
+static void RS232PollSlave(void)
+{
+    SimPollPort(&SimPorts[1]);
+}
+
+static void RS232_slave_transmit(void)
+{
+    SimTransmitPort(&SimPorts[1]);
+}
+
+// The refresh formats the page, each run draws one part of the frame
+static void ControllerDisplayDataTask(void)
+{
+    Burn(SIM_DISPLAY_TIME);
+    
+    if(isRefreshPending == TRUE)
+    {
+        isRefreshPending = FALSE;
+        Burn(SIM_DISPLAY_FORMAT_TIME);
+        lcdPart = 0;
+    }
+    
+    if(lcdPart < SIM_LCD_PARTS)
+    {
+        Burn(SIM_LCD_PART_TIME);
+        lcdPart++;
+    }
+}
+
+// After a pass: posts made before the pass which its poll task did not take are lost
+static void CheckPortEvents(void)
+{
+    tSimPort *pPort;
+    int i;
+    
+    for(i = 0; i < SIM_PORTS_NUMBER; i++)
+    {
+        pPort = &SimPorts[i];
+    
+        if(pPort->takenPosts != pPort->passPosts)
+        {
+            pPort->lostEvents++;
+            pPort->takenPosts = pPort->passPosts;
+        }
+    
+        pPort->passPosts = pPort->posts;
+        if(pPort->passPosts != pPort->takenPosts)
+        {
+            pPort->pendingPasses++;
+        }
+    }
+}
+
+int main(void)
+{
+    const tSchedulerStatistics *pStatistics;
+    const tTask *pTask;
+    tSimPort *pPort;
+    double maxLatency;
+    int errors = 0;
+    int i;
+    
+    for(i = 0; i < SIM_PORTS_NUMBER; i++)
+    {
+        SimPorts[i].next = RandomCycles(SimPorts[i].period);
+    }
+    
+    InitScheduler();
+    RegisterTask("VTimers", VTimerTask, TASK_EVERY_PASS, NO_EVENTS, TASK_PRIORITY_HIGH);
+    RegisterTask("I/O scan", ProcessImageTask, TASK_EVERY_PASS, NO_EVENTS, TASK_PRIORITY_HIGH);
+    RegisterTask("MB poll", MBPollSlave, TASK_NO_PERIOD, EVENT_MASK(EVENT_MODBUS), TASK_PRIORITY_HIGH);
+    RegisterTask("MB transmit", MB_slave_transmit, TASK_NO_PERIOD, EVENT_MASK(EVENT_MODBUS), TASK_PRIORITY_HIGH);
+    RegisterTask("RS232 poll", RS232PollSlave, TASK_NO_PERIOD, EVENT_MASK(EVENT_RS232), TASK_PRIORITY_NORMAL);
+    RegisterTask("RS232 transmit", RS232_slave_transmit, TASK_NO_PERIOD, EVENT_MASK(EVENT_RS232), TASK_PRIORITY_NORMAL);
+    RegisterTask("Display", ControllerDisplayDataTask, SIM_DISPLAY_PERIOD, NO_EVENTS, TASK_PRIORITY_LOW);
+    
+    while(GetTimerCounter() < SIM_TIME_MS)
+    {
+        RunScheduler();
+        CheckPortEvents();
+    }
+    
+    printf("%u ms of the main loop at %d MHz\n\n", SIM_TIME_MS, SIM_HCLK_MHZ);
+    printf("%-16s %8s %10s %10s %8s %12s\n", "task", "runs", "mean us", "max us", "missed", "max late ms");
+    for(i = 0; i < GetTasksNumber(); i++)
+    {
+        pTask = GetTaskStatistics(i);
+        printf("%-16s %8lu %10.1f %10.1f %8lu %12lu\n", pTask->name, pTask->runs,
+               pTask->runs ? (double)pTask->totalCycles / pTask->runs / SIM_HCLK_MHZ : 0.0,
+               (double)pTask->maxCycles / SIM_HCLK_MHZ, pTask->missedDeadlines, (unsigned long)pTask->maxLateness);
+        if(pTask->runs == 0 || pTask->missedDeadlines != 0)
+        {
+            errors++;
+        }
+    }
+    
+    pStatistics = GetSchedulerStatistics();
+    maxLatency = (double)pStatistics->maxLatency / SIM_HCLK_MHZ;
+    printf("\npasses %lu, sleeps %lu, events %lu\n", pStatistics->passes, pStatistics->sleeps, pStatistics->events);
+    printf("event latency: mean %.1f us, max %.1f us, budget %d us\n", pStatistics->events ? (double)pStatistics->totalLatency / pStatistics->events / SIM_HCLK_MHZ : 0.0,
+           maxLatency, SIM_LATENCY_BUDGET_US);
+    printf("idle %u permille\n\n", GetIdlePermille());
+    if(maxLatency > SIM_LATENCY_BUDGET_US)
+    {
+        errors++;
+    }
+    
+    // every pass with a pending port event must run the poll task of the port
+    printf("%-8s %8s %10s %14s %10s %8s %14s %14s\n", "port", "frames", "responses", "pending passes", "polls", "lost",
+           "mean resp us", "max resp us");
+    for(i = 0; i < SIM_PORTS_NUMBER; i++)
+    {
+        pPort = &SimPorts[i];
+        printf("%-8s %8lu %10lu %14lu %10lu %8lu %14.1f %14.1f\n", pPort->name, pPort->frames, pPort->responses,
+               pPort->pendingPasses, pPort->pollRuns, pPort->lostEvents,
+               pPort->responses ? (double)pPort->totalResponseCycles / pPort->responses / SIM_HCLK_MHZ : 0.0,
+               (double)pPort->maxResponseCycles / SIM_HCLK_MHZ);
+        if(pPort->lostEvents != 0 || pPort->responses == 0 || pPort->frames - pPort->responses > 1)
+        {
+            errors++;
+        }
+    }
+    
+    return errors ? 1 : 0;
+}
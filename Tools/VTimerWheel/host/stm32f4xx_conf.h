@@ -0,0 +1,27 @@
+/*
+    Host replacement of the peripheral library configuration - only TIM2 counter used by VTimers.
+    The test moves the counter, TIM_Cmd() does nothing.
+*/
+#ifndef __HOST_STM32F4XX_CONF_H
+#define __HOST_STM32F4XX_CONF_H
+
+#include <stdint.h>
+
+typedef uint32_t u32;
+typedef int32_t s32;
+
+typedef struct
+{
+    volatile uint32_t CNT;
+}TIM_TypeDef;
+
+typedef enum {DISABLE = 0, ENABLE = !DISABLE} FunctionalState;
+
+extern TIM_TypeDef HostTIM2;
+#define TIM2                            (&HostTIM2)
+
+#define assert_param(expr)              ((void)0)
+
+static inline void TIM_Cmd(TIM_TypeDef *TIMx, FunctionalState NewState) { (void)TIMx; (void)NewState; }
+
+#endif
@@ -0,0 +1,263 @@
+/*
+    Host test of the callback timers. VTimers/VTimer.c is linked with a pool of TEST_TIMERS timers and TIM2
+    counter is moved by the test, it starts just below the 32-bit wrap. All timers are armed at random -
+    one-shot and periodic, on each of the 3 wheel levels and beyond the wheel range - and while the clock runs
+    they are cancelled, restarted and re-armed from their own callbacks. A model of every timer checks that
+    each callback comes exactly on its tick, that no active timer is overdue and that
+    GetVTimerTicksToNextEvent() never sleeps past an expiry.
+
+    Build and run from the repository root:
+    gcc -std=gnu99 -O2 -Wall -DMAX_CALLBACK_TIMER_COUNT=4096 -I Tools/VTimerWheel/host -I VTimers -I Definitions -I MyTimers -o vtimertest Tools/VTimerWheel/vtimerWheelTest.c VTimers/VTimer.c
+    ./vtimertest
+
+    Exit code is 1 if any timer expired on a wrong tick or not at all.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "stm32f4xx_conf.h"
+#include "definitions.h"
+#include "VTimer.h"
+
+#define TEST_TIMERS                             MAX_CALLBACK_TIMER_COUNT
+#define TEST_START_COUNTER                      0xFFF00000UL    // counter wraps after 1 048 576 ticks
+#define TEST_TICKS                              4000000UL       // almost 4 wheel ranges
+#define TEST_MAX_CATCH_UP                       50              // ticks of one VTimerTask() when the loop is late
+#define TEST_CHECK_PERIOD                       997             // ticks between the checks of all timers
+
+// Model of one timer
+typedef struct testTimerStructure{
+    tVTimer *pTimer;
+    u32 expected;                       // counter of the next expiry
+    u32 period;
+    BOOL isActive;
+    unsigned long fires;
+}tTestTimer;
+
+TIM_TypeDef HostTIM2;
+
+static tTestTimer TestTimers[TEST_TIMERS];
+static u32 processedCounter;            // counter of the last VTimerTask()
+static u32 lastFired;                   // counter of the last callback, callbacks must come in order
+static unsigned long errors;
+static unsigned long callbacks;
+
+void InitTIM2(void)
+{
+    HostTIM2.CNT = TEST_START_COUNTER;
+}
+
+// Ticks of the first expiry: a quarter on each wheel level and a quarter beyond the wheel range
+static u32 RandomTicks(void)
+{
+    switch(rand() % 4)
+    {
+    case 0:
+        return 1 + rand() % (WHEEL_LEVEL0_SIZE - 1);
+    case 1:
+        return WHEEL_LEVEL0_SIZE + rand() % (WHEEL_LEVEL0_SIZE * (WHEEL_LEVEL1_SIZE - 1));
+    case 2:
+        return WHEEL_LEVEL0_SIZE * WHEEL_LEVEL1_SIZE + rand() % (WHEEL_RANGE - WHEEL_LEVEL0_SIZE * WHEEL_LEVEL1_SIZE);
+    default:
+        return WHEEL_RANGE + rand() % (2 * WHEEL_RANGE);
+    }
+}
+
+// Period of a timer, 0 for one-shot half of the time
+static u32 RandomPeriod(void)
+{
+    if(rand() % 2)
+    {
+        return 0;
+    }
+    return (rand() % 2) ? 1 + rand() % 1000 : RandomTicks();
+}
+
+static void StartTestTimer(tTestTimer *pTest)
+{
+    u32 ticks = RandomTicks();
+    
+    pTest->period = RandomPeriod();
+    pTest->expected = HostTIM2.CNT + ticks;
+    pTest->isActive = TRUE;
+    StartVTimer(pTest->pTimer, ticks, pTest->period);
+}
+
+static void StopTestTimer(tTestTimer *pTest)
+{
+    StopVTimer(pTest->pTimer);
+    pTest->isActive = FALSE;
+}
+
+static void TestCallback(void *pContext)
+{
+    tTestTimer *pTest = (tTestTimer *)pContext;
+    
+    callbacks++;
+    
+    // the ticks of one VTimerTask() are processed in order, each callback on its own tick
+    if(pTest->isActive == FALSE || (s32)(pTest->expected - processedCounter) <= 0 ||
+       (s32)(pTest->expected - HostTIM2.CNT) > 0 || (s32)(pTest->expected - lastFired) < 0)
+    {
+        if(errors < 10)
+        {
+            printf("timer %d: callback at %lu, expected %lu (active %d)\n", (int)(pTest - TestTimers), (unsigned long)(HostTIM2.CNT - TEST_START_COUNTER),
+                   (unsigned long)(pTest->expected - TEST_START_COUNTER), pTest->isActive);
+        }
+        errors++;
+    }
+    lastFired = pTest->expected;
+    pTest->fires++;
+    
+    if(pTest->period != 0)
+    {
+        pTest->expected += pTest->period;
+    }
+    else
+    {
+        pTest->isActive = FALSE;
+    }
+    
+    // callbacks may stop or start timers, their own included
+    switch(rand() % 8)
+    {
+    case 0:
+        StopTestTimer(pTest);
+        break;
+    case 1:
+        StartTestTimer(pTest);
+        break;
+    case 2:
+        StopTestTimer(&TestTimers[rand() % TEST_TIMERS]);
+        break;
+    }
+}
+
+// All active timers are in the future and the main loop wakes up before the first of them
+static void CheckTimers(void)
+{
+    u32 nearest = 0xFFFFFFFFUL;
+    u32 ticks;
+    int i;
+    
+    for(i = 0; i < TEST_TIMERS; i++)
+    {
+        if(IsVTimerActive(TestTimers[i].pTimer) != TestTimers[i].isActive)
+        {
+            printf("timer %d: active %d, expected %d\n", i, IsVTimerActive(TestTimers[i].pTimer), TestTimers[i].isActive);
+            errors++;
+        }
+        if(TestTimers[i].isActive == FALSE)
+        {
+            continue;
+        }
+    
+        ticks = TestTimers[i].expected - HostTIM2.CNT;
+        if((s32)ticks <= 0)
+        {
+            printf("timer %d: overdue by %ld ticks\n", i, -(long)(s32)ticks);
+            errors++;
+        }
+        else if(ticks < nearest)
+        {
+            nearest = ticks;
+        }
+    }
+    
+    if(GetVTimerTicksToNextEvent() > nearest)
+    {
+        printf("sleep of %lu ticks misses the expiry in %lu ticks\n", (unsigned long)GetVTimerTicksToNextEvent(), (unsigned long)nearest);
+        errors++;
+    }
+}
+
+static double NowNs(void)
+{
+    struct timespec now;
+    
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    
+    return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+int main(void)
+{
+    unsigned long elapsedTicks = 0, fires = 0, once = 0;
+    double start, elapsed;
+    int i;
+    
+    InitVTimers();
+    processedCounter = HostTIM2.CNT;
+    lastFired = HostTIM2.CNT;
+    
+    for(i = 0; i < TEST_TIMERS; i++)
+    {
+        TestTimers[i].pTimer = CreateVTimer(TestCallback, &TestTimers[i]);
+        if(TestTimers[i].pTimer == 0)
+        {
+            printf("pool is empty after %d timers\n", i);
+            return 1;
+        }
+    }
+    if(CreateVTimer(TestCallback, 0) != 0)
+    {
+        printf("pool gives more than %d timers\n", TEST_TIMERS);
+        errors++;
+    }
+    
+    start = NowNs();
+    for(i = 0; i < TEST_TIMERS; i++)
+    {
+        StartTestTimer(&TestTimers[i]);
+    }
+    elapsed = NowNs() - start;
+    printf("%d timers started: %.1f ns per start\n", TEST_TIMERS, elapsed / TEST_TIMERS);
+    
+    start = NowNs();
+    while(elapsedTicks < TEST_TICKS)
+    {
+        // the main loop is late now and then, VTimerTask() catches up with all ticks
+        u32 step = (rand() % 10 == 0) ? 1 + rand() % TEST_MAX_CATCH_UP : 1;
+    
+        HostTIM2.CNT += step;
+        VTimerTask();
+        processedCounter = HostTIM2.CNT;
+        elapsedTicks += step;
+    
+        // the rest of the application cancels and restarts timers
+        switch(rand() % 4)
+        {
+        case 0:
+            StopTestTimer(&TestTimers[rand() % TEST_TIMERS]);
+            break;
+        case 1:
+            StartTestTimer(&TestTimers[rand() % TEST_TIMERS]);
+            break;
+        }
+    
+        if(elapsedTicks % TEST_CHECK_PERIOD < step)
+        {
+            CheckTimers();
+        }
+    }
+    elapsed = NowNs() - start;
+    CheckTimers();
+    
+    for(i = 0; i < TEST_TIMERS; i++)
+    {
+        fires += TestTimers[i].fires;
+        once += (TestTimers[i].fires != 0) ? 1 : 0;
+        DeleteVTimer(TestTimers[i].pTimer);
+    }
+    if(CreateVTimer(TestCallback, 0) == 0)
+    {
+        printf("deleted timers are not back in the pool\n");
+        errors++;
+    }
+    
+    printf("%lu ticks from counter 0x%08lX: %.1f ns per tick, %lu callbacks (%lu checked), %lu timers fired\n", elapsedTicks,
+           (unsigned long)TEST_START_COUNTER, elapsed / elapsedTicks, fires, callbacks, once);
+    printf("errors: %lu\n", errors);
+    
+    return errors ? 1 : 0;
+}
@@ -173,6 +173,26 @@ unsigned char recieveMyUSART(int usartID)
     return -1;
 }
 
+/* Take the received byte of the USART, if there is one
+  int usartID - USART_2, USART_3
+  unsigned char *pByte - the byte, all values 0x00 - 0xFF are data
+  returns FALSE when no byte was received - RXNE is checked, not the value
+*/
+BOOL recieveByteMyUSART(int usartID, unsigned char *pByte)
+{
+    assert_param(IS_USART_ID_VALID(usartID));
+    
+    USART_TypeDef* USARTx = (usartID == USART_3) ? USART3 : USART2;
+    
+    if(USART_GetFlagStatus(USARTx, USART_FLAG_RXNE) != SET)
+    {
+        return FALSE;
+    }
+    
+    *pByte = (unsigned char)USART_ReceiveData(USARTx);
+    return TRUE;
+}
+
 
 //char *data - pointer to data which will be send
 //unsigned char count - number of sending data bytes
@@ -1,6 +1,8 @@
 #ifndef __USART_H
 #define __USART_H
 
+#include "definitions.h"
+
 
 #define USART_BAUD_RATE_2400            2400
 #define USART_BAUD_RATE_9600            9600
@@ -15,6 +17,7 @@
 void InitUSART2(int modBusUnitType);
 void InitUSART3(void);
 unsigned char recieveMyUSART(int usartID);
+BOOL recieveByteMyUSART(int usartID, unsigned char *pByte);
 unsigned char sendMyUSART(char *data, unsigned char count, int usartID, int timerType, int miliseconds);
 void USART2_IRQHandler(void);
 void USART3_IRQHandler(void);
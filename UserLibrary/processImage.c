@@ -0,0 +1,213 @@
+#include "stm32f4xx.h"
+#include "definitions.h"
+#include "initPeripheral.h"
+#include "pinMap.h"
+#include "scheduler.h"
+#include "processImage.h"
+
+static tIOPortGroup InputGroups[IO_PORTS_NUMBER];
+static int InputGroupsNumber;
+static tIOPortGroup OutputGroups[IO_PORTS_NUMBER];
+static int OutputGroupsNumber;
+
+// Inputs latched at the start of the scan cycle
+static volatile uint16_t InputImage;
+// Outputs written by SetOutputImage() and not flushed yet
+static volatile uint16_t OutputImage;
+static volatile uint16_t OutputPendingMask;
+
+/* Add logical I/O to the group of its port
+  tIOPortGroup *pGroups - InputGroups or OutputGroups
+  int *pGroupsNumber - groups already used
+  int pinID - INPUT_x or OUTPUT_x
+  int bitIndex - bit of pinID in the 16-bit masks
+*/
+static void AddToPortGroup(tIOPortGroup *pGroups, int *pGroupsNumber, int pinID, int bitIndex)
+{
+    tIOPortGroup *pGroup;
+    int i;
+    
+    for(i = 0; i < *pGroupsNumber; i++)
+    {
+        if(pGroups[i].port == PinMap[pinID].port)
+        {
+            break;
+        }
+    }
+    
+    if(i == *pGroupsNumber)
+    {
+        pGroups[i].port = PinMap[pinID].port;
+        pGroups[i].pins = 0;
+        pGroups[i].count = 0;
+        (*pGroupsNumber)++;
+    }
+    
+    pGroup = &pGroups[i];
+    pGroup->pins |= PinMap[pinID].pin;
+    pGroup->bitIndex[pGroup->count] = bitIndex;
+    pGroup->pinMask[pGroup->count] = PinMap[pinID].pin;
+    pGroup->count++;
+}
+
+/* 
+    Configure all digital inputs and outputs and group their pins by port, 
+    so the whole image costs one register access per port
+*/
+void InitProcessImage(void)
+{
+    int i;
+    
+    InputGroupsNumber = 0;
+    OutputGroupsNumber = 0;
+    
+    for(i = 0; i < DIGITAL_IO_NUMBER; i++)
+    {
+        InitInput(INPUT_1 + i);
+        AddToPortGroup(InputGroups, &InputGroupsNumber, INPUT_1 + i, i);
+        
+        InitOutput(OUTPUT_1 + i);
+        AddToPortGroup(OutputGroups, &OutputGroupsNumber, OUTPUT_1 + i, i);
+    }
+    
+    InputImage = ReadAllInputs();
+    OutputImage = ReadAllOutputs();
+    OutputPendingMask = 0;
+}
+
+// Logical mask of the port register value
+static uint16_t PortToMask(const tIOPortGroup *pGroup, uint32_t portValue)
+{
+    uint16_t mask = 0;
+    int i;
+    
+    for(i = 0; i < pGroup->count; i++)
+    {
+        if(portValue & pGroup->pinMask[i])
+        {
+            mask |= (uint16_t)1 << pGroup->bitIndex[i];
+        }
+    }
+    
+    return mask;
+}
+
+// INPUT_1 ... INPUT_16 as bits 0 - 15, one IDR read per port
+uint16_t ReadAllInputs(void)
+{
+    uint16_t inputs = 0;
+    int i;
+    
+    for(i = 0; i < InputGroupsNumber; i++)
+    {
+        inputs |= PortToMask(&InputGroups[i], InputGroups[i].port->IDR);
+    }
+    
+    return inputs;
+}
+
+// Levels written to OUTPUT_1 ... OUTPUT_16 as bits 0 - 15, one ODR read per port
+uint16_t ReadAllOutputs(void)
+{
+    uint16_t outputs = 0;
+    int i;
+    
+    for(i = 0; i < OutputGroupsNumber; i++)
+    {
+        outputs |= PortToMask(&OutputGroups[i], OutputGroups[i].port->ODR);
+    }
+    
+    return outputs;
+}
+
+/* Drive the outputs selected by mask, one BSRR write per port
+  uint16_t mask - OUTPUT_BIT() of the outputs to change
+  uint16_t value - new levels, only bits of mask are used
+*/
+void WriteOutputs(uint16_t mask, uint16_t value)
+{
+    const tIOPortGroup *pGroup;
+    uint32_t setPins, resetPins;
+    int i, j;
+    
+    for(i = 0; i < OutputGroupsNumber; i++)
+    {
+        pGroup = &OutputGroups[i];
+        setPins = 0;
+        resetPins = 0;
+        
+        for(j = 0; j < pGroup->count; j++)
+        {
+            if(mask & ((uint16_t)1 << pGroup->bitIndex[j]))
+            {
+                if(value & ((uint16_t)1 << pGroup->bitIndex[j]))
+                {
+                    setPins |= pGroup->pinMask[j];
+                }
+                else
+                {
+                    resetPins |= pGroup->pinMask[j];
+                }
+            }
+        }
+        
+        if((setPins | resetPins) != 0)
+        {
+            // BSRRL and BSRRH are written together - all pins of the port change at once
+            *(__IO uint32_t *)&pGroup->port->BSRRL = (resetPins << 16) | setPins;
+        }
+    }
+}
+
+/*
+    Scan cycle: flush the outputs staged since the last scan and latch the inputs.
+    Tasks of one scheduler pass see the same input image.
+*/
+void ProcessImageTask(void)
+{
+    uint16_t pendingMask, outputs;
+    u32 primask;
+    
+    // take the staged outputs at once, SetOutputImage() may be called from interrupts
+    primask = __get_PRIMASK();
+    __disable_irq();
+    pendingMask = OutputPendingMask;
+    outputs = OutputImage;
+    OutputPendingMask = 0;
+    __set_PRIMASK(primask);
+    
+    if(pendingMask != 0)
+    {
+        WriteOutputs(pendingMask, outputs);
+    }
+    
+    InputImage = ReadAllInputs();
+}
+
+// INPUT_1 ... INPUT_16 as latched by the last scan
+uint16_t GetInputImage(void)
+{
+    return InputImage;
+}
+
+// OUTPUT_1 ... OUTPUT_16 with the staged changes, they are on the pins after the next scan
+uint16_t GetOutputImage(void)
+{
+    return OutputImage;
+}
+
+/* Stage outputs for the next scan cycle, the scheduler runs it without sleeping first
+  uint16_t mask - OUTPUT_BIT() of the outputs to change
+  uint16_t value - new levels, only bits of mask are used
+*/
+void SetOutputImage(uint16_t mask, uint16_t value)
+{
+    u32 primask = __get_PRIMASK();
+    
+    __disable_irq();
+    OutputImage = (OutputImage & ~mask) | (value & mask);
+    OutputPendingMask |= mask;
+    __set_PRIMASK(primask);
+    
+    PostEvent(EVENT_OUTPUTS_STAGED);
+}
@@ -0,0 +1,39 @@
+#ifndef __PROCESSIMAGE_H
+#define __PROCESSIMAGE_H
+
+#include "definitions.h"
+
+#define DIGITAL_IO_NUMBER                       16                      // INPUT_1 ... INPUT_16, OUTPUT_1 ... OUTPUT_16
+#define IO_PORTS_NUMBER                         5                       // GPIOA ... GPIOE
+
+// Bit of the logical input/output in the 16-bit masks, bit 0 is INPUT_1/OUTPUT_1
+#define INPUT_BIT(INPUT_ID)                     ((uint16_t)1 << ((INPUT_ID) - INPUT_1))
+#define OUTPUT_BIT(OUTPUT_ID)                   ((uint16_t)1 << ((OUTPUT_ID) - OUTPUT_1))
+#define ALL_IO_BITS                             0xFFFF
+
+/*
+    Pins of one GPIO port which belong to the digital inputs or outputs.
+    pinMask[i] is the GPIO_Pin_x of the logical bit bitIndex[i].
+*/
+typedef struct ioPortGroup{
+    GPIO_TypeDef *port;
+    uint16_t pins;                      // all pins of the group, for one IDR/ODR/BSRR access
+    unsigned char count;
+    unsigned char bitIndex[DIGITAL_IO_NUMBER];
+    uint16_t pinMask[DIGITAL_IO_NUMBER];
+}tIOPortGroup;
+
+void InitProcessImage(void);
+
+// direct access, one register access per port
+uint16_t ReadAllInputs(void);
+uint16_t ReadAllOutputs(void);
+void WriteOutputs(uint16_t mask, uint16_t value);
+
+// process image of a scan cycle
+void ProcessImageTask(void);
+uint16_t GetInputImage(void);
+uint16_t GetOutputImage(void);
+void SetOutputImage(uint16_t mask, uint16_t value);
+
+#endif
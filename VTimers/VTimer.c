@@ -10,23 +10,32 @@
 #include "VTimer.h"
 
 volatile u32 arrVTimers[MAX_TIMER_COUNT];
-u16 vtimersRestartCount;
-extern volatile u32 timerCounter;
+volatile unsigned char arrVTimersArmed[MAX_TIMER_COUNT];   // a timer not armed is elapsed; bytes, so ISRs and main loop never share a read-modify-write
+
+// Callback timers' pool and wheel
+static tVTimer TimersPool[MAX_CALLBACK_TIMER_COUNT];
+static tVTimerList WheelLevel0[WHEEL_LEVEL0_SIZE];
+static tVTimerList WheelLevel1[WHEEL_LEVEL1_SIZE];
+static tVTimerList WheelLevel2[WHEEL_LEVEL2_SIZE];
+static u32 wheelTime;                   // last processed wheel tick
+static u32 wheelLastCounter;            // timer counter at the last VTimerTask()
+
+static void InitTimerWheel(void);
+static void AdvanceTimerWheel(void);
 
 
 void InitVTimers(void)
 {
     int i;
-   
-    ResetTimerCounter();
-    vtimersRestartCount = 0;
     
     for (i = 0; i < MAX_TIMER_COUNT; i++)
     {
         arrVTimers[i] = 0;
+        arrVTimersArmed[i] = FALSE;
     }
     
     InitTIM2();
+    InitTimerWheel();
     EnableVTimers();
 }
 
@@ -56,15 +65,17 @@ void SetVTimerValue(int timerID, u32 ticks)
     int index = ConvertTimerIDToVTimerIndex(timerID);
     
     arrVTimers[index] = mGetTimerCounter() + ticks;
+    arrVTimersArmed[index] = TRUE;
 }
 
 u32 GetVTimerValue(int timerID)
 {
     int index = ConvertTimerIDToVTimerIndex(timerID);
+    s32 remaining = (s32)(arrVTimers[index] - mGetTimerCounter());
     
-    if (mGetTimerCounter() < arrVTimers[index])
+    if (arrVTimersArmed[index] == TRUE && remaining > 0)
     {
-    	return arrVTimers[timerID] - mGetTimerCounter();
+    	return (u32)remaining;
     }
     else
     {
@@ -76,6 +87,7 @@ void ClearVTimer(int timerID)
 {
     int index = ConvertTimerIDToVTimerIndex(timerID);
     
+    arrVTimersArmed[index] = FALSE;
     arrVTimers[index] = 0;
 }
 
@@ -83,7 +95,8 @@ int IsVTimerElapsed(int timerID)
 {
     int index = ConvertTimerIDToVTimerIndex(timerID);
     
-    if(arrVTimers[index] <= mGetTimerCounter())
+    // counter wraps after 49.7 days, the signed difference is right for timeouts up to 24.8 days
+    if(arrVTimersArmed[index] == FALSE || (s32)(arrVTimers[index] - mGetTimerCounter()) <= 0)
     {
         return ELAPSED;
     }
@@ -93,42 +106,270 @@ int IsVTimerElapsed(int timerID)
     }
 }
 
-void VTimersReset(void)
+void VTimerTask(void)
+{
+    u32 counter;
+    
+    // catch up with all ticks since the last call, callbacks of each tick run in order
+    counter = mGetTimerCounter();
+    while (wheelLastCounter != counter)
+    {
+        wheelLastCounter++;
+        AdvanceTimerWheel();
+    }
+}
+
+u32 GetTimerCounter(void)
+{
+    return TIM2->CNT;
+}
+
+
+/*
+    Callback timers
+*/
+static void InitList(tVTimerList *pList)
+{
+    pList->pNext = pList;
+    pList->pPrev = pList;
+}
+
+static int IsListEmpty(tVTimerList *pList)
+{
+    return pList->pNext == pList;
+}
+
+static void AddToList(tVTimerList *pList, tVTimerList *pItem)
+{
+    pItem->pNext = pList;
+    pItem->pPrev = pList->pPrev;
+    pList->pPrev->pNext = pItem;
+    pList->pPrev = pItem;
+}
+
+static void RemoveFromList(tVTimerList *pItem)
+{
+    pItem->pPrev->pNext = pItem->pNext;
+    pItem->pNext->pPrev = pItem->pPrev;
+    pItem->pNext = pItem;
+    pItem->pPrev = pItem;
+}
+
+// Move all items of pSource to the empty pDestination
+static void MoveList(tVTimerList *pSource, tVTimerList *pDestination)
+{
+    if (IsListEmpty(pSource))
+    {
+        InitList(pDestination);
+        return;
+    }
+    
+    pDestination->pNext = pSource->pNext;
+    pDestination->pPrev = pSource->pPrev;
+    pDestination->pNext->pPrev = pDestination;
+    pDestination->pPrev->pNext = pDestination;
+    InitList(pSource);
+}
+
+static void InitTimerWheel(void)
+{
+    int i;
+    
+    for (i = 0; i < WHEEL_LEVEL0_SIZE; i++)
+    {
+        InitList(&WheelLevel0[i]);
+    }
+    for (i = 0; i < WHEEL_LEVEL1_SIZE; i++)
+    {
+        InitList(&WheelLevel1[i]);
+    }
+    for (i = 0; i < WHEEL_LEVEL2_SIZE; i++)
+    {
+        InitList(&WheelLevel2[i]);
+    }
+    
+    for (i = 0; i < MAX_CALLBACK_TIMER_COUNT; i++)
+    {
+        InitList(&TimersPool[i].link);
+        TimersPool[i].isActive = FALSE;
+        TimersPool[i].isAllocated = FALSE;
+    }
+    
+    wheelTime = 0;
+    wheelLastCounter = mGetTimerCounter();
+}
+
+// Put the timer in the slot of the lowest level which covers its expiry
+static void AddToWheel(tVTimer *pTimer)
+{
+    u32 delta = pTimer->expiry - wheelTime;
+    u32 expiry = pTimer->expiry;
+    
+    if (delta < WHEEL_LEVEL0_SIZE)
+    {
+        AddToList(&WheelLevel0[expiry & (WHEEL_LEVEL0_SIZE - 1)], &pTimer->link);
+    }
+    else if (delta < (1UL << (WHEEL_LEVEL0_BITS + WHEEL_LEVEL1_BITS)))
+    {
+        AddToList(&WheelLevel1[(expiry >> WHEEL_LEVEL0_BITS) & (WHEEL_LEVEL1_SIZE - 1)], &pTimer->link);
+    }
+    else
+    {
+        if (delta >= WHEEL_RANGE)
+        {
+            // longer than the wheel, it is parked in the farthest slot and put back on each cascade
+            expiry = wheelTime + WHEEL_RANGE - 1;
+        }
+        AddToList(&WheelLevel2[(expiry >> (WHEEL_LEVEL0_BITS + WHEEL_LEVEL1_BITS)) & (WHEEL_LEVEL2_SIZE - 1)], &pTimer->link);
+    }
+}
+
+// Redistribute timers of an upper level slot to the lower levels
+static void CascadeTimers(tVTimerList *pSlot)
 {
-    u32 tick = mGetTimerCounter(),
-    newTick = ResetTimerCounter();
+    tVTimerList timers;
+    tVTimerList *pItem;
     
-    vtimersRestartCount++;
+    MoveList(pSlot, &timers);
     
-    for (int i = 0; i < MAX_TIMER_COUNT; i++)
+    while (!IsListEmpty(&timers))
     {
-        if (arrVTimers[i] > tick)
+        pItem = timers.pNext;
+        RemoveFromList(pItem);
+        AddToWheel((tVTimer *)pItem);
+    }
+}
+
+static void AdvanceTimerWheel(void)
+{
+    tVTimerList expired;
+    tVTimer *pTimer;
+    u32 index;
+    
+    wheelTime++;
+    
+    index = wheelTime & (WHEEL_LEVEL0_SIZE - 1);
+    if (index == 0)
+    {
+        index = (wheelTime >> WHEEL_LEVEL0_BITS) & (WHEEL_LEVEL1_SIZE - 1);
+        CascadeTimers(&WheelLevel1[index]);
+        if (index == 0)
+        {
+            index = (wheelTime >> (WHEEL_LEVEL0_BITS + WHEEL_LEVEL1_BITS)) & (WHEEL_LEVEL2_SIZE - 1);
+            CascadeTimers(&WheelLevel2[index]);
+        }
+        index = 0;
+    }
+    
+    // callbacks may start and stop any timer, also the expired ones
+    MoveList(&WheelLevel0[index], &expired);
+    
+    while (!IsListEmpty(&expired))
+    {
+        pTimer = (tVTimer *)expired.pNext;
+        RemoveFromList(&pTimer->link);
+        
+        if (pTimer->period != 0)
         {
-            arrVTimers[i] = newTick + (arrVTimers[i] - tick);
+            pTimer->expiry += pTimer->period;
+            AddToWheel(pTimer);
         }
-        else if (arrVTimers[i] != 0)
+        else
         {
-            arrVTimers[i] = 0;
+            pTimer->isActive = FALSE;
         }
+        
+        pTimer->callback(pTimer->pContext);
     }
 }
 
-void VTimerTask(void)
+//Take a timer from the pool, returns 0 if the pool is empty
+tVTimer *CreateVTimer(tVTimerCallback callback, void *pContext)
 {
-    if (mGetTimerCounter() > 0xffff0000)
+    int i;
+    
+    for (i = 0; i < MAX_CALLBACK_TIMER_COUNT; i++)
     {
-        VTimersReset();
+        if (TimersPool[i].isAllocated == FALSE)
+        {
+            TimersPool[i].isAllocated = TRUE;
+            TimersPool[i].isActive = FALSE;
+            TimersPool[i].callback = callback;
+            TimersPool[i].pContext = pContext;
+            TimersPool[i].period = 0;
+            InitList(&TimersPool[i].link);
+            
+            return &TimersPool[i];
+        }
     }
+    
+    return 0;
 }
 
-u32 ResetTimerCounter(void)
+void DeleteVTimer(tVTimer *pTimer)
 {
-    return timerCounter = 1;
+    StopVTimer(pTimer);
+    pTimer->isAllocated = FALSE;
 }
 
-u32 GetTimerCounter(void)
+//u32 ticks - time to the first expiry, ms
+//u32 period - time between next expiries, ms; 0 for one-shot timer
+void StartVTimer(tVTimer *pTimer, u32 ticks, u32 period)
 {
-    return timerCounter;
+    StopVTimer(pTimer);
+    
+    if (ticks == 0)
+    {
+        ticks = 1;
+    }
+    
+    // count from now, not from the last processed tick
+    pTimer->expiry = wheelTime + (mGetTimerCounter() - wheelLastCounter) + ticks;
+    pTimer->period = period;
+    pTimer->isActive = TRUE;
+    
+    AddToWheel(pTimer);
 }
 
+void StopVTimer(tVTimer *pTimer)
+{
+    if (pTimer->isActive == TRUE)
+    {
+        RemoveFromList(&pTimer->link);
+        pTimer->isActive = FALSE;
+    }
+}
+
+int IsVTimerActive(tVTimer *pTimer)
+{
+    return pTimer->isActive;
+}
 
+/*
+    Ticks from now to the next work of VTimerTask(): an expiry on the lowest level or the next cascade,
+    0 if VTimerTask() has work already. The main loop may sleep so long without missing a callback.
+*/
+u32 GetVTimerTicksToNextEvent(void)
+{
+    u32 lag = mGetTimerCounter() - wheelLastCounter;
+    u32 ticks;
+    u32 slot;
+    
+    for (ticks = 1; ticks <= WHEEL_LEVEL0_SIZE; ticks++)
+    {
+        slot = (wheelTime + ticks) & (WHEEL_LEVEL0_SIZE - 1);
+        
+        // level 0 wraps to slot 0 exactly on a cascade
+        if (slot == 0 || !IsListEmpty(&WheelLevel0[slot]))
+        {
+            break;
+        }
+    }
+    
+    if (ticks <= lag)
+    {
+        return 0;
+    }
+    
+    return ticks - lag;
+}
@@ -4,6 +4,40 @@
 #define mGetTimerCounter()		GetTimerCounter()
 #define MAX_TIMER_COUNT                 19
 
+// Callback timers
+#ifndef MAX_CALLBACK_TIMER_COUNT
+#define MAX_CALLBACK_TIMER_COUNT        32              // size of the static pool, the host test builds it larger
+#endif
+#define WHEEL_LEVEL0_BITS               8               // 256 slots of 1 tick
+#define WHEEL_LEVEL1_BITS               6               // 64 slots of 256 ticks
+#define WHEEL_LEVEL2_BITS               6               // 64 slots of 16 384 ticks, range is 1 048 576 ticks
+#define WHEEL_LEVEL0_SIZE               (1 << WHEEL_LEVEL0_BITS)
+#define WHEEL_LEVEL1_SIZE               (1 << WHEEL_LEVEL1_BITS)
+#define WHEEL_LEVEL2_SIZE               (1 << WHEEL_LEVEL2_BITS)
+#define WHEEL_RANGE                     (1UL << (WHEEL_LEVEL0_BITS + WHEEL_LEVEL1_BITS + WHEEL_LEVEL2_BITS))
+
+typedef void (*tVTimerCallback)(void *pContext);
+
+typedef struct vtimerListStructure{
+    struct vtimerListStructure *pNext;
+    struct vtimerListStructure *pPrev;
+}tVTimerList;
+
+/*
+    Callback timer. Timers are taken from a static pool and kept in a 3 level hierarchical
+    timer wheel, so start, stop and expiry are O(1) regardless of the number of timers.
+    Callbacks run from VTimerTask() in the main loop, never from an interrupt.
+*/
+typedef struct vtimerStructure{
+    tVTimerList link;                   // must be first, the wheel lists point to it
+    u32 expiry;                         // wheel tick of the expiry
+    u32 period;                         // ticks, 0 - one-shot timer
+    tVTimerCallback callback;
+    void *pContext;                     // passed to the callback
+    unsigned char isActive;
+    unsigned char isAllocated;
+}tVTimer;
+
 void InitVTimers(void);
 void EnableVTimers(void);
 void DisableVTimers(void);
@@ -12,10 +46,15 @@ void SetVTimerValue(int timerID, u32 ticks);
 u32 GetVTimerValue(int timerID);
 void ClearVTimer(int timerID);
 int IsVTimerElapsed(int timerID);
-void VTimersReset(void);
 void VTimerTask(void);
-u32 ResetTimerCounter(void);
 u32 GetTimerCounter(void);
 
+tVTimer *CreateVTimer(tVTimerCallback callback, void *pContext);
+void DeleteVTimer(tVTimer *pTimer);
+void StartVTimer(tVTimer *pTimer, u32 ticks, u32 period);
+void StopVTimer(tVTimer *pTimer);
+int IsVTimerActive(tVTimer *pTimer);
+u32 GetVTimerTicksToNextEvent(void);
+
 
 #endif
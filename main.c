@@ -3,8 +3,10 @@
 #include "system_stm32f4xx.h"
 #include "definitions.h"
 #include "rcc.h"
+#include "delay.h"
 #include "initPeripheral.h"
 #include "userLibrary.h"
+#include "processImage.h"
 #include "VTimer.h"
 #include "usart.h"
 #include "mytim.h"
@@ -13,19 +15,39 @@
 #include "rs232.h"
 #include "LCD.h"
 #include "tankController.h"
+#include "controllerDisplay.h"
+#include "controllerModBus.h"
+#include "scheduler.h"
+#include "debounce.h"
 
 
 int main()
 {
     InitRCC();
+    InitDelay();
     InitVTimers();
+    InitDebounce();
     InitControllerPeripheral();
+    InitProcessImage();
     SetInitialConditions();
     InitLCD();
+    InitControllerDisplay();
+    MBInitHardwareAndProtocol();
+    RS232InitHardwareAndProtocol();
+    InitControllerModBus();
+    
+    InitScheduler();
+    RegisterTask("VTimers", VTimerTask, TASK_EVERY_PASS, NO_EVENTS, TASK_PRIORITY_HIGH);
+    RegisterTask("I/O scan", ProcessImageTask, TASK_EVERY_PASS, NO_EVENTS, TASK_PRIORITY_HIGH);
+    RegisterTask("MB poll", MBPollSlave, TASK_NO_PERIOD, EVENT_MASK(EVENT_MODBUS), TASK_PRIORITY_HIGH);
+    RegisterTask("MB transmit", MB_slave_transmit, TASK_NO_PERIOD, EVENT_MASK(EVENT_MODBUS), TASK_PRIORITY_HIGH);
+    RegisterTask("RS232 poll", RS232PollSlave, TASK_NO_PERIOD, EVENT_MASK(EVENT_RS232), TASK_PRIORITY_NORMAL);
+    RegisterTask("RS232 transmit", RS232_slave_transmit, TASK_NO_PERIOD, EVENT_MASK(EVENT_RS232), TASK_PRIORITY_NORMAL);
+    RegisterTask("Display", ControllerDisplayDataTask, DISPLAY_TASK_PERIOD, NO_EVENTS, TASK_PRIORITY_LOW);
     
     while(1)
     {
-        ControllerDisplayDataTask();
+        RunScheduler();
     }
     
     return 0;